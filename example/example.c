@@ -171,12 +171,65 @@ int declarative_read()
     return 0;
 }
 
+int descriptor_read()
+{
+    static const cbor_field_t fields[] =
+    {
+        CBOR_FIELD(struct struct_type, uint_value, CBOR_FIELD_TYPE_UINT, "uint"),
+        CBOR_FIELD(struct struct_type, int_value, CBOR_FIELD_TYPE_INT, "int"),
+        CBOR_FIELD(struct struct_type, bool_value, CBOR_FIELD_TYPE_BOOLEAN, "bool"),
+        CBOR_FIELD(struct struct_type, buf, CBOR_FIELD_TYPE_BYTES, "buf"),
+        CBOR_FIELD(struct struct_type, double_value, CBOR_FIELD_TYPE_FLOAT, "double")
+    };
+    uint8_t buffer[4096];
+    struct struct_type src_struct;
+    struct struct_type dst_struct;
+    cbor_struct_t desc;
+    uint8_t *data = buffer;
+    cbor_token_t token;
+
+    /* descriptors are prepared once and shared by all encoded and decoded values */
+    if (cbor_init_struct(&desc, fields, sizeof(fields) / sizeof(fields[0]), CBOR_STRUCT_LAYOUT_MAP) == CBOR_FALSE)
+        return 1;
+
+    src_struct.uint_value = 10000;
+    src_struct.int_value = -23456;
+    src_struct.double_value = 1234.5678;
+    src_struct.bool_value = CBOR_TRUE;
+    memset(src_struct.buf, 0xFF, sizeof(src_struct.buf));
+
+    assert(cbor_encode_struct(&data, sizeof(buffer), &desc, &src_struct));
+
+    print_data(buffer, data - buffer);
+
+    memset(&dst_struct, 0, sizeof(dst_struct));
+
+    if (cbor_init_read(&token, buffer, data - buffer, CBOR_TRUE) == CBOR_FALSE)
+        return 1;
+
+    if (cbor_decode_struct(&token, &desc, &dst_struct) == CBOR_FALSE)
+    {
+        printf("ERROR: %s\n", token.error_message);
+        return 1;
+    }
+
+    assert(src_struct.uint_value == dst_struct.uint_value);
+    assert(src_struct.int_value == dst_struct.int_value);
+    assert(src_struct.double_value == dst_struct.double_value);
+    assert(src_struct.bool_value == dst_struct.bool_value);
+    assert(memcmp(src_struct.buf, dst_struct.buf, sizeof(dst_struct.buf)) == 0);
+
+    return 0;
+}
+
 int main(int argc, char **argv)
 {
     if (enumerated_read() != 0)
         return 1;
     if (declarative_read() != 0)
         return 1;
+    if (descriptor_read() != 0)
+        return 1;
 
     return 0;
 }
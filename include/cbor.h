@@ -23,6 +23,8 @@ THE SOFTWARE.
 #ifndef CBOR_H
 #define CBOR_H
 
+#include <stddef.h>
+
 #ifdef CBOR_USE_STANDARD_STDINT
 #include <stdint.h>
 #else
@@ -60,6 +62,33 @@ typedef unsigned int cbor_bool_t;
 #define CBOR_TRUE 1
 #define CBOR_FALSE 0
 
+/* returns zero at the end of input, failures don't end the input and the read may be retried */
+typedef size_t (*cbor_refill_t)(void *ctx, uint8_t *data, size_t size);
+#define CBOR_REFILL_AGAIN ((size_t)-1) /* no data available on a non-blocking input yet */
+#define CBOR_REFILL_ERROR ((size_t)-2)
+typedef cbor_bool_t (*cbor_write_element_t)(uint8_t **data, size_t size, size_t index, void *ctx);
+
+typedef struct
+{
+    const void *base;
+    size_t size;
+} cbor_iovec_t; /* same layout as struct iovec */
+
+typedef struct
+{
+    cbor_refill_t refill;            /* NULL for fragments */
+    void *ctx;
+    const cbor_iovec_t *iovecs;      /* fragments in memory, read in place */
+    size_t iovecs_count;
+    size_t iovec_index;              /* input following the current data */
+    size_t iovec_offset;
+    uint8_t *window;                 /* refilled data or data stitched across fragments */
+    size_t window_size;
+    cbor_base_uint_t left;           /* payload bytes of a streamed string */
+    size_t failure;                  /* CBOR_REFILL_AGAIN or CBOR_REFILL_ERROR returned by the last refill, zero otherwise */
+    cbor_bool_t eof;
+} cbor_source_t;
+
 typedef struct
 {
     cbor_token_type_t type;
@@ -67,11 +96,13 @@ typedef struct
     /* read options */
     const uint8_t *pos;
     const uint8_t *end;
+    const uint8_t *start; /* initial byte of the current item */
     cbor_bool_t next_on_read;
+    cbor_source_t *source;      /* refillable or fragmented input, NULL for data in memory */
     /* data values */
     cbor_base_uint_t int_value; /* used as a simple value or length of data */
     double float_value;         /* used with CBOR_TOKEN_TYPE_FLOAT type only */
-    const uint8_t *bytes_value; /* used with CBOR_TOKEN_TYPE_BYTES and CBOR_TOKEN_TYPE_STRING types */
+    const uint8_t *bytes_value; /* used with CBOR_TOKEN_TYPE_BYTES and CBOR_TOKEN_TYPE_STRING types, NULL if streamed */
 } cbor_token_data_t;
 
 #define CBOR_TOKEN_INFO_SIZE \
@@ -97,6 +128,285 @@ typedef struct
 #define CBOR_GET_BOOLEAN(token) (cbor_bool_t)(((cbor_token_data_t *)(token))->int_value)
 #define CBOR_GET_FLOAT(token) (double)(((cbor_token_data_t *)(token))->float_value)
 
+#ifndef CBOR_MAX_NESTING_DEPTH
+#define CBOR_MAX_NESTING_DEPTH 32 /* maximum depth of nested arrays and maps for cbor_parse */
+#endif
+
+/* callbacks for cbor_parse, NULL callbacks are skipped, return CBOR_FALSE to stop parsing */
+typedef struct
+{
+    cbor_bool_t (*on_uint)(void *ctx, cbor_base_uint_t value);
+    cbor_bool_t (*on_int)(void *ctx, cbor_base_int_t value); /* negative integers only */
+    cbor_bool_t (*on_float)(void *ctx, double value);
+    cbor_bool_t (*on_boolean)(void *ctx, cbor_bool_t value);
+    cbor_bool_t (*on_null)(void *ctx);
+    cbor_bool_t (*on_undefined)(void *ctx);
+    cbor_bool_t (*on_special)(void *ctx, uint8_t value);
+    cbor_bool_t (*on_string)(void *ctx, const char *str, size_t str_length);
+    cbor_bool_t (*on_bytes)(void *ctx, const uint8_t *bytes, size_t bytes_size);
+    cbor_bool_t (*on_array_start)(void *ctx, cbor_base_uint_t array_size);
+    cbor_bool_t (*on_array_end)(void *ctx);
+    cbor_bool_t (*on_map_start)(void *ctx, cbor_base_uint_t map_size);
+    cbor_bool_t (*on_map_end)(void *ctx);
+    cbor_bool_t (*on_tag)(void *ctx, cbor_base_uint_t tag);
+    void (*on_error)(void *ctx, const char *error_message);
+} cbor_callbacks_t;
+
+typedef enum
+{
+    CBOR_FIELD_TYPE_UINT,    /* unsigned integer of 1, 2, 4 or 8 bytes */
+    CBOR_FIELD_TYPE_INT,     /* signed integer of 1, 2, 4 or 8 bytes */
+    CBOR_FIELD_TYPE_FLOAT,   /* float or double */
+    CBOR_FIELD_TYPE_BOOLEAN, /* cbor_bool_t or another integer of 1, 2, 4 or 8 bytes */
+    CBOR_FIELD_TYPE_STRING,  /* null-terminated string buffer */
+    CBOR_FIELD_TYPE_BYTES    /* bytes buffer, the whole buffer is written */
+} cbor_field_type_t;
+
+typedef enum
+{
+    CBOR_STRUCT_LAYOUT_ARRAY, /* fields are array items in order of descriptors */
+    CBOR_STRUCT_LAYOUT_MAP    /* fields are map values with string keys */
+} cbor_struct_layout_t;
+
+typedef struct
+{
+    const char *key; /* used with CBOR_STRUCT_LAYOUT_MAP only */
+    cbor_field_type_t type;
+    size_t offset;
+    size_t size;
+} cbor_field_t;
+
+#define CBOR_FIELD(struct_type, field, field_type, key) \
+    { (key), (field_type), offsetof(struct_type, field), sizeof(((struct_type *)0)->field) }
+
+#define CBOR_STRUCT_MAX_FIELDS 255
+#define CBOR_STRUCT_DISPATCH_SIZE 256
+
+typedef struct
+{
+    const cbor_field_t *fields;
+    size_t fields_count;
+    cbor_struct_layout_t layout;
+    uint8_t dispatch[CBOR_STRUCT_DISPATCH_SIZE]; /* key hash to field index + 1, zero is empty */
+} cbor_struct_t;
+
+typedef struct
+{
+    const char *key; /* map key of the column */
+    cbor_field_type_t type;
+    size_t size;            /* size of a value, used with numeric and boolean columns only */
+    void *values;           /* values of rows, or rows + 1 uint32_t offsets into data for strings and bytes */
+    uint8_t *data;          /* contents of strings and bytes */
+    size_t data_capacity;
+    uint8_t *validity;      /* optional bitmap of present values, least significant bit first */
+} cbor_column_t;
+
+typedef enum
+{
+    CBOR_PREDICATE_EXISTS,       /* key is present */
+    CBOR_PREDICATE_INT_EQUAL,    /* integer value is equal to min_value */
+    CBOR_PREDICATE_INT_RANGE,    /* integer value is in range from min_value to max_value inclusive */
+    CBOR_PREDICATE_STRING_PREFIX /* string value starts with prefix */
+} cbor_predicate_type_t;
+
+typedef struct
+{
+    const char *key; /* key of the top-level map of a record */
+    cbor_predicate_type_t type;
+    cbor_base_int_t min_value;
+    cbor_base_int_t max_value;
+    const char *prefix;
+} cbor_predicate_t;
+
+#define CBOR_MAX_PREDICATES 32
+
+typedef struct
+{
+    size_t count; /* number of numeric values */
+    double sum;
+    double min;
+    double max;
+} cbor_stats_t;
+
+typedef struct
+{
+    uint8_t *header;
+    uint8_t *payload; /* filled by the caller before commit */
+    size_t max_size;
+    unsigned int type;
+} cbor_reservation_t;
+
+typedef enum
+{
+    CBOR_STRING_CHUNK, /* chunk points to a part of the payload in the input */
+    CBOR_STRING_MORE,  /* input is consumed, more data is needed */
+    CBOR_STRING_END,   /* string is complete, the rest of the input isn't consumed */
+    CBOR_STRING_ERROR
+} cbor_string_status_t;
+
+typedef enum
+{
+    CBOR_FRAME_MESSAGE, /* message points to a complete message in the input */
+    CBOR_FRAME_MORE,    /* the frame isn't complete, nothing is consumed */
+    CBOR_FRAME_ERROR    /* invalid prefix, too large message or checksum mismatch */
+} cbor_frame_status_t;
+
+#define CBOR_FRAME_VARINT 1 /* LEB128 length prefix instead of 4 bytes big-endian */
+#define CBOR_FRAME_CRC32C 2 /* big-endian CRC32C of the message follows it */
+
+typedef struct
+{
+    uint8_t *prefix;
+    uint8_t *message;           /* encoded by the caller up to end */
+    uint8_t *end;               /* room for the checksum is left after it */
+    unsigned int flags;
+} cbor_frame_t;
+
+typedef struct
+{
+    uint32_t crc;               /* of the current record */
+} cbor_checksum_t;
+
+typedef enum
+{
+    CBOR_IO_OK,
+    CBOR_IO_AGAIN, /* the descriptor would block, the call is repeated when it's writable */
+    CBOR_IO_ERROR
+} cbor_io_status_t;
+
+typedef struct
+{
+    unsigned int state;
+    unsigned int type;          /* major type: 2 for bytes, 3 for text */
+    cbor_bool_t indefinite;
+    cbor_base_uint_t left;      /* payload bytes left in the current chunk */
+    uint8_t header[9];          /* header split between inputs */
+    size_t header_size;
+    const char *error_message;
+} cbor_string_reader_t;
+
+/* index file: header, then blocks of big-endian min and max doubles per key followed by 64 bits offsets of records */
+
+#define CBOR_INDEX_HEADER_SIZE 24
+#define CBOR_INDEX_MAX_KEYS 16
+#define CBOR_INDEX_BLOCK_SIZE(keys_count, block_records) ((keys_count) * 16 + (block_records) * 8)
+
+typedef struct
+{
+    const char *const *keys; /* keys of top-level maps of records with zone maps */
+    size_t keys_count;
+    size_t block_records;
+    size_t records_count;
+    cbor_stats_t zones[CBOR_INDEX_MAX_KEYS]; /* of the current block */
+    uint8_t *block; /* CBOR_INDEX_BLOCK_SIZE bytes */
+} cbor_index_builder_t;
+
+typedef struct
+{
+    const uint8_t *data;
+    size_t keys_count;
+    size_t block_records;
+    size_t records_count;
+    size_t blocks_count;
+} cbor_index_t;
+
+typedef struct
+{
+    int fd;
+    uint8_t *buffer;         /* records are batched here */
+    size_t buffer_size;
+    size_t alignment;        /* writes start at multiples of alignment */
+    size_t group_records;    /* records per synchronized flush, zero to synchronize explicitly only */
+    size_t used;             /* bytes of buffer starting at offset */
+    size_t flushed;          /* bytes of buffer already written */
+    size_t records;          /* records committed since last synchronization */
+    uint8_t *reserved;       /* start of the record being written */
+    cbor_frame_t frame;      /* of the record being written */
+    cbor_base_uint_t offset; /* file offset of buffer */
+} cbor_log_t;
+
+typedef struct
+{
+    uint8_t *pos;            /* small items are written here with cbor_write_* */
+    uint8_t *end;
+    uint8_t *segment;        /* start of buffer data not referenced by iovecs yet */
+    cbor_iovec_t *iovecs;
+    size_t iovecs_capacity;
+    size_t iovecs_count;
+    size_t threshold;        /* payloads of this size and larger are referenced in place */
+} cbor_gather_writer_t;
+
+typedef struct
+{
+    int fd;
+    uint8_t *buffer;
+    uint8_t *pos;            /* items are written here with cbor_write_* */
+    uint8_t *end;
+    uint8_t *pending;        /* start of buffer data not written to the descriptor yet */
+} cbor_sink_t;
+
+#ifndef CBOR_CACHE_LINE_SIZE
+#define CBOR_CACHE_LINE_SIZE 64
+#endif
+
+#define CBOR_RING_HEADER_SIZE (3 * CBOR_CACHE_LINE_SIZE) /* lines of producers, consumer and settings */
+
+typedef struct
+{
+    uint8_t *memory;             /* header followed by data, may be shared by processes */
+    uint8_t *data;
+    size_t capacity;             /* of data, a power of two */
+    cbor_bool_t multi_producer;
+    size_t reserved;             /* position after the reservation of a single producer */
+    uint8_t *message;            /* record returned by peek */
+    size_t record_size;          /* of the record returned by peek, checked against the capacity */
+    size_t mapped_size;          /* of shared memory mapped by the library */
+} cbor_ring_t;
+
+#ifndef CBOR_BULK_MAX_BLOCKS
+#define CBOR_BULK_MAX_BLOCKS 16
+#endif
+
+typedef struct
+{
+    int fd;                  /* -1 if io_uring isn't used */
+    void *sq_ring;
+    void *cq_ring;           /* same as sq_ring if mapped once */
+    void *sqes;
+    size_t sq_ring_size;
+    size_t cq_ring_size;
+    size_t sqes_size;
+    unsigned int sq_head;    /* offsets of ring fields */
+    unsigned int sq_tail;
+    unsigned int sq_mask;
+    unsigned int sq_array;
+    unsigned int cq_head;
+    unsigned int cq_tail;
+    unsigned int cq_mask;
+    unsigned int cqes;
+} cbor_uring_t;
+
+typedef struct
+{
+    int fd;
+    uint8_t *buffer;                                /* blocks_count blocks of block_size bytes */
+    size_t block_size;
+    size_t blocks_count;
+    uint8_t *pos;                                   /* items are written here with cbor_write_* */
+    uint8_t *end;
+    size_t head;                                    /* block read or written next */
+    size_t in_flight;                               /* blocks in flight from head when reading, before head when writing */
+    size_t consumed;                                /* bytes of the head block returned by refill */
+    cbor_base_uint_t offset;                        /* file offset of the next block submitted */
+    cbor_base_uint_t offsets[CBOR_BULK_MAX_BLOCKS];
+    size_t sizes[CBOR_BULK_MAX_BLOCKS];
+    long results[CBOR_BULK_MAX_BLOCKS];             /* bytes transferred, negative on errors */
+    cbor_bool_t completed[CBOR_BULK_MAX_BLOCKS];
+    cbor_bool_t eof;
+    cbor_bool_t failed;
+    cbor_uring_t uring;
+} cbor_bulk_t;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -118,10 +428,36 @@ cbor_bool_t cbor_write_string_with_len(uint8_t **data, size_t size, const char *
 cbor_bool_t cbor_write_string(uint8_t **data, size_t size, const char *str);
 cbor_bool_t cbor_write_bytes(uint8_t **data, size_t size, const uint8_t *bytes, size_t bytes_size);
 
+/* headers only, the payload is written by the caller */
+
+cbor_bool_t cbor_write_string_header(uint8_t **data, size_t size, size_t str_length);
+cbor_bool_t cbor_write_bytes_header(uint8_t **data, size_t size, size_t bytes_size);
+
+/* payloads produced in place, data is changed on commit only, compact moves the payload after the shortest header */
+
+cbor_bool_t cbor_write_string_reserve(uint8_t **data, size_t size, size_t max_length, cbor_reservation_t *reservation);
+cbor_bool_t cbor_write_bytes_reserve(uint8_t **data, size_t size, size_t max_size, cbor_reservation_t *reservation);
+cbor_bool_t cbor_write_commit(uint8_t **data, const cbor_reservation_t *reservation, size_t payload_size, cbor_bool_t compact);
+
 cbor_bool_t cbor_write_array(uint8_t **data, size_t size, cbor_base_uint_t array_size);
 cbor_bool_t cbor_write_map(uint8_t **data, size_t size, cbor_base_uint_t map_size);
 cbor_bool_t cbor_write_tag(uint8_t **data, size_t size, cbor_base_uint_t tag);
 cbor_bool_t cbor_write_special(uint8_t **data, size_t size, uint8_t special);
+cbor_bool_t cbor_write_raw(uint8_t **data, size_t size, const uint8_t *raw, size_t raw_size); /* already encoded items */
+
+/* fixed width writes, width is a number of bytes after the initial byte: 1, 2, 4 or 8 */
+
+cbor_bool_t cbor_write_uint_fixed(uint8_t **data, size_t size, cbor_base_uint_t value, size_t width);
+cbor_bool_t cbor_write_int_fixed(uint8_t **data, size_t size, cbor_base_int_t value, size_t width);
+cbor_bool_t cbor_write_array_fixed(uint8_t **data, size_t size, cbor_base_uint_t array_size, size_t width);
+cbor_bool_t cbor_write_map_fixed(uint8_t **data, size_t size, cbor_base_uint_t map_size, size_t width);
+
+/* patch previously written data in place, slot points to the initial byte of the item */
+
+cbor_bool_t cbor_patch_uint(uint8_t *slot, cbor_base_uint_t value); /* keeps major type, also patches array and map sizes and tags, not negative integers or string lengths */
+cbor_bool_t cbor_patch_int(uint8_t *slot, cbor_base_int_t value); /* integers only */
+cbor_bool_t cbor_patch_float(uint8_t *slot, float value);
+cbor_bool_t cbor_patch_double(uint8_t *slot, double value);
 
 /* read data */
 
@@ -148,6 +484,181 @@ cbor_bool_t cbor_read_map(cbor_token_t *token, cbor_base_uint_t *map_size);
 cbor_bool_t cbor_read_tag(cbor_token_t *token, cbor_base_uint_t *tag);
 cbor_bool_t cbor_read_special(cbor_token_t *token, uint8_t *special);
 
+cbor_bool_t cbor_get_item_span(cbor_token_t *token, const uint8_t **item, size_t *item_size); /* including nested items */
+cbor_bool_t cbor_skip(cbor_token_t *token); /* skips the current item with nested items */
+cbor_bool_t cbor_is_truncated(const uint8_t *data, size_t size); /* data ends inside its first item, which isn't malformed so far */
+
+/* read data from a refillable source through a window, items are valid until the next read and spans aren't supported;
+   strings larger than the window are streamed: bytes_value is NULL and the payload is read in chunks */
+
+cbor_bool_t cbor_init_read_source(cbor_token_t *token, cbor_source_t *source, cbor_refill_t refill, void *ctx,
+                                  uint8_t *window, size_t window_size, cbor_bool_t next_on_read);
+cbor_bool_t cbor_read_source_chunk(cbor_token_t *token, const uint8_t **chunk, size_t *chunk_size); /* FALSE at the end of payload */
+
+/* read data from fragments in place, headers and strings crossing fragments are copied to the window;
+   strings crossing fragments and larger than the window are streamed, chunks point to fragments */
+
+cbor_bool_t cbor_init_read_iovecs(cbor_token_t *token, cbor_source_t *source, const cbor_iovec_t *iovecs, size_t iovecs_count,
+                                  uint8_t *window, size_t window_size, cbor_bool_t next_on_read);
+
+size_t cbor_refill_file(void *ctx, uint8_t *data, size_t size); /* ctx is FILE * */
+size_t cbor_refill_fd(void *ctx, uint8_t *data, size_t size);   /* ctx points to int file descriptor */
+
+/* parse data */
+
+cbor_bool_t cbor_parse(const uint8_t *data, size_t data_size, const cbor_callbacks_t *callbacks, void *ctx);
+
+/* projection: copies the requested keys of a map, nested keys are dot-separated: "user.name" */
+
+cbor_bool_t cbor_project(const uint8_t *data, size_t data_size, const char **paths, size_t paths_count, uint8_t **out, size_t out_size);
+
+/* scan: finds records of a sequence matching all predicates, *offsets_count is a capacity on input,
+   *pos is moved after the last scanned record so the scan can be continued */
+
+cbor_bool_t cbor_scan(const uint8_t *data, size_t data_size, size_t *pos, const cbor_predicate_t *predicates, size_t predicates_count,
+                      size_t *offsets, size_t *offsets_count);
+
+/* aggregation of a numeric field of top-level maps of a sequence, values of other types are ignored */
+
+cbor_bool_t cbor_aggregate_field(const uint8_t *data, size_t data_size, const char *key, cbor_stats_t *stats);
+cbor_bool_t cbor_aggregate_field_parallel(const uint8_t *data, size_t data_size, const char *key, cbor_stats_t *stats, unsigned int threads_count);
+
+/* array of count elements written by threads, so write_element must be safe to call from several threads:
+   the calling thread writes the first range of indexes in place, others write theirs into equal slices of scratch
+   which are copied after it; write_element is called once per element if every range fits into its slice,
+   the rest of an overflowed range is written by the calling thread; without scratch elements are written serially */
+
+cbor_bool_t cbor_write_array_parallel(uint8_t **data, size_t size, size_t count, cbor_write_element_t write_element, void *ctx,
+                                      uint8_t *scratch, size_t scratch_size, unsigned int threads_count);
+
+/* structures, descriptors with duplicated keys or sizes not supported by field types are rejected */
+
+cbor_bool_t cbor_init_struct(cbor_struct_t *desc, const cbor_field_t *fields, size_t fields_count, cbor_struct_layout_t layout);
+cbor_bool_t cbor_encode_struct(uint8_t **data, size_t size, const cbor_struct_t *desc, const void *value);
+cbor_bool_t cbor_decode_struct(cbor_token_t *token, const cbor_struct_t *desc, void *value);
+
+/* index of a sequence, completed blocks are written by the caller after the header */
+
+cbor_bool_t cbor_init_index_builder(cbor_index_builder_t *builder, const char *const *keys, size_t keys_count, size_t block_records, uint8_t *block);
+cbor_bool_t cbor_index_add_record(cbor_index_builder_t *builder, cbor_base_uint_t offset, const uint8_t *record, size_t record_size,
+                                  size_t *block_size);
+size_t cbor_index_finish(cbor_index_builder_t *builder); /* size of the last incomplete block */
+void cbor_index_write_header(const cbor_index_builder_t *builder, uint8_t *header);
+
+cbor_bool_t cbor_init_index(cbor_index_t *index, const uint8_t *data, size_t size);
+cbor_bool_t cbor_index_get_offset(const cbor_index_t *index, size_t record, cbor_base_uint_t *offset);
+cbor_bool_t cbor_index_get_zone(const cbor_index_t *index, size_t block, size_t key_index, double *min, double *max);
+size_t cbor_index_find_block(const cbor_index_t *index, size_t block, size_t key_index, double min, double max);
+
+/* streaming of a definite or indefinite length string from successive inputs, data and size are moved past consumed bytes */
+
+void cbor_init_string_reader(cbor_string_reader_t *reader);
+cbor_string_status_t cbor_read_string_chunk(cbor_string_reader_t *reader, const uint8_t **data, size_t *size,
+                                            const uint8_t **chunk, size_t *chunk_size);
+
+/* append-only log of a sequence on a file descriptor, size is the valid size of the file as returned by recovery;
+   every record is framed with a big-endian length and CRC32C, so torn and zero-filled tails are detected */
+
+#define CBOR_LOG_RECORD_OVERHEAD 8 /* bytes of buffer and file taken by framing of a record */
+
+cbor_bool_t cbor_init_log(cbor_log_t *log, int fd, uint8_t *buffer, size_t buffer_size, size_t alignment, size_t group_records,
+                          cbor_base_uint_t size);
+uint8_t *cbor_log_reserve(cbor_log_t *log, size_t size); /* NULL if size exceeds the buffer or on I/O error */
+cbor_bool_t cbor_log_commit(cbor_log_t *log, const uint8_t *end);
+cbor_bool_t cbor_log_append(cbor_log_t *log, const uint8_t *record, size_t record_size);
+cbor_bool_t cbor_log_flush(cbor_log_t *log);
+cbor_bool_t cbor_log_sync(cbor_log_t *log);
+
+size_t cbor_get_valid_size(const uint8_t *data, size_t size); /* of complete well-formed items at the start of data */
+cbor_bool_t cbor_log_recover(int fd, uint8_t *buffer, size_t buffer_size, cbor_base_uint_t *size); /* buffer is as large as the log one */
+
+/* scatter-gather output: headers are written to the buffer, large payloads are referenced and must outlive iovecs */
+
+cbor_bool_t cbor_init_gather_writer(cbor_gather_writer_t *writer, uint8_t *buffer, size_t buffer_size, cbor_iovec_t *iovecs, size_t iovecs_capacity,
+                                    size_t threshold);
+cbor_bool_t cbor_gather_write_string_with_len(cbor_gather_writer_t *writer, const char *str, size_t str_length);
+cbor_bool_t cbor_gather_write_string(cbor_gather_writer_t *writer, const char *str);
+cbor_bool_t cbor_gather_write_bytes(cbor_gather_writer_t *writer, const uint8_t *bytes, size_t bytes_size);
+size_t cbor_gather_finish(cbor_gather_writer_t *writer); /* number of iovecs */
+
+/* buffered output to a file descriptor: when cbor_write_* fails, the sink is flushed and the same item is written again;
+   payloads larger than the buffer are written after a header with cbor_sink_put or, for file data, cbor_sink_put_file;
+   done keeps progress between calls */
+
+void cbor_init_sink(cbor_sink_t *sink, int fd, uint8_t *buffer, size_t buffer_size);
+cbor_io_status_t cbor_sink_flush(cbor_sink_t *sink); /* AGAIN if data is left, space may be freed anyway */
+cbor_io_status_t cbor_sink_put(cbor_sink_t *sink, const void *data, size_t size, size_t *done);
+cbor_io_status_t cbor_sink_put_file(cbor_sink_t *sink, int file_fd, cbor_base_uint_t offset, size_t size, size_t *done); /* with sendfile on Linux */
+
+/* bulk file I/O with several blocks in flight, through io_uring if it's built with CBOR_IO_URING_SUPPORT and available,
+   otherwise blocks are read and written with pread and pwrite when submitted; reading expects a regular file */
+
+cbor_bool_t cbor_init_bulk_reader(cbor_bulk_t *bulk, int fd, cbor_base_uint_t offset, uint8_t *buffer, size_t block_size, size_t blocks_count);
+cbor_bool_t cbor_bulk_read(cbor_bulk_t *bulk, const uint8_t **block, size_t *block_size); /* block_size is zero at the end of file */
+void cbor_bulk_release(cbor_bulk_t *bulk);          /* the block returned by read is reused for the next read */
+size_t cbor_refill_bulk(void *ctx, uint8_t *data, size_t size); /* ctx is cbor_bulk_t * initialized for reading */
+
+cbor_bool_t cbor_init_bulk_writer(cbor_bulk_t *bulk, int fd, cbor_base_uint_t offset, uint8_t *buffer, size_t block_size, size_t blocks_count);
+cbor_bool_t cbor_bulk_submit(cbor_bulk_t *bulk);   /* writes the current block, pos and end are moved to the next one */
+cbor_bool_t cbor_bulk_finish(cbor_bulk_t *bulk);   /* submits the current block and waits for all writes */
+
+void cbor_close_bulk(cbor_bulk_t *bulk);            /* waits for blocks in flight */
+
+/* ring of messages in memory passed between threads: producers encode into a reservation and commit it,
+   the consumer reads messages in place; one producer unless multi_producer is set, memory is aligned to 8 bytes */
+
+cbor_bool_t cbor_init_ring(cbor_ring_t *ring, void *memory, size_t size, cbor_bool_t multi_producer);
+/* to memory initialized by another handle, settings are validated since the memory may be shared with other processes */
+cbor_bool_t cbor_attach_ring(cbor_ring_t *ring, void *memory, size_t size);
+uint8_t *cbor_ring_reserve(cbor_ring_t *ring, size_t size); /* NULL if the ring is full */
+void cbor_ring_commit(cbor_ring_t *ring, uint8_t *message, const uint8_t *end);
+/* FALSE if there's nothing to read or the record at the tail is corrupted */
+cbor_bool_t cbor_ring_peek(cbor_ring_t *ring, const uint8_t **message, size_t *message_size);
+void cbor_ring_release(cbor_ring_t *ring);
+
+/* blocking on an empty or full ring, timeout is in milliseconds or negative to wait forever;
+   producers wake the reader after commits and the consumer wakes writers after releases */
+
+cbor_bool_t cbor_ring_wait_message(cbor_ring_t *ring, long timeout); /* FALSE on timeout */
+void cbor_ring_wake_reader(cbor_ring_t *ring);
+cbor_bool_t cbor_ring_wait_space(cbor_ring_t *ring, size_t size, long timeout);
+void cbor_ring_wake_writers(cbor_ring_t *ring);
+
+/* ring in memory shared by processes, the descriptor is passed to another process which opens the ring */
+
+cbor_bool_t cbor_create_shared_ring(cbor_ring_t *ring, size_t size, cbor_bool_t multi_producer, int *fd);
+cbor_bool_t cbor_open_shared_ring(cbor_ring_t *ring, int fd);
+void cbor_close_shared_ring(cbor_ring_t *ring); /* the descriptor is closed by the caller */
+
+/* framing of messages on stream transports: length prefix and optional checksum; the prefix is written when
+   the message is encoded, data is changed on end only and compact moves the message after the shortest varint */
+
+cbor_bool_t cbor_frame_begin(uint8_t **data, size_t size, unsigned int flags, cbor_frame_t *frame);
+cbor_bool_t cbor_frame_end(uint8_t **data, const cbor_frame_t *frame, const uint8_t *message_end, cbor_bool_t compact);
+
+/* finds the next message without decoding it, data and size are moved past a complete frame;
+   on MORE message_size is the size of the whole frame if the prefix is complete, zero otherwise */
+cbor_frame_status_t cbor_split_frame(const uint8_t **data, size_t *size, unsigned int flags, size_t max_message_size,
+                                     const uint8_t **message, size_t *message_size);
+
+/* CRC32C with the crc32 instruction of SSE4.2 if the processor supports it */
+
+uint32_t cbor_crc32c(uint32_t crc, const void *data, size_t size); /* starts with zero, continues with previous result */
+
+/* running checksum of records written in parts: the caller passes every written range to cbor_checksum_update,
+   e.g. the bytes of each item before a sink flushes the buffer; records end with their big-endian CRC32C */
+
+void cbor_init_checksum(cbor_checksum_t *checksum);
+uint32_t cbor_checksum_update(cbor_checksum_t *checksum, const void *data, size_t size);
+cbor_bool_t cbor_write_checksum(uint8_t **data, size_t size, cbor_checksum_t *checksum); /* the next record starts after it */
+cbor_bool_t cbor_verify_checksum(const uint8_t *data, size_t size); /* size includes the checksum */
+
+/* columns of an array of maps, missing and null values are zeroed and cleared in validity,
+   numeric and boolean columns with sizes not supported by their types are rejected before any row */
+
+cbor_bool_t cbor_to_columns(cbor_token_t *token, cbor_column_t *columns, size_t columns_count, size_t rows_capacity, size_t *rows_count);
+cbor_bool_t cbor_from_columns(uint8_t **data, size_t size, const cbor_column_t *columns, size_t columns_count, size_t rows_count);
+
 #ifdef __cplusplus
 }
 #endif
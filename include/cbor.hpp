@@ -0,0 +1,591 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef CBOR_HPP
+#define CBOR_HPP
+
+#include "cbor.h"
+#include "cbor_read_inline.h" /* tokens are read with inlined functions */
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define CBORPHINE_CPP17
+#include <algorithm>
+#include <array>
+#include <cstring>
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#include <bit>
+#endif
+#include <limits>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#endif
+
+namespace cborphine
+{
+
+/* base class for cborphine::parse handlers, redefine methods for items to be handled */
+struct handler
+{
+    bool on_uint(cbor_base_uint_t) { return true; }
+    bool on_int(cbor_base_int_t) { return true; } /* negative integers only */
+    bool on_float(double) { return true; }
+    bool on_boolean(bool) { return true; }
+    bool on_null() { return true; }
+    bool on_undefined() { return true; }
+    bool on_special(uint8_t) { return true; }
+    bool on_string(const char *, size_t) { return true; }
+    bool on_bytes(const uint8_t *, size_t) { return true; }
+    bool on_array_start(cbor_base_uint_t) { return true; }
+    bool on_array_end() { return true; }
+    bool on_map_start(cbor_base_uint_t) { return true; }
+    bool on_map_end() { return true; }
+    bool on_tag(cbor_base_uint_t) { return true; }
+    void on_error(const char *) {}
+};
+
+/* same as cbor_parse, but handler calls are resolved at compile time and can be inlined */
+template <typename Handler>
+bool parse(const uint8_t *data, size_t data_size, Handler &handler)
+{
+#define CBOR_PARSE_CALLBACK0(name) (handler.name() ? CBOR_TRUE : CBOR_FALSE)
+#define CBOR_PARSE_CALLBACK1(name, value) (handler.name(value) ? CBOR_TRUE : CBOR_FALSE)
+#define CBOR_PARSE_CALLBACK2(name, value, size) (handler.name(value, size) ? CBOR_TRUE : CBOR_FALSE)
+#define CBOR_PARSE_ERROR(message) handler.on_error(message)
+#include "cbor_parse_inline.h"
+}
+
+#ifdef CBORPHINE_CPP17
+
+/*
+    Reflected structures are encoded as maps with field names as keys:
+
+    struct point { int32_t x; int32_t y; };
+    CBORPHINE_FIELDS(point, CBORPHINE_FIELD(point, x), CBORPHINE_FIELD(point, y))
+
+    Each key is encoded at compile time with its header and copied by its own memcpy,
+    values are written by cbor_write_* functions.
+*/
+
+template <typename T>
+struct fields; /* specialized by CBORPHINE_FIELDS */
+
+namespace detail
+{
+
+constexpr size_t header_size(uint64_t value)
+{
+    return value < 24 ? 1 : value < 256 ? 2 : value < 65536 ? 3 : value <= 0xFFFFFFFFu ? 5 : 9;
+}
+
+/* same width rules as cbor_internal_write_int_value */
+template <unsigned Major, uint64_t Value>
+constexpr std::array<uint8_t, header_size(Value)> header()
+{
+    std::array<uint8_t, header_size(Value)> bytes{};
+    size_t width = header_size(Value) - 1;
+
+    switch (width)
+    {
+    case 0: bytes[0] = (uint8_t)((Major << 5) | Value); break;
+    case 1: bytes[0] = (uint8_t)((Major << 5) | 24); break;
+    case 2: bytes[0] = (uint8_t)((Major << 5) | 25); break;
+    case 4: bytes[0] = (uint8_t)((Major << 5) | 26); break;
+    default: bytes[0] = (uint8_t)((Major << 5) | 27); break;
+    }
+
+    for (size_t i = 0; i < width; ++i)
+        bytes[1 + i] = (uint8_t)(Value >> (8 * (width - 1 - i)));
+
+    return bytes;
+}
+
+} // namespace detail
+
+/*
+    Constant items are encoded at compile time and written with a single memcpy:
+
+    constexpr auto prefix = cborphine::concat(cborphine::map_header<2>(),
+                                               cborphine::text("version"), cborphine::uint_value<3>());
+    cborphine::write(&data, size, prefix);
+*/
+
+template <uint64_t Value>
+constexpr std::array<uint8_t, detail::header_size(Value)> uint_value()
+{
+    return detail::header<0, Value>();
+}
+
+template <int64_t Value>
+constexpr auto int_value()
+{
+    if constexpr (Value < 0)
+        return detail::header<1, (uint64_t)(-(Value + 1))>();
+    else
+        return detail::header<0, (uint64_t)Value>();
+}
+
+template <uint64_t Size>
+constexpr std::array<uint8_t, detail::header_size(Size)> array_header()
+{
+    return detail::header<4, Size>();
+}
+
+template <uint64_t Size>
+constexpr std::array<uint8_t, detail::header_size(Size)> map_header()
+{
+    return detail::header<5, Size>();
+}
+
+template <uint64_t Tag>
+constexpr std::array<uint8_t, detail::header_size(Tag)> tag()
+{
+    return detail::header<6, Tag>();
+}
+
+template <bool Value>
+constexpr std::array<uint8_t, 1> boolean()
+{
+    return detail::header<7, Value ? 21 : 20>();
+}
+
+constexpr std::array<uint8_t, 1> null()
+{
+    return detail::header<7, 22>();
+}
+
+constexpr std::array<uint8_t, 1> undefined()
+{
+    return detail::header<7, 23>();
+}
+
+/* N includes null-terminating char */
+template <size_t N>
+constexpr std::array<uint8_t, detail::header_size(N - 1) + N - 1> text(const char (&str)[N])
+{
+    std::array<uint8_t, detail::header_size(N - 1) + N - 1> bytes = {};
+    constexpr std::array<uint8_t, detail::header_size(N - 1)> text_header = detail::header<3, N - 1>();
+
+    for (size_t i = 0; i < text_header.size(); ++i)
+        bytes[i] = text_header[i];
+    for (size_t i = 0; i < N - 1; ++i)
+        bytes[text_header.size() + i] = (uint8_t)str[i];
+
+    return bytes;
+}
+
+template <size_t N>
+constexpr std::array<uint8_t, detail::header_size(N) + N> bytes(const uint8_t (&value)[N])
+{
+    std::array<uint8_t, detail::header_size(N) + N> result = {};
+    constexpr std::array<uint8_t, detail::header_size(N)> bytes_header = detail::header<2, N>();
+
+    for (size_t i = 0; i < bytes_header.size(); ++i)
+        result[i] = bytes_header[i];
+    for (size_t i = 0; i < N; ++i)
+        result[bytes_header.size() + i] = value[i];
+
+    return result;
+}
+
+#if defined(__cpp_lib_bit_cast)
+constexpr std::array<uint8_t, 9> double_value(double value)
+{
+    std::array<uint8_t, 9> bytes = { 0xfb } /* double-precision float */;
+    uint64_t bits = std::bit_cast<uint64_t>(value);
+
+    for (size_t i = 0; i < 8; ++i)
+        bytes[1 + i] = (uint8_t)(bits >> (8 * (7 - i)));
+
+    return bytes;
+}
+
+constexpr std::array<uint8_t, 5> float_value(float value)
+{
+    std::array<uint8_t, 5> bytes = { 0xfa } /* single-precision float */;
+    uint32_t bits = std::bit_cast<uint32_t>(value);
+
+    for (size_t i = 0; i < 4; ++i)
+        bytes[1 + i] = (uint8_t)(bits >> (8 * (3 - i)));
+
+    return bytes;
+}
+#endif
+
+template <size_t... N>
+constexpr std::array<uint8_t, (N + ... + 0)> concat(const std::array<uint8_t, N> &... items)
+{
+    std::array<uint8_t, (N + ... + 0)> result = {};
+    size_t pos = 0;
+
+    ((void)[&]() constexpr {
+        for (size_t i = 0; i < items.size(); ++i)
+            result[pos++] = items[i];
+    }(), ...);
+
+    return result;
+}
+
+/* writes pre-encoded items, data is changed on success only */
+template <size_t N>
+bool write(uint8_t **data, size_t size, const std::array<uint8_t, N> &items)
+{
+    if (size < N)
+        return false;
+
+    std::memcpy(*data, items.data(), N);
+    *data += N;
+    return true;
+}
+
+namespace detail
+{
+
+/* text string key encoded at compile time, N includes null-terminating char */
+template <size_t N>
+struct key
+{
+    static constexpr size_t length = N - 1;
+    static constexpr size_t offset = header_size(N - 1);
+
+    std::array<uint8_t, offset + length> bytes;
+
+    constexpr key(const char (&str)[N]) : bytes(text(str))
+    {
+    }
+
+    bool matches(const char *str, size_t str_length) const
+    {
+        return str_length == length && std::memcmp(bytes.data() + offset, str, length) == 0;
+    }
+};
+
+} // namespace detail
+
+template <typename Class, typename Member, size_t N>
+struct field
+{
+    detail::key<N> key;
+    Member Class::*member;
+};
+
+template <typename Class, typename Member, size_t N>
+constexpr field<Class, Member, N> make_field(const char (&name)[N], Member Class::*member)
+{
+    return field<Class, Member, N>{ detail::key<N>(name), member };
+}
+
+#define CBORPHINE_FIELD(type, name) ::cborphine::make_field(#name, &type::name)
+
+#define CBORPHINE_FIELDS(type, ...) \
+    namespace cborphine { \
+    template <> struct fields<type> { static constexpr auto value = std::make_tuple(__VA_ARGS__); }; \
+    }
+
+template <typename T>
+bool encode(uint8_t **data, size_t size, const T &value);
+
+template <typename T>
+bool decode(cbor_token_t *token, T &value);
+
+namespace detail
+{
+
+template <typename T>
+struct is_vector : std::false_type {};
+
+template <typename T, typename Allocator>
+struct is_vector<std::vector<T, Allocator> > : std::true_type {};
+
+/* shared with the library, see cbor_read_inline.h */
+inline bool set_error(cbor_token_t *token, const char *error_message)
+{
+    return cbor_internal_set_error((cbor_token_data_t *)token, error_message) != CBOR_FALSE;
+}
+
+inline bool read_nested(cbor_token_t *token)
+{
+    return cbor_internal_read_nested((cbor_token_data_t *)token) != CBOR_FALSE;
+}
+
+inline bool skip_nested(cbor_token_t *token)
+{
+    return cbor_internal_skip_nested((cbor_token_data_t *)token) != CBOR_FALSE;
+}
+
+template <typename T>
+bool decode_map(cbor_token_t *token, T &value);
+
+template <typename V>
+bool write_value(uint8_t **data, size_t size, const V &value)
+{
+    if constexpr (std::is_same<V, bool>::value)
+        return cbor_write_boolean(data, size, value ? CBOR_TRUE : CBOR_FALSE) != CBOR_FALSE;
+    else if constexpr (std::is_integral<V>::value && std::is_unsigned<V>::value)
+        return cbor_write_uint(data, size, (cbor_base_uint_t)value) != CBOR_FALSE;
+    else if constexpr (std::is_integral<V>::value)
+        return cbor_write_int(data, size, (cbor_base_int_t)value) != CBOR_FALSE;
+    else if constexpr (std::is_same<V, float>::value)
+        return cbor_write_float(data, size, value) != CBOR_FALSE;
+    else if constexpr (std::is_same<V, double>::value)
+        return cbor_write_double(data, size, value) != CBOR_FALSE;
+    else if constexpr (std::is_same<V, std::string>::value)
+        return cbor_write_string_with_len(data, size, value.data(), value.size()) != CBOR_FALSE;
+    else if constexpr (is_vector<V>::value)
+    {
+        uint8_t *pos = *data;
+        uint8_t *end = *data + size;
+
+        if (!cbor_write_array(&pos, end - pos, (cbor_base_uint_t)value.size()))
+            return false;
+
+        for (const auto &item : value)
+        {
+            if (!write_value(&pos, end - pos, item))
+                return false;
+        }
+
+        *data = pos;
+        return true;
+    }
+    else
+        return encode(data, size, value);
+}
+
+/* reads the current item without moving to the next one */
+template <typename V>
+bool read_value(cbor_token_t *token, V &value)
+{
+    if constexpr (std::is_same<V, bool>::value)
+    {
+        if (token->type != CBOR_TOKEN_TYPE_BOOLEAN)
+            return set_error(token, "invalid data type");
+
+        value = CBOR_GET_BOOLEAN(token) != CBOR_FALSE;
+        return true;
+    }
+    else if constexpr (std::is_integral<V>::value && std::is_unsigned<V>::value)
+    {
+        if (token->type != CBOR_TOKEN_TYPE_PINT)
+            return set_error(token, "invalid data type");
+        if (CBOR_GET_PINT(token) > std::numeric_limits<V>::max())
+            return set_error(token, "integer overflow");
+
+        value = (V)CBOR_GET_PINT(token);
+        return true;
+    }
+    else if constexpr (std::is_integral<V>::value)
+    {
+        if (token->type != CBOR_TOKEN_TYPE_PINT && token->type != CBOR_TOKEN_TYPE_NINT)
+            return set_error(token, "invalid data type");
+        if (CBOR_GET_PINT(token) > ((cbor_base_uint_t)-1 >> 1))
+            return set_error(token, "integer overflow");
+
+        cbor_base_int_t int_value = token->type == CBOR_TOKEN_TYPE_PINT ?
+            (cbor_base_int_t)CBOR_GET_PINT(token) : CBOR_GET_NINT(token);
+
+        if (int_value < std::numeric_limits<V>::min() || int_value > std::numeric_limits<V>::max())
+            return set_error(token, "integer overflow");
+
+        value = (V)int_value;
+        return true;
+    }
+    else if constexpr (std::is_floating_point<V>::value)
+    {
+        if (token->type != CBOR_TOKEN_TYPE_FLOAT)
+            return set_error(token, "invalid data type");
+
+        value = (V)CBOR_GET_FLOAT(token);
+        return true;
+    }
+    else if constexpr (std::is_same<V, std::string>::value)
+    {
+        if (token->type != CBOR_TOKEN_TYPE_STRING)
+            return set_error(token, "invalid data type");
+
+        if (CBOR_GET_STRING(token) == NULL)
+        {
+            /* streamed from a refillable source */
+            const uint8_t *chunk;
+            size_t chunk_size;
+
+            value.clear();
+            while (cbor_read_source_chunk(token, &chunk, &chunk_size))
+                value.append((const char *)chunk, chunk_size);
+            return token->type != CBOR_TOKEN_TYPE_ERROR;
+        }
+
+        value.assign(CBOR_GET_STRING(token), (size_t)CBOR_GET_STRING_LENGTH(token));
+        return true;
+    }
+    else if constexpr (is_vector<V>::value)
+    {
+        if (token->type != CBOR_TOKEN_TYPE_ARRAY)
+            return set_error(token, "invalid data type");
+
+        const cbor_token_data_t *token_data = (const cbor_token_data_t *)token;
+        cbor_base_uint_t items_count = CBOR_GET_ARRAY(token);
+
+        /* every item takes a byte at least, the count itself is not trusted */
+        value.clear();
+        value.reserve((size_t)std::min<cbor_base_uint_t>(items_count, (cbor_base_uint_t)(token_data->end - token_data->pos)));
+
+        for (cbor_base_uint_t i = 0; i < items_count; ++i)
+        {
+            value.emplace_back();
+
+            if (!read_nested(token))
+                return false;
+
+            if constexpr (std::is_same<typename V::value_type, bool>::value)
+            {
+                /* items of std::vector<bool> are proxies */
+                bool item = false;
+
+                if (!read_value(token, item))
+                    return false;
+                value.back() = item;
+            }
+            else if (!read_value(token, value.back()))
+                return false;
+        }
+
+        return true;
+    }
+    else
+        return decode_map(token, value);
+}
+
+template <typename Class, typename Member, size_t N>
+bool encode_field(uint8_t *&pos, uint8_t *end, const field<Class, Member, N> &field, const Class &value)
+{
+    if (!write(&pos, end - pos, field.key.bytes))
+        return false;
+
+    return write_value(&pos, end - pos, value.*field.member);
+}
+
+template <typename T, size_t... I>
+bool encode_fields(uint8_t *&pos, uint8_t *end, const T &value, std::index_sequence<I...>)
+{
+    return (encode_field(pos, end, std::get<I>(fields<T>::value), value) && ...);
+}
+
+template <size_t I, typename T>
+bool decode_field_if_matches(cbor_token_t *token, const char *key, size_t key_length, T &value, bool &result)
+{
+    const auto &field = std::get<I>(fields<T>::value);
+
+    if (!field.key.matches(key, key_length))
+        return false;
+
+    result = read_nested(token) && read_value(token, value.*field.member);
+    return true;
+}
+
+/* returns false if the key doesn't match any field */
+template <typename T, size_t... I>
+bool decode_field(cbor_token_t *token, const char *key, size_t key_length, size_t expected_index, T &value, bool &result,
+                  std::index_sequence<I...>)
+{
+    /* fields are usually written in order of declaration */
+    return ((I == expected_index && decode_field_if_matches<I>(token, key, key_length, value, result)) || ...) ||
+           (decode_field_if_matches<I>(token, key, key_length, value, result) || ...);
+}
+
+/* decodes the current map without moving to the next item */
+template <typename T>
+bool decode_map(cbor_token_t *token, T &value)
+{
+    constexpr size_t fields_count = std::tuple_size<typename std::decay<decltype(fields<T>::value)>::type>::value;
+
+    if (token->type != CBOR_TOKEN_TYPE_MAP)
+        return set_error(token, "invalid data type");
+
+    cbor_base_uint_t items_count = CBOR_GET_MAP(token);
+    for (cbor_base_uint_t i = 0; i < items_count; ++i)
+    {
+        bool result = true;
+
+        if (!read_nested(token))
+            return false;
+
+        if (token->type == CBOR_TOKEN_TYPE_STRING && CBOR_GET_STRING(token) == NULL)
+            return set_error(token, "key larger than window"); /* streamed */
+
+        if (token->type == CBOR_TOKEN_TYPE_STRING &&
+            decode_field(token, CBOR_GET_STRING(token), (size_t)CBOR_GET_STRING_LENGTH(token), (size_t)i, value, result,
+                         std::make_index_sequence<fields_count>()))
+        {
+            if (!result)
+                return false;
+            continue;
+        }
+
+        /* unknown field */
+        if (!skip_nested(token) || !read_nested(token) || !skip_nested(token))
+            return false;
+    }
+
+    return true;
+}
+
+} // namespace detail
+
+/* encodes reflected structure as a map, data is changed on success only */
+template <typename T>
+bool encode(uint8_t **data, size_t size, const T &value)
+{
+    constexpr size_t fields_count = std::tuple_size<typename std::decay<decltype(fields<T>::value)>::type>::value;
+    uint8_t *pos = *data;
+    uint8_t *end = *data + size;
+
+    if (!write(&pos, end - pos, map_header<fields_count>()))
+        return false;
+
+    if (!detail::encode_fields(pos, end, value, std::make_index_sequence<fields_count>()))
+        return false;
+
+    *data = pos;
+    return true;
+}
+
+/* decodes reflected structure, moves to the next item like cbor_read_* functions */
+template <typename T>
+bool decode(cbor_token_t *token, T &value)
+{
+    if (!detail::decode_map(token, value))
+        return false;
+
+    if (((cbor_token_data_t *)token)->next_on_read)
+        cbor_read_next(token);
+
+    return true;
+}
+
+#endif // CBORPHINE_CPP17
+
+} // namespace cborphine
+
+#endif
@@ -0,0 +1,174 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+    Parse loop shared by cbor_parse and cborphine::parse, included as the body of a function
+    with data and data_size parameters after cbor_read_inline.h. The includer defines:
+
+    CBOR_PARSE_CALLBACK0(name)
+    CBOR_PARSE_CALLBACK1(name, value)
+    CBOR_PARSE_CALLBACK2(name, value, size)  call a callback, evaluate to CBOR_FALSE to stop parsing
+    CBOR_PARSE_ERROR(message)                reports an error
+
+    Tokens are read with the inlined cbor_internal_read_next, the macros are undefined at the end.
+    This header is not a stable API, applications use cbor_parse or cborphine::parse.
+*/
+
+    struct
+    {
+        cbor_base_uint_t items_left; /* items to read before the end of container, map entries are counted twice */
+        cbor_bool_t is_map;
+    } containers[CBOR_MAX_NESTING_DEPTH];
+    size_t depth = 0;
+    cbor_bool_t tag_pending = CBOR_FALSE;
+    cbor_bool_t result;
+    cbor_token_data_t token;
+
+    cbor_internal_init_token(&token, data, data + data_size);
+
+    while (cbor_internal_read_next(&token))
+    {
+        switch (token.type)
+        {
+        case CBOR_TOKEN_TYPE_PINT:
+            result = CBOR_PARSE_CALLBACK1(on_uint, CBOR_GET_PINT(&token));
+            break;
+        case CBOR_TOKEN_TYPE_NINT:
+            result = CBOR_PARSE_CALLBACK1(on_int, CBOR_GET_NINT(&token));
+            break;
+        case CBOR_TOKEN_TYPE_FLOAT:
+            result = CBOR_PARSE_CALLBACK1(on_float, CBOR_GET_FLOAT(&token));
+            break;
+        case CBOR_TOKEN_TYPE_BOOLEAN:
+            result = CBOR_PARSE_CALLBACK1(on_boolean, CBOR_GET_BOOLEAN(&token));
+            break;
+        case CBOR_TOKEN_TYPE_NULL:
+            result = CBOR_PARSE_CALLBACK0(on_null);
+            break;
+        case CBOR_TOKEN_TYPE_UNDEFINED:
+            result = CBOR_PARSE_CALLBACK0(on_undefined);
+            break;
+        case CBOR_TOKEN_TYPE_SPECIAL:
+            result = CBOR_PARSE_CALLBACK1(on_special, CBOR_GET_SPECIAL(&token));
+            break;
+        case CBOR_TOKEN_TYPE_STRING:
+            result = CBOR_PARSE_CALLBACK2(on_string, CBOR_GET_STRING(&token), (size_t)CBOR_GET_STRING_LENGTH(&token));
+            break;
+        case CBOR_TOKEN_TYPE_BYTES:
+            result = CBOR_PARSE_CALLBACK2(on_bytes, CBOR_GET_BYTES(&token), (size_t)CBOR_GET_BYTES_SIZE(&token));
+            break;
+        case CBOR_TOKEN_TYPE_TAG:
+            if (CBOR_PARSE_CALLBACK1(on_tag, CBOR_GET_TAG(&token)) == CBOR_FALSE)
+                return CBOR_FALSE;
+
+            tag_pending = CBOR_TRUE;
+            continue; /* tag belongs to the next item */
+        case CBOR_TOKEN_TYPE_ARRAY:
+        case CBOR_TOKEN_TYPE_MAP:
+            {
+                cbor_bool_t is_map = (token.type == CBOR_TOKEN_TYPE_MAP) ? CBOR_TRUE : CBOR_FALSE;
+                cbor_base_uint_t items_count = token.int_value;
+
+                if (is_map)
+                    result = CBOR_PARSE_CALLBACK1(on_map_start, items_count);
+                else
+                    result = CBOR_PARSE_CALLBACK1(on_array_start, items_count);
+
+                if (result == CBOR_FALSE)
+                    return CBOR_FALSE;
+
+                tag_pending = CBOR_FALSE;
+
+                if (items_count > 0)
+                {
+                    if (depth == CBOR_MAX_NESTING_DEPTH)
+                    {
+                        CBOR_PARSE_ERROR("maximum nesting depth exceeded");
+                        return CBOR_FALSE;
+                    }
+
+                    if (is_map)
+                    {
+                        if (items_count > ((cbor_base_uint_t)-1) / 2)
+                        {
+                            CBOR_PARSE_ERROR("map is too large");
+                            return CBOR_FALSE;
+                        }
+
+                        items_count *= 2; /* keys and values */
+                    }
+
+                    containers[depth].items_left = items_count;
+                    containers[depth].is_map = is_map;
+                    ++depth;
+                    continue; /* container is completed by its last item */
+                }
+
+                if (is_map)
+                    result = CBOR_PARSE_CALLBACK0(on_map_end);
+                else
+                    result = CBOR_PARSE_CALLBACK0(on_array_end);
+            }
+            break;
+        default:
+            CBOR_PARSE_ERROR("unknown error");
+            return CBOR_FALSE;
+        }
+
+        if (result == CBOR_FALSE)
+            return CBOR_FALSE;
+
+        tag_pending = CBOR_FALSE;
+
+        /* item is completed, close all containers completed by it */
+        while (depth > 0 && --containers[depth - 1].items_left == 0)
+        {
+            --depth;
+
+            if (containers[depth].is_map)
+                result = CBOR_PARSE_CALLBACK0(on_map_end);
+            else
+                result = CBOR_PARSE_CALLBACK0(on_array_end);
+
+            if (result == CBOR_FALSE)
+                return CBOR_FALSE;
+        }
+    }
+
+    if (token.type == CBOR_TOKEN_TYPE_ERROR)
+    {
+        CBOR_PARSE_ERROR(token.error_message);
+        return CBOR_FALSE;
+    }
+
+    if (depth > 0 || tag_pending)
+    {
+        CBOR_PARSE_ERROR("insufficient data");
+        return CBOR_FALSE;
+    }
+
+    return CBOR_TRUE;
+
+#undef CBOR_PARSE_CALLBACK0
+#undef CBOR_PARSE_CALLBACK1
+#undef CBOR_PARSE_CALLBACK2
+#undef CBOR_PARSE_ERROR
@@ -0,0 +1,427 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef CBOR_READ_INLINE_H
+#define CBOR_READ_INLINE_H
+
+/*
+    Inlined token reading for cborphine::parse and reflected decoding in cbor.hpp, also used by the library.
+    Functions of this header are not a stable API, applications read tokens with cbor_read_* functions.
+*/
+
+#include <string.h>
+#include "cbor.h"
+
+#ifdef _MSC_VER
+#define CBOR_READ_INLINE static __inline
+#else
+#define CBOR_READ_INLINE static inline
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+CBOR_READ_INLINE uint8_t *cbor_internal_swap_2bytes(uint8_t *dest, const uint8_t *src)
+{
+#ifdef CBOR_BIGENDIAN_PLATFORM
+    memcpy(dest, src, 2);
+#else
+    uint16_t orig_value = *(uint16_t *)src;
+    *(uint16_t *)dest = (orig_value << 8) |
+                        (orig_value >> 8);
+#endif
+
+    return dest + 2;
+}
+
+CBOR_READ_INLINE uint8_t *cbor_internal_swap_4bytes(uint8_t *dest, const uint8_t *src)
+{
+#ifdef CBOR_BIGENDIAN_PLATFORM
+    memcpy(dest, src, 4);
+#else
+    uint32_t orig_value = *(uint32_t *)src;
+    *(uint32_t *)dest = ((orig_value & 0x000000FF) << 24) |
+                        ((orig_value & 0x0000FF00) << 8)  |
+                        ((orig_value & 0x00FF0000) >> 8)  |
+                        ((orig_value & 0xFF000000) >> 24);
+#endif
+
+    return dest + 4;
+}
+
+CBOR_READ_INLINE uint8_t *cbor_internal_swap_8bytes(uint8_t *dest, const uint8_t *src)
+{
+#ifdef CBOR_BIGENDIAN_PLATFORM
+    memcpy(dest, src, 8);
+    return dest + 8;
+#else
+    return cbor_internal_swap_4bytes(cbor_internal_swap_4bytes(dest, src + 4), src);
+#endif
+}
+
+CBOR_READ_INLINE int cbor_internal_get_width(unsigned int minor_type)
+{
+    if (minor_type < 24)
+        return 0;
+
+    switch (minor_type)
+    {
+    case 24: return 1;
+    case 25: return 2;
+    case 26: return 4;
+    case 27: return 8;
+    }
+
+    return -1;
+}
+
+CBOR_READ_INLINE cbor_bool_t cbor_internal_read_int_value(unsigned int minor_type, cbor_token_data_t *token)
+{
+    int type_width = cbor_internal_get_width(minor_type);
+
+    if (type_width < 0)
+    {
+        token->type = CBOR_TOKEN_TYPE_ERROR;
+        token->error_message = "invalid type width";
+        return CBOR_FALSE;
+    }
+
+    if ((size_t)(token->end - token->pos) < (size_t)type_width)
+    {
+        token->type = CBOR_TOKEN_TYPE_ERROR;
+        token->error_message = "insufficient data";
+        return CBOR_FALSE;
+    }
+
+    switch (type_width)
+    {
+    case 0:
+        token->int_value = minor_type;
+        return CBOR_TRUE;
+    case 1:
+        token->int_value = *token->pos;
+        token->pos += 1; /* bytes processed */
+        return CBOR_TRUE;
+    case 2:
+        {
+            uint16_t short_value;
+            cbor_internal_swap_2bytes((uint8_t *)&short_value, token->pos);
+            token->int_value = short_value;
+            token->pos += 2; /* bytes processed */
+            return CBOR_TRUE;
+        }
+    case 4:
+        {
+            uint32_t int_value;
+            cbor_internal_swap_4bytes((uint8_t *)&int_value, token->pos);
+            token->int_value = int_value;
+            token->pos += 4; /* bytes processed */
+            return CBOR_TRUE;
+        }
+    case 8:
+#ifdef CBOR_INT64_SUPPORT
+        {
+            cbor_base_uint_t value;
+            cbor_internal_swap_8bytes((uint8_t *)&value, token->pos);
+            token->int_value = value;
+            token->pos += 8; /* bytes processed */
+            return CBOR_TRUE;
+        }
+#else
+        token->type = CBOR_TOKEN_TYPE_ERROR;
+        token->error_message = "64 bits integers are not supported";
+        return CBOR_FALSE;
+#endif
+    }
+
+    token->type = CBOR_TOKEN_TYPE_ERROR;
+    token->error_message = "unknown error";
+    return CBOR_FALSE;
+}
+
+CBOR_READ_INLINE cbor_bool_t cbor_internal_extract_special_value(unsigned int minor_type, cbor_token_data_t *token)
+{
+    switch (minor_type)
+    {
+    case 20: /* false */
+        token->type = CBOR_TOKEN_TYPE_BOOLEAN;
+        token->int_value = CBOR_FALSE;
+        return CBOR_TRUE;
+    case 21: /* true */
+        token->type = CBOR_TOKEN_TYPE_BOOLEAN;
+        token->int_value = CBOR_TRUE;
+        return CBOR_TRUE;
+    case 22: /* null */
+        token->type = CBOR_TOKEN_TYPE_NULL;
+        return CBOR_TRUE;
+    case 23: /* undefined */
+        token->type = CBOR_TOKEN_TYPE_UNDEFINED;
+        return CBOR_TRUE;
+    case 26: /* single-precision float */
+        if ((size_t)(token->end - token->pos) < 4)
+        {
+            token->type = CBOR_TOKEN_TYPE_ERROR;
+            token->error_message = "insufficient data";
+            return CBOR_FALSE;
+        }
+        {
+            float float_value;
+            cbor_internal_swap_4bytes((uint8_t *)&float_value, token->pos);
+
+            token->type = CBOR_TOKEN_TYPE_FLOAT;
+            token->float_value = float_value;
+            token->pos += 4; /* bytes processed */
+            return CBOR_TRUE;
+        }
+    case 27: /* double-precision float */
+        if ((size_t)(token->end - token->pos) < 8)
+        {
+            token->type = CBOR_TOKEN_TYPE_ERROR;
+            token->error_message = "insufficient data";
+            return CBOR_FALSE;
+        }
+        {
+            double double_value;
+            cbor_internal_swap_8bytes((uint8_t *)&double_value, token->pos);
+
+            token->type = CBOR_TOKEN_TYPE_FLOAT;
+            token->float_value = double_value;
+            token->pos += 8; /* bytes processed */
+            return CBOR_TRUE;
+        }
+    default:
+        {
+            if (cbor_internal_read_int_value(minor_type, token) == CBOR_FALSE)
+                return CBOR_FALSE;
+
+            token->type = CBOR_TOKEN_TYPE_SPECIAL;
+            return CBOR_TRUE;
+        }
+    }
+}
+
+CBOR_READ_INLINE void cbor_internal_init_token(cbor_token_data_t *token, const uint8_t *pos, const uint8_t *end)
+{
+    token->type = CBOR_TOKEN_TYPE_END;
+    token->pos = pos;
+    token->end = end;
+    token->next_on_read = CBOR_FALSE;
+    token->source = NULL;
+}
+
+/* refillable sources, see source.c */
+
+cbor_bool_t cbor_internal_prepare_source(cbor_token_data_t *token);
+cbor_bool_t cbor_internal_fill_payload(cbor_token_data_t *token);
+
+CBOR_READ_INLINE cbor_bool_t cbor_internal_read_next(cbor_token_data_t *token)
+{
+    static const cbor_token_type_t cbor_internal_types_map[] =
+    {
+        CBOR_TOKEN_TYPE_PINT,   /* 0 */
+        CBOR_TOKEN_TYPE_NINT,   /* 1 */
+        CBOR_TOKEN_TYPE_BYTES,  /* 2 */
+        CBOR_TOKEN_TYPE_STRING, /* 3 */
+        CBOR_TOKEN_TYPE_ARRAY,  /* 4 */
+        CBOR_TOKEN_TYPE_MAP,    /* 5 */
+        CBOR_TOKEN_TYPE_TAG,    /* 6 */
+        CBOR_TOKEN_TYPE_SPECIAL /* 7 */
+    };
+    unsigned int major_type;
+    unsigned int minor_type;
+    const uint8_t *current_pos;
+
+    if (token->type == CBOR_TOKEN_TYPE_ERROR)
+        return CBOR_FALSE; /* state is not changed */
+
+    if (token->source != NULL && cbor_internal_prepare_source(token) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    current_pos = token->pos;
+
+    if (current_pos >= token->end)
+    {
+        token->type = CBOR_TOKEN_TYPE_END;
+        return CBOR_FALSE; /* nothing to read */
+    }
+
+    major_type = (*current_pos >> 5);
+    minor_type = (*current_pos & 31);
+    token->start = current_pos;
+    token->pos += 1; /* initial byte is processed */
+
+    switch (major_type)
+    {
+    case 0: /* positive integer */
+        if (cbor_internal_read_int_value(minor_type, token))
+        {
+            token->type = CBOR_TOKEN_TYPE_PINT;
+            return CBOR_TRUE;
+        }
+        break;
+    case 1: /* negative integer */
+        if (cbor_internal_read_int_value(minor_type, token))
+        {
+            token->type = CBOR_TOKEN_TYPE_NINT;
+            return CBOR_TRUE;
+        }
+        break;
+    case 2: /* bytes */
+    case 3: /* string */
+        if (cbor_internal_read_int_value(minor_type, token))
+        {
+            if (token->source != NULL)
+            {
+                if (cbor_internal_fill_payload(token))
+                {
+                    token->type = cbor_internal_types_map[major_type];
+                    return CBOR_TRUE;
+                }
+
+                if (token->type == CBOR_TOKEN_TYPE_ERROR)
+                    break; /* failed refill */
+            }
+
+            if ((size_t)(token->end - token->pos) < token->int_value)
+            {
+                token->type = CBOR_TOKEN_TYPE_ERROR;
+                token->error_message = "insufficient data";
+            }
+            else
+            {
+                token->type = cbor_internal_types_map[major_type];
+                token->bytes_value = token->pos; /* set data pointer */
+                token->pos += token->int_value; /* skip bytes */
+                return CBOR_TRUE;
+            }
+        }
+        break;
+    case 4: /* array */
+    case 5: /* map */
+    case 6: /* tag */
+        if (cbor_internal_read_int_value(minor_type, token))
+        {
+            token->type = cbor_internal_types_map[major_type];
+            return CBOR_TRUE;
+        }
+        break;
+    case 7: /* special */
+        if (cbor_internal_extract_special_value(minor_type, token))
+            return CBOR_TRUE;
+        break;
+    default:
+        token->type = CBOR_TOKEN_TYPE_ERROR;
+        token->error_message = "unknown error";
+        break;
+    }
+
+    token->pos = current_pos; /* restore original position */
+    return CBOR_FALSE;
+}
+
+CBOR_READ_INLINE void cbor_internal_try_to_read_next(cbor_token_data_t *token)
+{
+    if (token->next_on_read)
+        cbor_internal_read_next(token);
+}
+
+/* reads next item inside of array or map, end of data is an error here */
+CBOR_READ_INLINE cbor_bool_t cbor_internal_read_nested(cbor_token_data_t *token)
+{
+    if (cbor_internal_read_next(token))
+        return CBOR_TRUE;
+
+    if (token->type == CBOR_TOKEN_TYPE_END)
+    {
+        token->type = CBOR_TOKEN_TYPE_ERROR;
+        token->error_message = "insufficient data";
+    }
+
+    return CBOR_FALSE;
+}
+
+/* skips nested items of the current item, the token is left on the last of them */
+CBOR_READ_INLINE cbor_bool_t cbor_internal_skip_nested(cbor_token_data_t *token)
+{
+    cbor_base_uint_t items_left = 0;
+
+    for (;;)
+    {
+        switch (token->type)
+        {
+        case CBOR_TOKEN_TYPE_ARRAY:
+            if (token->int_value > (cbor_base_uint_t)-1 - items_left)
+            {
+                token->type = CBOR_TOKEN_TYPE_ERROR;
+                token->error_message = "too many nested items";
+                return CBOR_FALSE;
+            }
+            items_left += token->int_value;
+            break;
+        case CBOR_TOKEN_TYPE_MAP:
+            if (token->int_value > ((cbor_base_uint_t)-1 - items_left) / 2)
+            {
+                token->type = CBOR_TOKEN_TYPE_ERROR;
+                token->error_message = "too many nested items";
+                return CBOR_FALSE;
+            }
+            items_left += token->int_value * 2; /* keys and values */
+            break;
+        case CBOR_TOKEN_TYPE_TAG:
+            if (items_left == (cbor_base_uint_t)-1)
+            {
+                token->type = CBOR_TOKEN_TYPE_ERROR;
+                token->error_message = "too many nested items";
+                return CBOR_FALSE;
+            }
+            items_left += 1; /* tagged item */
+            break;
+        case CBOR_TOKEN_TYPE_END:
+        case CBOR_TOKEN_TYPE_ERROR:
+            return CBOR_FALSE;
+        default:
+            break;
+        }
+
+        if (items_left == 0)
+            return CBOR_TRUE;
+
+        --items_left;
+
+        if (cbor_internal_read_nested(token) == CBOR_FALSE)
+            return CBOR_FALSE;
+    }
+}
+
+CBOR_READ_INLINE cbor_bool_t cbor_internal_set_error(cbor_token_data_t *token, const char *error_message)
+{
+    token->type = CBOR_TOKEN_TYPE_ERROR;
+    token->error_message = error_message;
+    return CBOR_FALSE;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -29,42 +29,349 @@ THE SOFTWARE.
 #define CBOR_INLINE static inline
 #endif
 
-CBOR_INLINE uint8_t *cbor_internal_swap_2bytes(uint8_t *dest, const uint8_t *src)
+#include "cbor_read_inline.h"
+
+/* fixed width values shared by the writers */
+
+#define CBOR_CREATE_INITIAL_BYTE(major_type, minor_type) ((uint8_t) (((major_type) << 5) | (minor_type)))
+
+#define CBOR_MAX_INJECTED_LIMIT 24
+#define CBOR_MAX_1BYTE_LIMIT    256
+#define CBOR_MAX_2BYTE_LIMIT    65536
+#define CBOR_MAX_4BYTE_LIMIT    4294967296
+
+/* smallest header width of a value, 0 if it is injected in the initial byte */
+CBOR_INLINE size_t cbor_internal_get_value_width(cbor_base_uint_t value)
 {
-#ifdef CBOR_BIGENDIAN_PLATFORM
-    memcpy(dest, src, 2);
+    if (value < CBOR_MAX_INJECTED_LIMIT)
+        return 0;
+    if (value < CBOR_MAX_1BYTE_LIMIT)
+        return 1;
+    if (value < CBOR_MAX_2BYTE_LIMIT)
+        return 2;
+#ifdef CBOR_INT64_SUPPORT
+    if (value < CBOR_MAX_4BYTE_LIMIT)
+        return 4;
+
+    return 8;
 #else
-    uint16_t orig_value = *(uint16_t *)src;
-    *(uint16_t *)dest = (orig_value << 8) |
-                        (orig_value >> 8);
+    return 4;
 #endif
-
-    return dest + 2;
 }
 
-CBOR_INLINE uint8_t *cbor_internal_swap_4bytes(uint8_t *dest, const uint8_t *src)
+CBOR_INLINE cbor_bool_t cbor_internal_fits_width(cbor_base_uint_t value, size_t width)
 {
-#ifdef CBOR_BIGENDIAN_PLATFORM
-    memcpy(dest, src, 4);
+    switch (width)
+    {
+    case 1: return value <= 0xFF ? CBOR_TRUE : CBOR_FALSE;
+    case 2: return value <= 0xFFFF ? CBOR_TRUE : CBOR_FALSE;
+#ifdef CBOR_INT64_SUPPORT
+    case 4: return value <= 0xFFFFFFFF ? CBOR_TRUE : CBOR_FALSE;
+    case 8: return CBOR_TRUE;
 #else
-    uint32_t orig_value = *(uint32_t *)src;
-    *(uint32_t *)dest = ((orig_value & 0x000000FF) << 24) |
-                        ((orig_value & 0x0000FF00) << 8)  |
-                        ((orig_value & 0x00FF0000) >> 8)  |
-                        ((orig_value & 0xFF000000) >> 24);
+    case 4: return CBOR_TRUE;
 #endif
+    }
 
-    return dest + 4;
+    return CBOR_FALSE;
 }
 
-CBOR_INLINE uint8_t *cbor_internal_swap_8bytes(uint8_t *dest, const uint8_t *src)
+/* writes initial byte and value of the given width, even if the value could be shorter */
+CBOR_INLINE void cbor_internal_store_fixed_int_value(uint8_t *pos, unsigned int type, size_t width, cbor_base_uint_t value)
 {
-#ifdef CBOR_BIGENDIAN_PLATFORM
-    memcpy(dest, src, 8);
-    return dest + 8;
-#else
-    return cbor_internal_swap_4bytes(cbor_internal_swap_4bytes(dest, src + 4), src);
+    switch (width)
+    {
+    case 1:
+        pos[0] = CBOR_CREATE_INITIAL_BYTE(type, 24);
+        pos[1] = (uint8_t)value;
+        break;
+    case 2:
+        {
+            uint16_t short_value = (uint16_t)value;
+            pos[0] = CBOR_CREATE_INITIAL_BYTE(type, 25);
+            cbor_internal_swap_2bytes(pos + 1, (const uint8_t *)&short_value);
+        }
+        break;
+    case 4:
+        {
+            uint32_t int_value = (uint32_t)value;
+            pos[0] = CBOR_CREATE_INITIAL_BYTE(type, 26);
+            cbor_internal_swap_4bytes(pos + 1, (const uint8_t *)&int_value);
+        }
+        break;
+#ifdef CBOR_INT64_SUPPORT
+    case 8:
+        pos[0] = CBOR_CREATE_INITIAL_BYTE(type, 27);
+        cbor_internal_swap_8bytes(pos + 1, (const uint8_t *)&value);
+        break;
+#endif
+    }
+}
+
+/* big-endian values of frames, checksums and indexes, stored byte by byte without alignment requirements */
+
+CBOR_INLINE uint8_t *cbor_internal_store_uint32(uint8_t *pos, uint32_t value)
+{
+    pos[0] = (uint8_t)(value >> 24);
+    pos[1] = (uint8_t)(value >> 16);
+    pos[2] = (uint8_t)(value >> 8);
+    pos[3] = (uint8_t)value;
+
+    return pos + 4;
+}
+
+CBOR_INLINE uint32_t cbor_internal_load_uint32(const uint8_t *pos)
+{
+    return ((uint32_t)pos[0] << 24) | ((uint32_t)pos[1] << 16) | ((uint32_t)pos[2] << 8) | (uint32_t)pos[3];
+}
+
+/* token decoding shared by the readers, tokens are read by cbor_read_inline.h */
+
+#define CBOR_GET_MAJOR_TYPE(initial_byte) ((initial_byte) >> 5)
+#define CBOR_GET_MINOR_TYPE(initial_byte) ((initial_byte) & 31)
+
+CBOR_INLINE cbor_bool_t cbor_internal_check_type(cbor_token_data_t *token, cbor_token_type_t expected_type)
+{
+    if (token->type != expected_type)
+    {
+        token->type = CBOR_TOKEN_TYPE_ERROR;
+        token->error_message = "invalid data type";
+        return CBOR_FALSE;
+    }
+
+    return CBOR_TRUE;
+}
+
+/* refillable sources, see source.c */
+
+cbor_bool_t cbor_internal_copy_streamed_payload(cbor_token_data_t *token, uint8_t *dest, size_t size);
+
+CBOR_INLINE cbor_bool_t cbor_internal_copy_payload(cbor_token_data_t *token, uint8_t *dest, size_t size)
+{
+    if (token->bytes_value == NULL)
+        return cbor_internal_copy_streamed_payload(token, dest, size);
+
+    memcpy(dest, token->bytes_value, size);
+    return CBOR_TRUE;
+}
+
+/* numeric and boolean values shared by structures and columns */
+
+/* compares a null-terminated name with a decoded key without reading past the end of either */
+CBOR_INLINE cbor_bool_t cbor_internal_match_name(const char *name, const char *key, size_t key_length)
+{
+    size_t i;
+
+    for (i = 0; i < key_length; ++i)
+    {
+        if (name[i] != key[i] || name[i] == 0)
+            return CBOR_FALSE;
+    }
+
+    return name[key_length] == 0 ? CBOR_TRUE : CBOR_FALSE;
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_store_uint(uint8_t *dest, size_t size, cbor_base_uint_t value)
+{
+    switch (size)
+    {
+    case 1:
+        if (value > 0xFF)
+            return CBOR_FALSE;
+        *(uint8_t *)dest = (uint8_t)value;
+        return CBOR_TRUE;
+    case 2:
+        if (value > 0xFFFF)
+            return CBOR_FALSE;
+        *(uint16_t *)dest = (uint16_t)value;
+        return CBOR_TRUE;
+    case 4:
+        if (value > 0xFFFFFFFF)
+            return CBOR_FALSE;
+        *(uint32_t *)dest = (uint32_t)value;
+        return CBOR_TRUE;
+#ifdef CBOR_INT64_SUPPORT
+    case 8:
+        *(uint64_t *)dest = value;
+        return CBOR_TRUE;
+#endif
+    }
+
+    return CBOR_FALSE;
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_store_int(uint8_t *dest, size_t size, cbor_base_int_t value)
+{
+    switch (size)
+    {
+    case 1:
+        if (value < INT8_MIN || value > INT8_MAX)
+            return CBOR_FALSE;
+        *(int8_t *)dest = (int8_t)value;
+        return CBOR_TRUE;
+    case 2:
+        if (value < INT16_MIN || value > INT16_MAX)
+            return CBOR_FALSE;
+        *(int16_t *)dest = (int16_t)value;
+        return CBOR_TRUE;
+    case 4:
+        if (value < INT32_MIN || value > INT32_MAX)
+            return CBOR_FALSE;
+        *(int32_t *)dest = (int32_t)value;
+        return CBOR_TRUE;
+#ifdef CBOR_INT64_SUPPORT
+    case 8:
+        *(int64_t *)dest = value;
+        return CBOR_TRUE;
+#endif
+    }
+
+    return CBOR_FALSE;
+}
+
+/* sizes of values supported by a field type, checked once by descriptors before values are read or written */
+CBOR_INLINE cbor_bool_t cbor_internal_check_value_size(cbor_field_type_t type, size_t size)
+{
+    switch (type)
+    {
+    case CBOR_FIELD_TYPE_UINT:
+    case CBOR_FIELD_TYPE_INT:
+    case CBOR_FIELD_TYPE_BOOLEAN:
+        switch (size)
+        {
+        case 1:
+        case 2:
+        case 4:
+#ifdef CBOR_INT64_SUPPORT
+        case 8:
 #endif
+            return CBOR_TRUE;
+        }
+        return CBOR_FALSE;
+    case CBOR_FIELD_TYPE_FLOAT:
+        return size == sizeof(float) || size == sizeof(double) ? CBOR_TRUE : CBOR_FALSE;
+    case CBOR_FIELD_TYPE_STRING:
+        return size > 0 ? CBOR_TRUE : CBOR_FALSE; /* null-terminating char */
+    case CBOR_FIELD_TYPE_BYTES:
+        return CBOR_TRUE;
+    }
+
+    return CBOR_FALSE;
+}
+
+CBOR_INLINE cbor_base_uint_t cbor_internal_load_uint(const uint8_t *src, size_t size)
+{
+    switch (size)
+    {
+    case 1: return *(const uint8_t *)src;
+    case 2: return *(const uint16_t *)src;
+    case 4: return *(const uint32_t *)src;
+#ifdef CBOR_INT64_SUPPORT
+    case 8: return *(const uint64_t *)src;
+#endif
+    }
+
+    return 0;
+}
+
+/* reads the current item into value of the given type and size */
+CBOR_INLINE cbor_bool_t cbor_internal_decode_scalar(cbor_token_data_t *token, cbor_field_type_t type, size_t size, uint8_t *dest)
+{
+    switch (type)
+    {
+    case CBOR_FIELD_TYPE_UINT:
+        if (cbor_internal_check_type(token, CBOR_TOKEN_TYPE_PINT) == CBOR_FALSE)
+            return CBOR_FALSE;
+        if (cbor_internal_store_uint(dest, size, CBOR_GET_PINT(token)) == CBOR_FALSE)
+            return cbor_internal_set_error(token, "integer overflow");
+        return CBOR_TRUE;
+    case CBOR_FIELD_TYPE_INT:
+        if (token->type != CBOR_TOKEN_TYPE_PINT && token->type != CBOR_TOKEN_TYPE_NINT)
+            return cbor_internal_set_error(token, "invalid data type");
+        if (CBOR_GET_PINT(token) > ((cbor_base_uint_t)-1 >> 1))
+            return cbor_internal_set_error(token, "integer overflow");
+        if (cbor_internal_store_int(dest, size, token->type == CBOR_TOKEN_TYPE_PINT ?
+                                    (cbor_base_int_t)CBOR_GET_PINT(token) : CBOR_GET_NINT(token)) == CBOR_FALSE)
+            return cbor_internal_set_error(token, "integer overflow");
+        return CBOR_TRUE;
+    case CBOR_FIELD_TYPE_FLOAT:
+        if (cbor_internal_check_type(token, CBOR_TOKEN_TYPE_FLOAT) == CBOR_FALSE)
+            return CBOR_FALSE;
+        if (size == sizeof(float))
+            *(float *)dest = (float)CBOR_GET_FLOAT(token);
+        else
+            *(double *)dest = CBOR_GET_FLOAT(token);
+        return CBOR_TRUE;
+    case CBOR_FIELD_TYPE_BOOLEAN:
+        if (cbor_internal_check_type(token, CBOR_TOKEN_TYPE_BOOLEAN) == CBOR_FALSE)
+            return CBOR_FALSE;
+        return cbor_internal_store_uint(dest, size, CBOR_GET_BOOLEAN(token));
+    default:
+        break;
+    }
+
+    return cbor_internal_set_error(token, "invalid field type");
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_encode_scalar(uint8_t **data, size_t size, cbor_field_type_t type, size_t value_size, const uint8_t *src)
+{
+    switch (type)
+    {
+    case CBOR_FIELD_TYPE_UINT:
+        return cbor_write_uint(data, size, cbor_internal_load_uint(src, value_size));
+    case CBOR_FIELD_TYPE_INT:
+        switch (value_size)
+        {
+        case 1: return cbor_write_int(data, size, *(const int8_t *)src);
+        case 2: return cbor_write_int(data, size, *(const int16_t *)src);
+        case 4: return cbor_write_int(data, size, *(const int32_t *)src);
+#ifdef CBOR_INT64_SUPPORT
+        case 8: return cbor_write_int(data, size, *(const int64_t *)src);
+#endif
+        }
+        break;
+    case CBOR_FIELD_TYPE_FLOAT:
+        if (value_size == sizeof(float))
+            return cbor_write_float(data, size, *(const float *)src);
+        return cbor_write_double(data, size, *(const double *)src);
+    case CBOR_FIELD_TYPE_BOOLEAN:
+        return cbor_write_boolean(data, size, cbor_internal_load_uint(src, value_size) != 0 ? CBOR_TRUE : CBOR_FALSE);
+    default:
+        break;
+    }
+
+    return CBOR_FALSE;
+}
+
+/* statistics of numeric values shared by aggregation and indexes */
+
+CBOR_INLINE void cbor_internal_add_value(cbor_stats_t *stats, double value)
+{
+    if (stats->count == 0 || value < stats->min)
+        stats->min = value;
+    if (stats->count == 0 || value > stats->max)
+        stats->max = value;
+
+    stats->sum += value;
+    ++stats->count;
+}
+
+CBOR_INLINE void cbor_internal_add_number(cbor_stats_t *stats, const cbor_token_data_t *token)
+{
+    switch (token->type)
+    {
+    case CBOR_TOKEN_TYPE_PINT:
+        cbor_internal_add_value(stats, (double)CBOR_GET_PINT(token));
+        break;
+    case CBOR_TOKEN_TYPE_NINT:
+        cbor_internal_add_value(stats, -(double)CBOR_GET_PINT(token) - 1.0);
+        break;
+    case CBOR_TOKEN_TYPE_FLOAT:
+        cbor_internal_add_value(stats, CBOR_GET_FLOAT(token));
+        break;
+    default:
+        break;
+    }
 }
 
 #endif
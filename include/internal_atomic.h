@@ -0,0 +1,176 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef INTERNAL_ATOMIC_H
+#define INTERNAL_ATOMIC_H
+
+/* acquire and release ordering on words shared between threads or processes */
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#else
+#include <time.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+
+/* x86 and x64 loads and stores are ordered, only the compiler is restricted */
+CBOR_INLINE size_t cbor_internal_load_acquire(const volatile size_t *value)
+{
+    size_t result = *value;
+    _ReadWriteBarrier();
+    return result;
+}
+
+CBOR_INLINE void cbor_internal_store_release(volatile size_t *value, size_t new_value)
+{
+    _ReadWriteBarrier();
+    *value = new_value;
+}
+
+CBOR_INLINE uint32_t cbor_internal_load_acquire_32(const volatile uint32_t *value)
+{
+    uint32_t result = *value;
+    _ReadWriteBarrier();
+    return result;
+}
+
+CBOR_INLINE void cbor_internal_store_release_32(volatile uint32_t *value, uint32_t new_value)
+{
+    _ReadWriteBarrier();
+    *value = new_value;
+}
+
+CBOR_INLINE uint32_t cbor_internal_add_32(volatile uint32_t *value, uint32_t delta)
+{
+    return (uint32_t)_InterlockedExchangeAdd((volatile long *)value, (long)delta) + delta;
+}
+
+CBOR_INLINE void cbor_internal_fence(void)
+{
+    MemoryBarrier();
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_compare_exchange(volatile size_t *value, size_t expected, size_t new_value)
+{
+#ifdef _WIN64
+    return _InterlockedCompareExchange64((volatile __int64 *)value, (__int64)new_value, (__int64)expected) == (__int64)expected ? CBOR_TRUE : CBOR_FALSE;
+#else
+    return _InterlockedCompareExchange((volatile long *)value, (long)new_value, (long)expected) == (long)expected ? CBOR_TRUE : CBOR_FALSE;
+#endif
+}
+#else
+CBOR_INLINE size_t cbor_internal_load_acquire(const volatile size_t *value)
+{
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+CBOR_INLINE void cbor_internal_store_release(volatile size_t *value, size_t new_value)
+{
+    __atomic_store_n(value, new_value, __ATOMIC_RELEASE);
+}
+
+CBOR_INLINE uint32_t cbor_internal_load_acquire_32(const volatile uint32_t *value)
+{
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+CBOR_INLINE void cbor_internal_store_release_32(volatile uint32_t *value, uint32_t new_value)
+{
+    __atomic_store_n(value, new_value, __ATOMIC_RELEASE);
+}
+
+CBOR_INLINE uint32_t cbor_internal_add_32(volatile uint32_t *value, uint32_t delta)
+{
+    return __atomic_add_fetch(value, delta, __ATOMIC_ACQ_REL);
+}
+
+CBOR_INLINE void cbor_internal_fence(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_compare_exchange(volatile size_t *value, size_t expected, size_t new_value)
+{
+    return __atomic_compare_exchange_n(value, &expected, new_value, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED) ? CBOR_TRUE : CBOR_FALSE;
+}
+#endif
+
+/* monotonic time for timeouts of waiting */
+CBOR_INLINE long cbor_internal_get_milliseconds(void)
+{
+#ifdef _WIN32
+    return (long)GetTickCount();
+#else
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (long)time.tv_sec * 1000 + (long)(time.tv_nsec / 1000000);
+#endif
+}
+
+/* waits while the word has the expected value, until it's woken or for timeout milliseconds if it isn't negative;
+   words may be shared between processes, other systems than Linux check them periodically */
+
+#if defined(__linux__)
+CBOR_INLINE void cbor_internal_wait_32(volatile uint32_t *value, uint32_t expected, long timeout)
+{
+    struct timespec time;
+
+    time.tv_sec = timeout / 1000;
+    time.tv_nsec = (timeout % 1000) * 1000000;
+    syscall(__NR_futex, value, FUTEX_WAIT, expected, timeout < 0 ? NULL : &time, NULL, 0);
+}
+
+CBOR_INLINE void cbor_internal_wake_32(volatile uint32_t *value, int count)
+{
+    syscall(__NR_futex, value, FUTEX_WAKE, count, NULL, NULL, 0);
+}
+#else
+CBOR_INLINE void cbor_internal_wait_32(volatile uint32_t *value, uint32_t expected, long timeout)
+{
+#ifdef _WIN32
+    if (cbor_internal_load_acquire_32(value) == expected)
+        Sleep(timeout >= 0 && timeout < 1 ? 0 : 1);
+#else
+    struct timespec time;
+
+    time.tv_sec = 0;
+    time.tv_nsec = timeout >= 0 && timeout < 1 ? 0 : 1000000;
+    if (cbor_internal_load_acquire_32(value) == expected)
+        nanosleep(&time, NULL);
+#endif
+}
+
+CBOR_INLINE void cbor_internal_wake_32(volatile uint32_t *value, int count)
+{
+    (void)value; (void)count;
+}
+#endif
+
+#endif
@@ -0,0 +1,221 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef INTERNAL_IO_H
+#define INTERNAL_IO_H
+
+#ifdef _WIN32
+#include <io.h>
+#include <stdio.h>
+#else
+#include <errno.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#endif
+
+#define CBOR_INTERNAL_UNSUPPORTED (-2)
+#define CBOR_INTERNAL_AGAIN (-3)
+
+/* positioned I/O on file descriptors, partial transfers and interrupted calls are retried */
+
+#ifdef _WIN32
+CBOR_INLINE cbor_bool_t cbor_internal_write_at(int fd, const uint8_t *data, size_t size, cbor_base_uint_t offset)
+{
+    if (_lseeki64(fd, (__int64)offset, SEEK_SET) < 0)
+        return CBOR_FALSE;
+
+    while (size > 0)
+    {
+        int written = _write(fd, data, (unsigned int)(size < 0x40000000 ? size : 0x40000000));
+        if (written <= 0)
+            return CBOR_FALSE;
+
+        data += written;
+        size -= (size_t)written;
+    }
+
+    return CBOR_TRUE;
+}
+
+CBOR_INLINE long cbor_internal_read_at(int fd, uint8_t *data, size_t size, cbor_base_uint_t offset)
+{
+    long total = 0;
+
+    if (_lseeki64(fd, (__int64)offset, SEEK_SET) < 0)
+        return -1;
+
+    while (size > 0)
+    {
+        int count = _read(fd, data, (unsigned int)(size < 0x40000000 ? size : 0x40000000));
+        if (count < 0)
+            return -1;
+        if (count == 0)
+            break;
+
+        data += count;
+        size -= (size_t)count;
+        total += count;
+    }
+
+    return total;
+}
+
+CBOR_INLINE long cbor_internal_read(int fd, uint8_t *data, size_t size)
+{
+    return _read(fd, data, (unsigned int)(size < 0x40000000 ? size : 0x40000000));
+}
+
+CBOR_INLINE long cbor_internal_write(int fd, const uint8_t *data, size_t size)
+{
+    return _write(fd, data, (unsigned int)(size < 0x40000000 ? size : 0x40000000));
+}
+
+CBOR_INLINE long cbor_internal_send_file(int out_fd, int in_fd, cbor_base_uint_t offset, size_t size)
+{
+    (void)out_fd; (void)in_fd; (void)offset; (void)size;
+    return CBOR_INTERNAL_UNSUPPORTED;
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_sync(int fd)
+{
+    return _commit(fd) == 0 ? CBOR_TRUE : CBOR_FALSE;
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_truncate(int fd, cbor_base_uint_t size)
+{
+    return _chsize_s(fd, (__int64)size) == 0 ? CBOR_TRUE : CBOR_FALSE;
+}
+#else
+CBOR_INLINE cbor_bool_t cbor_internal_write_at(int fd, const uint8_t *data, size_t size, cbor_base_uint_t offset)
+{
+    while (size > 0)
+    {
+        ssize_t written = pwrite(fd, data, size, (off_t)offset);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return CBOR_FALSE;
+
+        data += written;
+        size -= (size_t)written;
+        offset += (cbor_base_uint_t)written;
+    }
+
+    return CBOR_TRUE;
+}
+
+CBOR_INLINE long cbor_internal_read_at(int fd, uint8_t *data, size_t size, cbor_base_uint_t offset)
+{
+    long total = 0;
+
+    while (size > 0)
+    {
+        ssize_t count = pread(fd, data, size, (off_t)offset);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0)
+            return -1;
+        if (count == 0)
+            break;
+
+        data += count;
+        size -= (size_t)count;
+        offset += (cbor_base_uint_t)count;
+        total += (long)count;
+    }
+
+    return total;
+}
+
+/* CBOR_INTERNAL_AGAIN if the call would block on a non-blocking descriptor */
+CBOR_INLINE long cbor_internal_read(int fd, uint8_t *data, size_t size)
+{
+    ssize_t count;
+
+    do
+        count = read(fd, data, size);
+    while (count < 0 && errno == EINTR);
+
+    if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return CBOR_INTERNAL_AGAIN;
+
+    return (long)count;
+}
+
+/* zero if the call would block on a non-blocking descriptor */
+CBOR_INLINE long cbor_internal_write(int fd, const uint8_t *data, size_t size)
+{
+    ssize_t count;
+
+    do
+        count = write(fd, data, size);
+    while (count < 0 && errno == EINTR);
+
+    if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return 0;
+
+    return (long)count;
+}
+
+/* copies file data in the kernel, zero if the call would block */
+CBOR_INLINE long cbor_internal_send_file(int out_fd, int in_fd, cbor_base_uint_t offset, size_t size)
+{
+#ifdef __linux__
+    off_t file_offset = (off_t)offset;
+    ssize_t count;
+
+    do
+        count = sendfile(out_fd, in_fd, &file_offset, size);
+    while (count < 0 && errno == EINTR);
+
+    if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return 0;
+    if (count < 0 && (errno == EINVAL || errno == ENOSYS))
+        return CBOR_INTERNAL_UNSUPPORTED; /* descriptors sendfile can't be used with */
+    if (count == 0)
+        return -1; /* end of file */
+
+    return (long)count;
+#else
+    (void)out_fd; (void)in_fd; (void)offset; (void)size;
+    return CBOR_INTERNAL_UNSUPPORTED; /* sendfile of other systems is limited to sockets */
+#endif
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_sync(int fd)
+{
+#ifdef __APPLE__
+    return fsync(fd) == 0 ? CBOR_TRUE : CBOR_FALSE;
+#else
+    return fdatasync(fd) == 0 ? CBOR_TRUE : CBOR_FALSE; /* metadata isn't needed to read data back */
+#endif
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_truncate(int fd, cbor_base_uint_t size)
+{
+    return ftruncate(fd, (off_t)size) == 0 ? CBOR_TRUE : CBOR_FALSE;
+}
+#endif
+
+#endif
@@ -0,0 +1,70 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef INTERNAL_THREAD_H
+#define INTERNAL_THREAD_H
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#ifndef CBOR_MAX_THREADS
+#define CBOR_MAX_THREADS 64
+#endif
+
+#ifdef _WIN32
+typedef HANDLE cbor_internal_thread_t;
+#define CBOR_THREAD_PROC(name, arg) static DWORD WINAPI name(LPVOID arg)
+#define CBOR_THREAD_RETURN return 0
+#else
+typedef pthread_t cbor_internal_thread_t;
+#define CBOR_THREAD_PROC(name, arg) static void *name(void *arg)
+#define CBOR_THREAD_RETURN return NULL
+#endif
+
+#ifdef _WIN32
+CBOR_INLINE cbor_bool_t cbor_internal_start_thread(cbor_internal_thread_t *thread, LPTHREAD_START_ROUTINE proc, void *arg)
+{
+    *thread = CreateThread(NULL, 0, proc, arg, 0, NULL);
+    return *thread != NULL ? CBOR_TRUE : CBOR_FALSE;
+}
+
+CBOR_INLINE void cbor_internal_join_thread(cbor_internal_thread_t thread)
+{
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+#else
+CBOR_INLINE cbor_bool_t cbor_internal_start_thread(cbor_internal_thread_t *thread, void *(*proc)(void *), void *arg)
+{
+    return pthread_create(thread, NULL, proc, arg) == 0 ? CBOR_TRUE : CBOR_FALSE;
+}
+
+CBOR_INLINE void cbor_internal_join_thread(cbor_internal_thread_t thread)
+{
+    pthread_join(thread, NULL);
+}
+#endif
+
+#endif
@@ -0,0 +1,195 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef INTERNAL_URING_H
+#define INTERNAL_URING_H
+
+/* io_uring through raw system calls, the ring is used by one thread */
+
+#if defined(CBOR_IO_URING_SUPPORT) && defined(__linux__)
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#define CBOR_URING_FIELD(ring, offset) ((unsigned int *)((uint8_t *)(ring) + (offset)))
+
+CBOR_INLINE cbor_bool_t cbor_internal_setup_uring(cbor_uring_t *uring, unsigned int entries)
+{
+    struct io_uring_params params;
+
+    memset(uring, 0, sizeof(*uring));
+    memset(&params, 0, sizeof(params));
+
+    uring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (uring->fd < 0)
+    {
+        uring->fd = -1;
+        return CBOR_FALSE;
+    }
+
+    uring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    uring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    /* both rings are mapped at once by newer kernels */
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (uring->cq_ring_size > uring->sq_ring_size)
+            uring->sq_ring_size = uring->cq_ring_size;
+        uring->cq_ring_size = 0;
+    }
+
+    uring->sq_ring = mmap(NULL, uring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, uring->fd, IORING_OFF_SQ_RING);
+    uring->cq_ring = uring->sq_ring;
+    if (uring->cq_ring_size != 0 && uring->sq_ring != MAP_FAILED)
+        uring->cq_ring = mmap(NULL, uring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, uring->fd, IORING_OFF_CQ_RING);
+    uring->sqes = mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED, uring->fd, IORING_OFF_SQES);
+
+    if (uring->sq_ring == MAP_FAILED || uring->cq_ring == MAP_FAILED || uring->sqes == MAP_FAILED)
+    {
+        if (uring->sq_ring != MAP_FAILED)
+            munmap(uring->sq_ring, uring->sq_ring_size);
+        if (uring->cq_ring_size != 0 && uring->cq_ring != MAP_FAILED && uring->sq_ring != MAP_FAILED)
+            munmap(uring->cq_ring, uring->cq_ring_size);
+        if (uring->sqes != MAP_FAILED)
+            munmap(uring->sqes, uring->sqes_size);
+
+        close(uring->fd);
+        uring->fd = -1;
+        return CBOR_FALSE;
+    }
+
+    uring->sq_head = params.sq_off.head;
+    uring->sq_tail = params.sq_off.tail;
+    uring->sq_mask = params.sq_off.ring_mask;
+    uring->sq_array = params.sq_off.array;
+    uring->cq_head = params.cq_off.head;
+    uring->cq_tail = params.cq_off.tail;
+    uring->cq_mask = params.cq_off.ring_mask;
+    uring->cqes = params.cq_off.cqes;
+    return CBOR_TRUE;
+}
+
+CBOR_INLINE void cbor_internal_close_uring(cbor_uring_t *uring)
+{
+    if (uring->fd < 0)
+        return;
+
+    munmap(uring->sqes, uring->sqes_size);
+    if (uring->cq_ring_size != 0)
+        munmap(uring->cq_ring, uring->cq_ring_size);
+    munmap(uring->sq_ring, uring->sq_ring_size);
+    close(uring->fd);
+    uring->fd = -1;
+}
+
+/* queues a read or write and enters the kernel, FALSE if it can't be submitted */
+CBOR_INLINE cbor_bool_t cbor_internal_submit_uring(cbor_uring_t *uring, cbor_bool_t write, int fd, uint8_t *data, size_t size,
+                                                   cbor_base_uint_t offset, size_t user_data)
+{
+    unsigned int head = __atomic_load_n(CBOR_URING_FIELD(uring->sq_ring, uring->sq_head), __ATOMIC_ACQUIRE);
+    unsigned int tail = *CBOR_URING_FIELD(uring->sq_ring, uring->sq_tail);
+    unsigned int mask = *CBOR_URING_FIELD(uring->sq_ring, uring->sq_mask);
+    unsigned int index = tail & mask;
+    struct io_uring_sqe *sqe = (struct io_uring_sqe *)uring->sqes + index;
+    long result;
+
+    if (tail - head > mask)
+        return CBOR_FALSE; /* the submission queue is full */
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)data;
+    sqe->len = (uint32_t)size;
+    sqe->off = (uint64_t)offset;
+    sqe->user_data = (uint64_t)user_data;
+
+    CBOR_URING_FIELD(uring->sq_ring, uring->sq_array)[index] = index;
+    __atomic_store_n(CBOR_URING_FIELD(uring->sq_ring, uring->sq_tail), tail + 1, __ATOMIC_RELEASE);
+
+    do
+        result = syscall(__NR_io_uring_enter, uring->fd, 1, 0, 0, NULL, 0);
+    while (result < 0 && errno == EINTR);
+
+    if (result == 1)
+        return CBOR_TRUE;
+
+    /* the entry wasn't consumed, the kernel reads the tail only when entered */
+    __atomic_store_n(CBOR_URING_FIELD(uring->sq_ring, uring->sq_tail), tail, __ATOMIC_RELEASE);
+    return CBOR_FALSE;
+}
+
+/* takes the next completion, waits for it if needed */
+CBOR_INLINE cbor_bool_t cbor_internal_complete_uring(cbor_uring_t *uring, size_t *user_data, long *result)
+{
+    for (;;)
+    {
+        unsigned int head = *CBOR_URING_FIELD(uring->cq_ring, uring->cq_head);
+        unsigned int tail = __atomic_load_n(CBOR_URING_FIELD(uring->cq_ring, uring->cq_tail), __ATOMIC_ACQUIRE);
+
+        if (head != tail)
+        {
+            unsigned int mask = *CBOR_URING_FIELD(uring->cq_ring, uring->cq_mask);
+            const struct io_uring_cqe *cqe = (const struct io_uring_cqe *)((uint8_t *)uring->cq_ring + uring->cqes) + (head & mask);
+
+            *user_data = (size_t)cqe->user_data;
+            *result = (long)cqe->res;
+            __atomic_store_n(CBOR_URING_FIELD(uring->cq_ring, uring->cq_head), head + 1, __ATOMIC_RELEASE);
+            return CBOR_TRUE;
+        }
+
+        if (syscall(__NR_io_uring_enter, uring->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR)
+            return CBOR_FALSE;
+    }
+}
+#else
+CBOR_INLINE cbor_bool_t cbor_internal_setup_uring(cbor_uring_t *uring, unsigned int entries)
+{
+    (void)entries;
+    memset(uring, 0, sizeof(*uring));
+    uring->fd = -1;
+    return CBOR_FALSE;
+}
+
+CBOR_INLINE void cbor_internal_close_uring(cbor_uring_t *uring)
+{
+    (void)uring;
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_submit_uring(cbor_uring_t *uring, cbor_bool_t write, int fd, uint8_t *data, size_t size,
+                                                   cbor_base_uint_t offset, size_t user_data)
+{
+    (void)uring; (void)write; (void)fd; (void)data; (void)size; (void)offset; (void)user_data;
+    return CBOR_FALSE;
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_complete_uring(cbor_uring_t *uring, size_t *user_data, long *result)
+{
+    (void)uring; (void)user_data; (void)result;
+    return CBOR_FALSE;
+}
+#endif
+
+#endif
@@ -13,6 +13,11 @@ newoption {
     description = 'Disable 64 bits integers support (enabled by default)'
 }
 
+newoption {
+    trigger     = 'use-io-uring',
+    description = 'Use io_uring for bulk I/O on Linux (disabled by default)'
+}
+
 solution "cborphine"
     configurations { "Debug", "Release" }
     platforms { "x64", "x32" }
@@ -29,6 +34,10 @@ solution "cborphine"
         defines { "CBOR_INT64_SUPPORT" }
     end
 
+    if _OPTIONS['use-io-uring'] then
+        defines { "CBOR_IO_URING_SUPPORT" }
+    end
+
 project "cborphine"
     kind "StaticLib"
     language "C++"
@@ -52,6 +61,7 @@ project "cborphine"
 project "cborphine-tests"
     kind "ConsoleApp"
     language "C++"
+    cppdialect "C++17"
     targetdir "bin/%{cfg.platform}/%{cfg.buildcfg}"
        	
     includedirs {
@@ -59,7 +69,7 @@ project "cborphine-tests"
         "./test/"
     }
 	
-    removefiles { "./include/internal.h" }
+    removefiles { "./include/internal.h", "./include/internal_thread.h", "./include/internal_io.h", "./include/internal_uring.h", "./include/internal_atomic.h" }
 
     files {
         "**.h",
@@ -69,6 +79,9 @@ project "cborphine-tests"
 
     links { "cborphine" }
 
+    filter "system:not windows"
+        links { "pthread" }
+
     filter "configurations:Debug"
         defines { "DEBUG" }
         flags { "Symbols" }
@@ -84,7 +97,10 @@ project "cborphine-example"
     includedirs { "./include" }
     links { "cborphine" }
     files { "include/**.h", "example/**.c" }
-    removefiles { "./include/internal.h" }
+    removefiles { "./include/internal.h", "./include/internal_thread.h", "./include/internal_io.h", "./include/internal_uring.h", "./include/internal_atomic.h" }
+
+    filter "system:not windows"
+        links { "pthread" }
 
     filter "configurations:Debug"
         defines { "_DEBUG" }
@@ -93,3 +109,41 @@ project "cborphine-example"
     filter "configurations:Release"
         defines { "NDEBUG" }
         optimize "On"		
+
+project "cborphine-index"
+    kind "ConsoleApp"
+    language "C"
+    targetdir "bin/%{cfg.platform}/%{cfg.buildcfg}"
+    includedirs { "./include" }
+    links { "cborphine" }
+    files { "include/**.h", "tools/index.c" }
+    removefiles { "./include/internal.h", "./include/internal_thread.h", "./include/internal_io.h", "./include/internal_uring.h", "./include/internal_atomic.h" }
+
+    filter "configurations:Debug"
+        defines { "_DEBUG" }
+        flags { "Symbols" }
+
+    filter "configurations:Release"
+        defines { "NDEBUG" }
+        optimize "On"
+
+project "cborphine-ringbench"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++11"
+    targetdir "bin/%{cfg.platform}/%{cfg.buildcfg}"
+    includedirs { "./include" }
+    links { "cborphine" }
+    files { "include/**.h", "tools/ringbench.cpp" }
+    removefiles { "./include/internal.h", "./include/internal_thread.h", "./include/internal_io.h", "./include/internal_uring.h", "./include/internal_atomic.h" }
+
+    filter "system:not windows"
+        links { "pthread" }
+
+    filter "configurations:Debug"
+        defines { "_DEBUG" }
+        flags { "Symbols" }
+
+    filter "configurations:Release"
+        defines { "NDEBUG" }
+        optimize "On"
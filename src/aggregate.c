@@ -0,0 +1,218 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <string.h>
+#include "cbor.h"
+#include "internal.h"
+#include "internal_thread.h"
+
+typedef struct
+{
+    const uint8_t *data;
+    size_t data_size;
+    const char *key;
+    size_t key_length;
+    cbor_stats_t stats;
+    cbor_bool_t result;
+} cbor_internal_aggregation_t;
+
+CBOR_INLINE void cbor_internal_merge_stats(cbor_stats_t *stats, const cbor_stats_t *other)
+{
+    if (other->count == 0)
+        return;
+
+    if (stats->count == 0 || other->min < stats->min)
+        stats->min = other->min;
+    if (stats->count == 0 || other->max > stats->max)
+        stats->max = other->max;
+
+    stats->sum += other->sum;
+    stats->count += other->count;
+}
+
+/* only the value of the field is materialized, everything else is skipped */
+static cbor_bool_t cbor_internal_aggregate(cbor_internal_aggregation_t *aggregation)
+{
+    cbor_token_data_t token;
+
+    cbor_internal_init_token(&token, aggregation->data, aggregation->data + aggregation->data_size);
+
+    while (cbor_internal_read_next(&token))
+    {
+        cbor_base_uint_t items_count;
+        cbor_base_uint_t i;
+        cbor_bool_t found = CBOR_FALSE;
+
+        if (token.type != CBOR_TOKEN_TYPE_MAP)
+        {
+            if (cbor_internal_skip_nested(&token) == CBOR_FALSE)
+                return CBOR_FALSE;
+            continue;
+        }
+
+        items_count = CBOR_GET_MAP(&token);
+        for (i = 0; i < items_count; ++i)
+        {
+            cbor_bool_t matched = CBOR_FALSE;
+
+            if (cbor_internal_read_nested(&token) == CBOR_FALSE)
+                return CBOR_FALSE;
+
+            if (found == CBOR_FALSE && token.type == CBOR_TOKEN_TYPE_STRING &&
+                CBOR_GET_STRING_LENGTH(&token) == aggregation->key_length &&
+                memcmp(CBOR_GET_STRING(&token), aggregation->key, aggregation->key_length) == 0)
+                matched = CBOR_TRUE;
+            else if (cbor_internal_skip_nested(&token) == CBOR_FALSE)
+                return CBOR_FALSE;
+
+            if (cbor_internal_read_nested(&token) == CBOR_FALSE)
+                return CBOR_FALSE;
+
+            if (matched)
+            {
+                found = CBOR_TRUE;
+
+                cbor_internal_add_number(&aggregation->stats, &token); /* values of other types are ignored */
+            }
+
+            if (cbor_internal_skip_nested(&token) == CBOR_FALSE)
+                return CBOR_FALSE;
+        }
+    }
+
+    return token.type == CBOR_TOKEN_TYPE_END ? CBOR_TRUE : CBOR_FALSE;
+}
+
+CBOR_THREAD_PROC(cbor_internal_aggregate_proc, arg)
+{
+    cbor_internal_aggregation_t *aggregation = (cbor_internal_aggregation_t *)arg;
+    aggregation->result = cbor_internal_aggregate(aggregation);
+    CBOR_THREAD_RETURN;
+}
+
+cbor_bool_t cbor_aggregate_field(const uint8_t *data, size_t data_size, const char *key, cbor_stats_t *stats)
+{
+    cbor_internal_aggregation_t aggregation;
+
+    memset(&aggregation, 0, sizeof(aggregation));
+    aggregation.data = data;
+    aggregation.data_size = data_size;
+    aggregation.key = key;
+    aggregation.key_length = strlen(key);
+
+    if (cbor_internal_aggregate(&aggregation) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    *stats = aggregation.stats;
+    return CBOR_TRUE;
+}
+
+/* finds the end of a top-level item, payloads are skipped by their headers, returns NULL for malformed or truncated items */
+static const uint8_t *cbor_internal_skip_item(const uint8_t *pos, const uint8_t *end)
+{
+    cbor_token_data_t token;
+
+    cbor_internal_init_token(&token, pos, end);
+
+    if (cbor_internal_read_nested(&token) == CBOR_FALSE || cbor_internal_skip_nested(&token) == CBOR_FALSE)
+        return NULL;
+
+    return token.pos;
+}
+
+cbor_bool_t cbor_aggregate_field_parallel(const uint8_t *data, size_t data_size, const char *key, cbor_stats_t *stats, unsigned int threads_count)
+{
+    cbor_internal_aggregation_t aggregations[CBOR_MAX_THREADS];
+    cbor_internal_thread_t threads[CBOR_MAX_THREADS];
+    cbor_bool_t started[CBOR_MAX_THREADS];
+    const uint8_t *data_end = data + data_size;
+    const uint8_t *chunk_start = data;
+    const uint8_t *chunk_end = data;
+    unsigned int chunks_count = 0;
+    unsigned int i;
+
+    if (threads_count > CBOR_MAX_THREADS)
+        threads_count = CBOR_MAX_THREADS;
+    if (threads_count <= 1)
+        return cbor_aggregate_field(data, data_size, key, stats);
+
+    /* sequence is split by top-level items into chunks of similar sizes, each chunk is started as soon as
+       its end is found, the last one is processed by the calling thread */
+    for (;;)
+    {
+        memset(&aggregations[chunks_count], 0, sizeof(aggregations[chunks_count]));
+        aggregations[chunks_count].key = key;
+        aggregations[chunks_count].key_length = strlen(key);
+
+        if (chunks_count + 1 < threads_count)
+        {
+            const uint8_t *split_pos = data + data_size / threads_count * (chunks_count + 1);
+
+            while (chunk_end < split_pos)
+            {
+                chunk_end = cbor_internal_skip_item(chunk_end, data_end);
+
+                /* malformed data is left to the aggregation of the last chunk to report */
+                if (chunk_end == NULL)
+                {
+                    chunk_end = data_end;
+                    break;
+                }
+            }
+        }
+        else
+            chunk_end = data_end;
+
+        aggregations[chunks_count].data = chunk_start;
+        aggregations[chunks_count].data_size = (size_t)(chunk_end - chunk_start);
+        ++chunks_count;
+
+        if (chunk_end == data_end)
+            break;
+
+        started[chunks_count - 1] = cbor_internal_start_thread(&threads[chunks_count - 1], cbor_internal_aggregate_proc,
+                                                               &aggregations[chunks_count - 1]);
+        chunk_start = chunk_end;
+    }
+
+    aggregations[chunks_count - 1].result = cbor_internal_aggregate(&aggregations[chunks_count - 1]);
+
+    for (i = 0; i + 1 < chunks_count; ++i)
+    {
+        if (started[i])
+            cbor_internal_join_thread(threads[i]);
+        else
+            aggregations[i].result = cbor_internal_aggregate(&aggregations[i]);
+    }
+
+    for (i = 0; i < chunks_count; ++i)
+    {
+        if (aggregations[i].result == CBOR_FALSE)
+            return CBOR_FALSE; /* stats are left untouched like in cbor_aggregate_field */
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    for (i = 0; i < chunks_count; ++i)
+        cbor_internal_merge_stats(stats, &aggregations[i].stats);
+
+    return CBOR_TRUE;
+}
@@ -0,0 +1,297 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#if defined(__linux__)
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* pread, pwrite and syscall */
+#endif
+#elif !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L /* pread and pwrite */
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include "cbor.h"
+#include "internal.h"
+#include "internal_io.h"
+#include "internal_uring.h"
+
+/* transfers the rest of the block synchronously, used without io_uring and when it fails */
+static void cbor_internal_transfer_block(cbor_bulk_t *bulk, cbor_bool_t write, size_t index)
+{
+    size_t done = bulk->results[index] > 0 ? (size_t)bulk->results[index] : 0;
+    uint8_t *block = bulk->buffer + index * bulk->block_size + done;
+    size_t size = bulk->sizes[index] - done;
+    cbor_base_uint_t offset = bulk->offsets[index] + done;
+    long count;
+
+    if (write)
+        bulk->results[index] = cbor_internal_write_at(bulk->fd, block, size, offset) ? (long)bulk->sizes[index] : -1;
+    else
+    {
+        count = cbor_internal_read_at(bulk->fd, block, size, offset);
+        bulk->results[index] = count < 0 ? -1 : (long)done + count;
+    }
+
+    bulk->completed[index] = CBOR_TRUE;
+}
+
+static void cbor_internal_submit_block(cbor_bulk_t *bulk, cbor_bool_t write, size_t index, size_t size)
+{
+    bulk->offsets[index] = bulk->offset;
+    bulk->sizes[index] = size;
+    bulk->results[index] = 0;
+    bulk->completed[index] = CBOR_FALSE;
+    bulk->offset += size;
+
+    if (bulk->uring.fd < 0 ||
+        cbor_internal_submit_uring(&bulk->uring, write, bulk->fd, bulk->buffer + index * bulk->block_size, size,
+                                   bulk->offsets[index], index) == CBOR_FALSE)
+        cbor_internal_transfer_block(bulk, write, index);
+}
+
+/* partial transfers are resubmitted, a block is short only if a read returned nothing at the end of file */
+static void cbor_internal_complete_block(cbor_bulk_t *bulk, cbor_bool_t write, size_t index, long result)
+{
+    size_t done;
+
+    /* operations unsupported by the kernel and writes without progress are done synchronously */
+    if (result == -EINVAL || (write && result == 0))
+    {
+        cbor_internal_transfer_block(bulk, write, index);
+        return;
+    }
+
+    if (result < 0)
+    {
+        bulk->results[index] = result;
+        bulk->completed[index] = CBOR_TRUE;
+        return;
+    }
+
+    bulk->results[index] += result;
+    done = (size_t)bulk->results[index];
+
+    if (result == 0 || done == bulk->sizes[index])
+        bulk->completed[index] = CBOR_TRUE;
+    else if (cbor_internal_submit_uring(&bulk->uring, write, bulk->fd, bulk->buffer + index * bulk->block_size + done,
+                                        bulk->sizes[index] - done, bulk->offsets[index] + done, index) == CBOR_FALSE)
+        cbor_internal_transfer_block(bulk, write, index);
+}
+
+static void cbor_internal_wait_block(cbor_bulk_t *bulk, cbor_bool_t write, size_t index)
+{
+    size_t completed;
+    long result;
+
+    while (bulk->completed[index] == CBOR_FALSE)
+    {
+        if (cbor_internal_complete_uring(&bulk->uring, &completed, &result) == CBOR_FALSE)
+        {
+            cbor_internal_transfer_block(bulk, write, index);
+            break;
+        }
+
+        cbor_internal_complete_block(bulk, write, completed, result);
+    }
+}
+
+static cbor_bool_t cbor_internal_init_bulk(cbor_bulk_t *bulk, int fd, cbor_base_uint_t offset, uint8_t *buffer, size_t block_size,
+                                           size_t blocks_count)
+{
+    size_t i;
+
+    if (block_size == 0 || blocks_count == 0 || blocks_count > CBOR_BULK_MAX_BLOCKS)
+        return CBOR_FALSE;
+
+    bulk->fd = fd;
+    bulk->buffer = buffer;
+    bulk->block_size = block_size;
+    bulk->blocks_count = blocks_count;
+    bulk->pos = buffer;
+    bulk->end = buffer + block_size;
+    bulk->head = 0;
+    bulk->in_flight = 0;
+    bulk->consumed = 0;
+    bulk->offset = offset;
+    bulk->eof = CBOR_FALSE;
+    bulk->failed = CBOR_FALSE;
+
+    for (i = 0; i < blocks_count; ++i)
+        bulk->completed[i] = CBOR_TRUE;
+
+    cbor_internal_setup_uring(&bulk->uring, (unsigned int)blocks_count);
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_init_bulk_reader(cbor_bulk_t *bulk, int fd, cbor_base_uint_t offset, uint8_t *buffer, size_t block_size, size_t blocks_count)
+{
+    size_t i;
+
+    if (cbor_internal_init_bulk(bulk, fd, offset, buffer, block_size, blocks_count) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    /* reads ahead into all blocks */
+    for (i = 0; i < blocks_count; ++i)
+        cbor_internal_submit_block(bulk, CBOR_FALSE, i, block_size);
+
+    bulk->in_flight = blocks_count;
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_bulk_read(cbor_bulk_t *bulk, const uint8_t **block, size_t *block_size)
+{
+    long result;
+
+    *block = bulk->buffer + bulk->head * bulk->block_size;
+    *block_size = 0;
+
+    if (bulk->failed)
+        return CBOR_FALSE;
+
+    if (bulk->in_flight == 0)
+        return CBOR_TRUE;
+
+    cbor_internal_wait_block(bulk, CBOR_FALSE, bulk->head);
+    result = bulk->results[bulk->head];
+
+    if (result < 0)
+    {
+        bulk->failed = CBOR_TRUE;
+        return CBOR_FALSE;
+    }
+
+    /* blocks are short only at the end of file, reads ahead past it return nothing */
+    if ((size_t)result < bulk->block_size)
+        bulk->eof = CBOR_TRUE;
+
+    *block_size = (size_t)result;
+    return CBOR_TRUE;
+}
+
+void cbor_bulk_release(cbor_bulk_t *bulk)
+{
+    if (bulk->in_flight == 0)
+        return;
+
+    if (bulk->eof)
+        --bulk->in_flight;
+    else
+        cbor_internal_submit_block(bulk, CBOR_FALSE, bulk->head, bulk->block_size);
+
+    bulk->head = (bulk->head + 1) % bulk->blocks_count;
+    bulk->consumed = 0;
+}
+
+size_t cbor_refill_bulk(void *ctx, uint8_t *data, size_t size)
+{
+    cbor_bulk_t *bulk = (cbor_bulk_t *)ctx;
+    const uint8_t *block;
+    size_t block_size;
+
+    for (;;)
+    {
+        if (cbor_bulk_read(bulk, &block, &block_size) == CBOR_FALSE)
+            return CBOR_REFILL_ERROR;
+
+        if (block_size == 0)
+            return 0;
+
+        if (bulk->consumed < block_size)
+        {
+            if (size > block_size - bulk->consumed)
+                size = block_size - bulk->consumed;
+
+            memcpy(data, block + bulk->consumed, size);
+            bulk->consumed += size;
+            return size;
+        }
+
+        cbor_bulk_release(bulk);
+    }
+}
+
+cbor_bool_t cbor_init_bulk_writer(cbor_bulk_t *bulk, int fd, cbor_base_uint_t offset, uint8_t *buffer, size_t block_size, size_t blocks_count)
+{
+    return cbor_internal_init_bulk(bulk, fd, offset, buffer, block_size, blocks_count);
+}
+
+cbor_bool_t cbor_bulk_submit(cbor_bulk_t *bulk)
+{
+    uint8_t *block = bulk->buffer + bulk->head * bulk->block_size;
+    size_t oldest;
+
+    if (bulk->pos == block)
+        return bulk->failed ? CBOR_FALSE : CBOR_TRUE;
+
+    cbor_internal_submit_block(bulk, CBOR_TRUE, bulk->head, (size_t)(bulk->pos - block));
+    bulk->head = (bulk->head + 1) % bulk->blocks_count;
+    ++bulk->in_flight;
+
+    /* the next block is reused when its write is complete */
+    if (bulk->in_flight == bulk->blocks_count)
+    {
+        oldest = bulk->head;
+        cbor_internal_wait_block(bulk, CBOR_TRUE, oldest);
+        if (bulk->results[oldest] < 0)
+            bulk->failed = CBOR_TRUE;
+        --bulk->in_flight;
+    }
+
+    bulk->pos = bulk->buffer + bulk->head * bulk->block_size;
+    bulk->end = bulk->pos + bulk->block_size;
+    return bulk->failed ? CBOR_FALSE : CBOR_TRUE;
+}
+
+cbor_bool_t cbor_bulk_finish(cbor_bulk_t *bulk)
+{
+    size_t oldest;
+
+    cbor_bulk_submit(bulk);
+
+    while (bulk->in_flight > 0)
+    {
+        oldest = (bulk->head + bulk->blocks_count - bulk->in_flight) % bulk->blocks_count;
+        cbor_internal_wait_block(bulk, CBOR_TRUE, oldest);
+        if (bulk->results[oldest] < 0)
+            bulk->failed = CBOR_TRUE;
+        --bulk->in_flight;
+    }
+
+    return bulk->failed ? CBOR_FALSE : CBOR_TRUE;
+}
+
+void cbor_close_bulk(cbor_bulk_t *bulk)
+{
+    size_t i;
+    size_t completed;
+    long result;
+
+    /* buffers can't be released while the kernel uses them */
+    for (i = 0; i < bulk->blocks_count; ++i)
+    {
+        while (bulk->completed[i] == CBOR_FALSE && cbor_internal_complete_uring(&bulk->uring, &completed, &result))
+            bulk->completed[completed] = CBOR_TRUE;
+    }
+
+    cbor_internal_close_uring(&bulk->uring);
+}
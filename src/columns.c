@@ -0,0 +1,257 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <string.h>
+#include "cbor.h"
+#include "internal.h"
+
+CBOR_INLINE cbor_bool_t cbor_internal_is_variable_column(const cbor_column_t *column)
+{
+    return (column->type == CBOR_FIELD_TYPE_STRING || column->type == CBOR_FIELD_TYPE_BYTES) ? CBOR_TRUE : CBOR_FALSE;
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_is_valid(const cbor_column_t *column, size_t row)
+{
+    if (column->validity == NULL)
+        return CBOR_TRUE;
+
+    return (column->validity[row / 8] & (1 << (row % 8))) != 0 ? CBOR_TRUE : CBOR_FALSE;
+}
+
+CBOR_INLINE void cbor_internal_set_valid(cbor_column_t *column, size_t row, cbor_bool_t valid)
+{
+    if (column->validity == NULL)
+        return;
+
+    if (valid)
+        column->validity[row / 8] |= (uint8_t)(1 << (row % 8));
+    else
+        column->validity[row / 8] &= (uint8_t)~(1 << (row % 8));
+}
+
+CBOR_INLINE void cbor_internal_clear_row(cbor_column_t *column, size_t row)
+{
+    if (cbor_internal_is_variable_column(column))
+    {
+        uint32_t *offsets = (uint32_t *)column->values;
+        offsets[row + 1] = offsets[row];
+    }
+    else
+        memset((uint8_t *)column->values + row * column->size, 0, column->size);
+
+    cbor_internal_set_valid(column, row, CBOR_FALSE);
+}
+
+/* values are never read or written past their size, checked once before any row */
+CBOR_INLINE cbor_bool_t cbor_internal_check_columns(const cbor_column_t *columns, size_t columns_count)
+{
+    size_t i;
+
+    for (i = 0; i < columns_count; ++i)
+    {
+        if (cbor_internal_is_variable_column(&columns[i]) == CBOR_FALSE &&
+            cbor_internal_check_value_size(columns[i].type, columns[i].size) == CBOR_FALSE)
+            return CBOR_FALSE;
+    }
+
+    return CBOR_TRUE;
+}
+
+CBOR_INLINE cbor_column_t *cbor_internal_find_column(cbor_column_t *columns, size_t columns_count, size_t expected_index,
+                                                     const char *key, size_t key_length)
+{
+    size_t i;
+
+    /* keys are usually written in order of columns */
+    if (expected_index < columns_count && cbor_internal_match_name(columns[expected_index].key, key, key_length))
+        return &columns[expected_index];
+
+    for (i = 0; i < columns_count; ++i)
+    {
+        if (cbor_internal_match_name(columns[i].key, key, key_length))
+            return &columns[i];
+    }
+
+    return NULL;
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_decode_column(cbor_token_data_t *token, cbor_column_t *column, size_t row)
+{
+    if (token->type == CBOR_TOKEN_TYPE_NULL || token->type == CBOR_TOKEN_TYPE_UNDEFINED)
+    {
+        cbor_internal_clear_row(column, row);
+        return CBOR_TRUE;
+    }
+
+    if (cbor_internal_is_variable_column(column))
+    {
+        uint32_t *offsets = (uint32_t *)column->values;
+        cbor_base_uint_t length;
+
+        if (cbor_internal_check_type(token, column->type == CBOR_FIELD_TYPE_STRING ?
+                                     CBOR_TOKEN_TYPE_STRING : CBOR_TOKEN_TYPE_BYTES) == CBOR_FALSE)
+            return CBOR_FALSE;
+
+        /* a duplicated key overwrites the value of the row */
+        length = CBOR_GET_BYTES_SIZE(token);
+        if (length > column->data_capacity - offsets[row] || length > (uint32_t)-1 - offsets[row])
+            return cbor_internal_set_error(token, "insufficient buffer size");
+
+        if (cbor_internal_copy_payload(token, column->data + offsets[row], (size_t)length) == CBOR_FALSE)
+            return CBOR_FALSE;
+
+        offsets[row + 1] = offsets[row] + (uint32_t)length;
+    }
+    else if (cbor_internal_decode_scalar(token, column->type, column->size,
+                                         (uint8_t *)column->values + row * column->size) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    cbor_internal_set_valid(column, row, CBOR_TRUE);
+    return CBOR_TRUE;
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_encode_column(uint8_t **data, size_t size, const cbor_column_t *column, size_t row)
+{
+    if (cbor_internal_is_variable_column(column))
+    {
+        const uint32_t *offsets = (const uint32_t *)column->values;
+
+        if (column->type == CBOR_FIELD_TYPE_STRING)
+            return cbor_write_string_with_len(data, size, (const char *)column->data + offsets[row], offsets[row + 1] - offsets[row]);
+
+        return cbor_write_bytes(data, size, column->data + offsets[row], offsets[row + 1] - offsets[row]);
+    }
+
+    return cbor_internal_encode_scalar(data, size, column->type, column->size, (const uint8_t *)column->values + row * column->size);
+}
+
+cbor_bool_t cbor_to_columns(cbor_token_t *token, cbor_column_t *columns, size_t columns_count, size_t rows_capacity, size_t *rows_count)
+{
+    cbor_token_data_t *token_data = (cbor_token_data_t *)token;
+    cbor_base_uint_t rows;
+    cbor_base_uint_t items_count;
+    cbor_base_uint_t j;
+    size_t row;
+    size_t i;
+
+    if (cbor_internal_check_columns(columns, columns_count) == CBOR_FALSE)
+        return cbor_internal_set_error(token_data, "invalid column");
+
+    if (cbor_internal_check_type(token_data, CBOR_TOKEN_TYPE_ARRAY) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    rows = CBOR_GET_ARRAY(token_data);
+    if (rows > rows_capacity)
+        return cbor_internal_set_error(token_data, "insufficient buffer size");
+
+    for (i = 0; i < columns_count; ++i)
+    {
+        if (cbor_internal_is_variable_column(&columns[i]))
+            ((uint32_t *)columns[i].values)[0] = 0;
+    }
+
+    for (row = 0; row < (size_t)rows; ++row)
+    {
+        if (cbor_internal_read_nested(token_data) == CBOR_FALSE ||
+            cbor_internal_check_type(token_data, CBOR_TOKEN_TYPE_MAP) == CBOR_FALSE)
+            return CBOR_FALSE;
+
+        for (i = 0; i < columns_count; ++i)
+            cbor_internal_clear_row(&columns[i], row);
+
+        items_count = CBOR_GET_MAP(token_data);
+        for (j = 0; j < items_count; ++j)
+        {
+            cbor_column_t *column = NULL;
+
+            if (cbor_internal_read_nested(token_data) == CBOR_FALSE)
+                return CBOR_FALSE;
+
+            if (token_data->type == CBOR_TOKEN_TYPE_STRING)
+            {
+                if (CBOR_GET_STRING(token_data) == NULL)
+                    return cbor_internal_set_error(token_data, "key larger than window"); /* streamed */
+
+                column = cbor_internal_find_column(columns, columns_count, (size_t)j, CBOR_GET_STRING(token_data),
+                                                   (size_t)CBOR_GET_STRING_LENGTH(token_data));
+            }
+            else if (cbor_internal_skip_nested(token_data) == CBOR_FALSE)
+                return CBOR_FALSE; /* keys of other types are never matched */
+
+            if (cbor_internal_read_nested(token_data) == CBOR_FALSE)
+                return CBOR_FALSE;
+
+            if (column)
+            {
+                if (cbor_internal_decode_column(token_data, column, row) == CBOR_FALSE)
+                    return CBOR_FALSE;
+            }
+            else if (cbor_internal_skip_nested(token_data) == CBOR_FALSE)
+                return CBOR_FALSE; /* unknown key */
+        }
+    }
+
+    *rows_count = (size_t)rows;
+    cbor_internal_try_to_read_next(token_data);
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_from_columns(uint8_t **data, size_t size, const cbor_column_t *columns, size_t columns_count, size_t rows_count)
+{
+    uint8_t *pos = *data;
+    uint8_t *end = *data + size;
+    size_t row;
+    size_t i;
+
+    if (cbor_internal_check_columns(columns, columns_count) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    if (cbor_write_array(&pos, end - pos, rows_count) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    for (row = 0; row < rows_count; ++row)
+    {
+        size_t present = 0;
+
+        for (i = 0; i < columns_count; ++i)
+        {
+            if (cbor_internal_is_valid(&columns[i], row))
+                ++present;
+        }
+
+        if (cbor_write_map(&pos, end - pos, present) == CBOR_FALSE)
+            return CBOR_FALSE;
+
+        for (i = 0; i < columns_count; ++i)
+        {
+            if (cbor_internal_is_valid(&columns[i], row) == CBOR_FALSE)
+                continue; /* missing values are omitted */
+
+            if (cbor_write_string(&pos, end - pos, columns[i].key) == CBOR_FALSE ||
+                cbor_internal_encode_column(&pos, end - pos, &columns[i], row) == CBOR_FALSE)
+                return CBOR_FALSE;
+        }
+    }
+
+    *data = pos; /* data is changed on success only */
+    return CBOR_TRUE;
+}
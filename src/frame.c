@@ -0,0 +1,160 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <string.h>
+#include "cbor.h"
+#include "internal.h"
+
+#define CBOR_FRAME_MAX_VARINT_SIZE 5 /* of 32 bits lengths */
+
+CBOR_INLINE size_t cbor_internal_get_prefix_size(unsigned int flags)
+{
+    return (flags & CBOR_FRAME_VARINT) ? CBOR_FRAME_MAX_VARINT_SIZE : 4;
+}
+
+CBOR_INLINE size_t cbor_internal_get_varint_size(uint32_t value)
+{
+    size_t size = 1;
+
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        ++size;
+    }
+
+    return size;
+}
+
+/* padded with continuation bytes up to size, so the prefix can be written before the message is known */
+CBOR_INLINE void cbor_internal_store_varint(uint8_t *pos, size_t size, uint32_t value)
+{
+    for (; size > 1; --size)
+    {
+        *pos++ = (uint8_t)(0x80 | (value & 0x7F));
+        value >>= 7;
+    }
+
+    *pos = (uint8_t)value;
+}
+
+cbor_bool_t cbor_frame_begin(uint8_t **data, size_t size, unsigned int flags, cbor_frame_t *frame)
+{
+    size_t overhead = cbor_internal_get_prefix_size(flags) + ((flags & CBOR_FRAME_CRC32C) ? 4 : 0);
+
+    if (size < overhead)
+        return CBOR_FALSE;
+
+    frame->prefix = *data;
+    frame->message = *data + cbor_internal_get_prefix_size(flags);
+    frame->end = *data + size - ((flags & CBOR_FRAME_CRC32C) ? 4 : 0);
+    frame->flags = flags;
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_frame_end(uint8_t **data, const cbor_frame_t *frame, const uint8_t *message_end, cbor_bool_t compact)
+{
+    size_t message_size = (size_t)(message_end - frame->message);
+    uint8_t *pos = frame->message;
+
+    if (message_end < frame->message || message_end > frame->end || message_size > 0xFFFFFFFF)
+        return CBOR_FALSE;
+
+    if (frame->flags & CBOR_FRAME_VARINT)
+    {
+        size_t prefix_size = compact ? cbor_internal_get_varint_size((uint32_t)message_size) : CBOR_FRAME_MAX_VARINT_SIZE;
+
+        cbor_internal_store_varint(frame->prefix, prefix_size, (uint32_t)message_size);
+        pos = frame->prefix + prefix_size;
+        if (pos != frame->message)
+            memmove(pos, frame->message, message_size);
+    }
+    else
+        cbor_internal_store_uint32(frame->prefix, (uint32_t)message_size);
+
+    if (frame->flags & CBOR_FRAME_CRC32C)
+    {
+        cbor_internal_store_uint32(pos + message_size, cbor_crc32c(0, pos, message_size));
+        message_size += 4;
+    }
+
+    *data = pos + message_size;
+    return CBOR_TRUE;
+}
+
+cbor_frame_status_t cbor_split_frame(const uint8_t **data, size_t *size, unsigned int flags, size_t max_message_size,
+                                     const uint8_t **message, size_t *message_size)
+{
+    size_t checksum_size = (flags & CBOR_FRAME_CRC32C) ? 4 : 0;
+    size_t prefix_size;
+    uint32_t length;
+
+    *message = NULL;
+    *message_size = 0;
+
+    if (flags & CBOR_FRAME_VARINT)
+    {
+        length = 0;
+
+        for (prefix_size = 0; ; ++prefix_size)
+        {
+            if (prefix_size == *size)
+                return CBOR_FRAME_MORE;
+
+            /* the last byte holds the highest 4 bits of 32 */
+            if (prefix_size == CBOR_FRAME_MAX_VARINT_SIZE - 1 && (*data)[prefix_size] > 0x0F)
+                return CBOR_FRAME_ERROR;
+
+            length |= (uint32_t)((*data)[prefix_size] & 0x7F) << (7 * prefix_size);
+            if (((*data)[prefix_size] & 0x80) == 0)
+                break;
+        }
+
+        ++prefix_size;
+    }
+    else
+    {
+        prefix_size = 4;
+        if (*size < prefix_size)
+            return CBOR_FRAME_MORE;
+
+        length = cbor_internal_load_uint32(*data);
+    }
+
+    if (length > max_message_size)
+        return CBOR_FRAME_ERROR;
+
+    if (*size - prefix_size < (size_t)length + checksum_size)
+    {
+        *message_size = prefix_size + (size_t)length + checksum_size;
+        return CBOR_FRAME_MORE;
+    }
+
+    if (checksum_size != 0 &&
+        cbor_internal_load_uint32(*data + prefix_size + length) != cbor_crc32c(0, *data + prefix_size, length))
+        return CBOR_FRAME_ERROR;
+
+    *message = *data + prefix_size;
+    *message_size = (size_t)length;
+    *data += prefix_size + length + checksum_size;
+    *size -= prefix_size + length + checksum_size;
+    return CBOR_FRAME_MESSAGE;
+}
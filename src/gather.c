@@ -0,0 +1,107 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <string.h>
+#include "cbor.h"
+#include "internal.h"
+
+CBOR_INLINE void cbor_internal_add_iovec(cbor_gather_writer_t *writer, const void *base, size_t size)
+{
+    writer->iovecs[writer->iovecs_count].base = base;
+    writer->iovecs[writer->iovecs_count].size = size;
+    ++writer->iovecs_count;
+}
+
+static cbor_bool_t cbor_internal_gather_write(cbor_gather_writer_t *writer, unsigned int type, const uint8_t *payload, size_t payload_size)
+{
+    uint8_t *pos = writer->pos;
+
+    if (payload_size < writer->threshold)
+    {
+        if (type == 2)
+            return cbor_write_bytes(&writer->pos, writer->end - writer->pos, payload, payload_size);
+
+        return cbor_write_string_with_len(&writer->pos, writer->end - writer->pos, (const char *)payload, payload_size);
+    }
+
+    /* one iovec is always left for the data written after the payload */
+    if (writer->iovecs_count + 2 >= writer->iovecs_capacity)
+        return CBOR_FALSE;
+
+    if (type == 2)
+    {
+        if (cbor_write_bytes_header(&pos, writer->end - pos, payload_size) == CBOR_FALSE)
+            return CBOR_FALSE;
+    }
+    else if (cbor_write_string_header(&pos, writer->end - pos, payload_size) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    cbor_internal_add_iovec(writer, writer->segment, (size_t)(pos - writer->segment));
+    cbor_internal_add_iovec(writer, payload, payload_size);
+
+    writer->pos = pos;
+    writer->segment = pos;
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_init_gather_writer(cbor_gather_writer_t *writer, uint8_t *buffer, size_t buffer_size, cbor_iovec_t *iovecs, size_t iovecs_capacity,
+                                    size_t threshold)
+{
+    if (iovecs_capacity == 0)
+        return CBOR_FALSE;
+
+    writer->pos = buffer;
+    writer->end = buffer + buffer_size;
+    writer->segment = buffer;
+    writer->iovecs = iovecs;
+    writer->iovecs_capacity = iovecs_capacity;
+    writer->iovecs_count = 0;
+    writer->threshold = threshold;
+
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_gather_write_string_with_len(cbor_gather_writer_t *writer, const char *str, size_t str_length)
+{
+    return cbor_internal_gather_write(writer, 3, (const uint8_t *)str, str_length);
+}
+
+cbor_bool_t cbor_gather_write_string(cbor_gather_writer_t *writer, const char *str)
+{
+    return cbor_internal_gather_write(writer, 3, (const uint8_t *)str, strlen(str));
+}
+
+cbor_bool_t cbor_gather_write_bytes(cbor_gather_writer_t *writer, const uint8_t *bytes, size_t bytes_size)
+{
+    return cbor_internal_gather_write(writer, 2, bytes, bytes_size);
+}
+
+size_t cbor_gather_finish(cbor_gather_writer_t *writer)
+{
+    if (writer->pos != writer->segment)
+    {
+        cbor_internal_add_iovec(writer, writer->segment, (size_t)(writer->pos - writer->segment));
+        writer->segment = writer->pos;
+    }
+
+    return writer->iovecs_count;
+}
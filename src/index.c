@@ -0,0 +1,292 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <math.h>
+#include <string.h>
+#include "cbor.h"
+#include "internal.h"
+
+#define CBOR_INDEX_VERSION 1
+
+static const uint8_t cbor_index_magic[4] = { 'C', 'B', 'I', 'X' };
+
+/* values are stored in big-endian order, so blocks have no alignment requirements */
+
+CBOR_INLINE uint8_t *cbor_internal_store_index_uint(uint8_t *pos, cbor_base_uint_t value)
+{
+#ifdef CBOR_INT64_SUPPORT
+    pos = cbor_internal_store_uint32(pos, (uint32_t)(value >> 32));
+#else
+    pos = cbor_internal_store_uint32(pos, 0);
+#endif
+
+    return cbor_internal_store_uint32(pos, (uint32_t)value);
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_load_index_uint(const uint8_t *pos, cbor_base_uint_t *value)
+{
+#ifdef CBOR_INT64_SUPPORT
+    *value = ((cbor_base_uint_t)cbor_internal_load_uint32(pos) << 32) | cbor_internal_load_uint32(pos + 4);
+#else
+    if (cbor_internal_load_uint32(pos) != 0)
+        return CBOR_FALSE; /* 64 bits integers aren't supported */
+
+    *value = cbor_internal_load_uint32(pos + 4);
+#endif
+
+    return CBOR_TRUE;
+}
+
+CBOR_INLINE uint8_t *cbor_internal_store_index_double(uint8_t *pos, double value)
+{
+    uint32_t words[2];
+
+    memcpy(words, &value, sizeof(words));
+#ifdef CBOR_BIGENDIAN_PLATFORM
+    pos = cbor_internal_store_uint32(pos, words[0]);
+    return cbor_internal_store_uint32(pos, words[1]);
+#else
+    pos = cbor_internal_store_uint32(pos, words[1]);
+    return cbor_internal_store_uint32(pos, words[0]);
+#endif
+}
+
+CBOR_INLINE double cbor_internal_load_index_double(const uint8_t *pos)
+{
+    uint32_t words[2];
+    double value;
+
+#ifdef CBOR_BIGENDIAN_PLATFORM
+    words[0] = cbor_internal_load_uint32(pos);
+    words[1] = cbor_internal_load_uint32(pos + 4);
+#else
+    words[1] = cbor_internal_load_uint32(pos);
+    words[0] = cbor_internal_load_uint32(pos + 4);
+#endif
+
+    memcpy(&value, words, sizeof(value));
+    return value;
+}
+
+/* numeric values of the keys of a top-level map extend zones of the current block */
+static cbor_bool_t cbor_internal_add_zones(cbor_index_builder_t *builder, const uint8_t *record, size_t record_size)
+{
+    cbor_stats_t zones[CBOR_INDEX_MAX_KEYS];
+    cbor_token_data_t token;
+    cbor_base_uint_t items_count;
+    cbor_base_uint_t i;
+
+    cbor_internal_init_token(&token, record, record + record_size);
+
+    if (builder->keys_count == 0)
+        return CBOR_TRUE;
+
+    if (cbor_internal_read_next(&token) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    if (token.type != CBOR_TOKEN_TYPE_MAP)
+        return cbor_internal_skip_nested(&token);
+
+    /* zones are updated on success only */
+    memcpy(zones, builder->zones, sizeof(zones[0]) * builder->keys_count);
+
+    items_count = CBOR_GET_MAP(&token);
+    for (i = 0; i < items_count; ++i)
+    {
+        size_t key_index = builder->keys_count;
+
+        if (cbor_internal_read_nested(&token) == CBOR_FALSE)
+            return CBOR_FALSE;
+
+        if (token.type == CBOR_TOKEN_TYPE_STRING)
+        {
+            size_t key_length = (size_t)CBOR_GET_STRING_LENGTH(&token);
+
+            for (key_index = 0; key_index < builder->keys_count; ++key_index)
+            {
+                if (cbor_internal_match_name(builder->keys[key_index], CBOR_GET_STRING(&token), key_length))
+                    break;
+            }
+        }
+        else if (cbor_internal_skip_nested(&token) == CBOR_FALSE)
+            return CBOR_FALSE;
+
+        if (cbor_internal_read_nested(&token) == CBOR_FALSE)
+            return CBOR_FALSE;
+
+        if (key_index < builder->keys_count)
+            cbor_internal_add_number(&zones[key_index], &token); /* values of other types are ignored */
+
+        if (cbor_internal_skip_nested(&token) == CBOR_FALSE)
+            return CBOR_FALSE;
+    }
+
+    memcpy(builder->zones, zones, sizeof(zones[0]) * builder->keys_count);
+    return CBOR_TRUE;
+}
+
+static size_t cbor_internal_complete_block(cbor_index_builder_t *builder, size_t records_count)
+{
+    uint8_t *pos = builder->block;
+    size_t i;
+
+    for (i = 0; i < builder->keys_count; ++i)
+    {
+        /* a block without values has an empty range */
+        double min = builder->zones[i].count != 0 ? builder->zones[i].min : HUGE_VAL;
+        double max = builder->zones[i].count != 0 ? builder->zones[i].max : -HUGE_VAL;
+
+        pos = cbor_internal_store_index_double(pos, min);
+        pos = cbor_internal_store_index_double(pos, max);
+    }
+
+    memset(builder->zones, 0, sizeof(builder->zones));
+    return CBOR_INDEX_BLOCK_SIZE(builder->keys_count, records_count);
+}
+
+cbor_bool_t cbor_init_index_builder(cbor_index_builder_t *builder, const char *const *keys, size_t keys_count, size_t block_records, uint8_t *block)
+{
+    if (keys_count > CBOR_INDEX_MAX_KEYS || block_records == 0 || (uint32_t)block_records != block_records)
+        return CBOR_FALSE;
+
+    memset(builder, 0, sizeof(*builder));
+    builder->keys = keys;
+    builder->keys_count = keys_count;
+    builder->block_records = block_records;
+    builder->block = block;
+
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_index_add_record(cbor_index_builder_t *builder, cbor_base_uint_t offset, const uint8_t *record, size_t record_size,
+                                  size_t *block_size)
+{
+    size_t block_record = builder->records_count % builder->block_records;
+
+    if (cbor_internal_add_zones(builder, record, record_size) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    cbor_internal_store_index_uint(builder->block + CBOR_INDEX_BLOCK_SIZE(builder->keys_count, block_record), offset);
+    ++builder->records_count;
+
+    *block_size = 0;
+    if (block_record + 1 == builder->block_records)
+        *block_size = cbor_internal_complete_block(builder, builder->block_records);
+
+    return CBOR_TRUE;
+}
+
+size_t cbor_index_finish(cbor_index_builder_t *builder)
+{
+    size_t block_records = builder->records_count % builder->block_records;
+
+    if (block_records == 0)
+        return 0;
+
+    return cbor_internal_complete_block(builder, block_records);
+}
+
+void cbor_index_write_header(const cbor_index_builder_t *builder, uint8_t *header)
+{
+    uint8_t *pos = header;
+
+    memcpy(pos, cbor_index_magic, sizeof(cbor_index_magic));
+    pos = cbor_internal_store_uint32(pos + sizeof(cbor_index_magic), CBOR_INDEX_VERSION);
+    pos = cbor_internal_store_uint32(pos, (uint32_t)builder->keys_count);
+    pos = cbor_internal_store_uint32(pos, (uint32_t)builder->block_records);
+    cbor_internal_store_index_uint(pos, (cbor_base_uint_t)builder->records_count);
+}
+
+cbor_bool_t cbor_init_index(cbor_index_t *index, const uint8_t *data, size_t size)
+{
+    cbor_base_uint_t records_count;
+    size_t blocks_size;
+
+    if (size < CBOR_INDEX_HEADER_SIZE || memcmp(data, cbor_index_magic, sizeof(cbor_index_magic)) != 0 ||
+        cbor_internal_load_uint32(data + 4) != CBOR_INDEX_VERSION)
+        return CBOR_FALSE;
+
+    index->data = data;
+    index->keys_count = cbor_internal_load_uint32(data + 8);
+    index->block_records = cbor_internal_load_uint32(data + 12);
+
+    if (index->keys_count > CBOR_INDEX_MAX_KEYS || index->block_records == 0 ||
+        cbor_internal_load_index_uint(data + 16, &records_count) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    /* every record takes 8 bytes at least, so sizes below can't overflow */
+    blocks_size = size - CBOR_INDEX_HEADER_SIZE;
+    if (records_count > blocks_size / 8)
+        return CBOR_FALSE;
+
+    index->records_count = (size_t)records_count;
+    index->blocks_count = (index->records_count + index->block_records - 1) / index->block_records;
+
+    if (blocks_size != index->blocks_count * index->keys_count * 16 + index->records_count * 8)
+        return CBOR_FALSE;
+
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_index_get_offset(const cbor_index_t *index, size_t record, cbor_base_uint_t *offset)
+{
+    const uint8_t *pos;
+
+    if (record >= index->records_count)
+        return CBOR_FALSE;
+
+    pos = index->data + CBOR_INDEX_HEADER_SIZE +
+          (record / index->block_records) * CBOR_INDEX_BLOCK_SIZE(index->keys_count, index->block_records) +
+          CBOR_INDEX_BLOCK_SIZE(index->keys_count, record % index->block_records);
+
+    return cbor_internal_load_index_uint(pos, offset);
+}
+
+cbor_bool_t cbor_index_get_zone(const cbor_index_t *index, size_t block, size_t key_index, double *min, double *max)
+{
+    const uint8_t *pos;
+
+    if (block >= index->blocks_count || key_index >= index->keys_count)
+        return CBOR_FALSE;
+
+    pos = index->data + CBOR_INDEX_HEADER_SIZE +
+          block * CBOR_INDEX_BLOCK_SIZE(index->keys_count, index->block_records) + key_index * 16;
+
+    *min = cbor_internal_load_index_double(pos);
+    *max = cbor_internal_load_index_double(pos + 8);
+
+    return *min <= *max ? CBOR_TRUE : CBOR_FALSE; /* block has no values of the key */
+}
+
+size_t cbor_index_find_block(const cbor_index_t *index, size_t block, size_t key_index, double min, double max)
+{
+    for (; block < index->blocks_count; ++block)
+    {
+        double zone_min;
+        double zone_max;
+
+        if (cbor_index_get_zone(index, block, key_index, &zone_min, &zone_max) && zone_min <= max && zone_max >= min)
+            return block;
+    }
+
+    return index->blocks_count;
+}
@@ -0,0 +1,208 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L /* pread, pwrite and fdatasync */
+#endif
+
+#include <string.h>
+#include "cbor.h"
+#include "internal.h"
+#include "internal_io.h"
+
+cbor_bool_t cbor_init_log(cbor_log_t *log, int fd, uint8_t *buffer, size_t buffer_size, size_t alignment, size_t group_records,
+                          cbor_base_uint_t size)
+{
+    size_t tail;
+
+    if (alignment == 0 || buffer_size % alignment != 0 || buffer_size <= alignment)
+        return CBOR_FALSE;
+
+    memset(log, 0, sizeof(*log));
+    log->fd = fd;
+    log->buffer = buffer;
+    log->buffer_size = buffer_size;
+    log->alignment = alignment;
+    log->group_records = group_records;
+
+    /* the last incomplete block is written again with new records */
+    tail = (size_t)(size % alignment);
+    log->offset = size - tail;
+    if (tail != 0 && cbor_internal_read_at(fd, buffer, tail, log->offset) != (long)tail)
+        return CBOR_FALSE;
+
+    log->used = tail;
+    log->flushed = tail;
+    return CBOR_TRUE;
+}
+
+uint8_t *cbor_log_reserve(cbor_log_t *log, size_t size)
+{
+    uint8_t *pos;
+
+    log->reserved = NULL;
+
+    if (size > log->buffer_size - CBOR_LOG_RECORD_OVERHEAD)
+        return NULL;
+
+    size += CBOR_LOG_RECORD_OVERHEAD;
+    if (log->buffer_size - log->used < size && cbor_log_flush(log) == CBOR_FALSE)
+        return NULL;
+
+    if (log->buffer_size - log->used < size)
+        return NULL;
+
+    pos = log->buffer + log->used;
+    if (cbor_frame_begin(&pos, size, CBOR_FRAME_CRC32C, &log->frame) == CBOR_FALSE)
+        return NULL;
+
+    log->reserved = log->frame.message;
+    return log->reserved;
+}
+
+cbor_bool_t cbor_log_commit(cbor_log_t *log, const uint8_t *end)
+{
+    uint8_t *pos;
+
+    /* records are never empty, so zero-filled data isn't taken for records on recovery */
+    if (log->reserved == NULL || end <= log->reserved || end > log->frame.end)
+        return CBOR_FALSE;
+
+    if (cbor_frame_end(&pos, &log->frame, end, CBOR_FALSE) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    log->used = (size_t)(pos - log->buffer);
+    log->reserved = NULL;
+
+    /* group commit: one synchronization for a batch of records */
+    if (log->group_records != 0 && ++log->records >= log->group_records)
+        return cbor_log_sync(log);
+
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_log_append(cbor_log_t *log, const uint8_t *record, size_t record_size)
+{
+    uint8_t *pos = cbor_log_reserve(log, record_size);
+
+    if (pos == NULL)
+        return CBOR_FALSE;
+
+    memcpy(pos, record, record_size);
+    return cbor_log_commit(log, pos + record_size);
+}
+
+cbor_bool_t cbor_log_flush(cbor_log_t *log)
+{
+    size_t tail;
+
+    if (log->reserved != NULL)
+        return CBOR_FALSE; /* record isn't committed */
+
+    if (log->flushed == log->used)
+        return CBOR_TRUE;
+
+    /* writes start at an aligned offset, the incomplete block is kept */
+    if (cbor_internal_write_at(log->fd, log->buffer, log->used, log->offset) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    tail = log->used % log->alignment;
+    memmove(log->buffer, log->buffer + log->used - tail, tail);
+    log->offset += log->used - tail;
+    log->used = tail;
+    log->flushed = tail;
+
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_log_sync(cbor_log_t *log)
+{
+    if (cbor_log_flush(log) == CBOR_FALSE || cbor_internal_sync(log->fd) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    log->records = 0;
+    return CBOR_TRUE;
+}
+
+size_t cbor_get_valid_size(const uint8_t *data, size_t size)
+{
+    cbor_token_data_t token;
+    size_t valid_size = 0;
+
+    cbor_internal_init_token(&token, data, data + size);
+
+    while (cbor_internal_read_next(&token) && cbor_internal_skip_nested(&token))
+        valid_size = (size_t)(token.pos - data);
+
+    return valid_size;
+}
+
+cbor_bool_t cbor_log_recover(int fd, uint8_t *buffer, size_t buffer_size, cbor_base_uint_t *size)
+{
+    cbor_base_uint_t offset = 0;
+    cbor_bool_t done = CBOR_FALSE;
+
+    if (buffer_size <= CBOR_LOG_RECORD_OVERHEAD)
+        return CBOR_FALSE;
+
+    /* the file is truncated at the first torn, corrupted or malformed record */
+    while (done == CBOR_FALSE)
+    {
+        long count = cbor_internal_read_at(fd, buffer, buffer_size, offset);
+        const uint8_t *pos = buffer;
+        size_t left;
+
+        if (count < 0)
+            return CBOR_FALSE;
+
+        left = (size_t)count;
+
+        for (;;)
+        {
+            const uint8_t *record;
+            size_t record_size;
+            cbor_frame_status_t status = cbor_split_frame(&pos, &left, CBOR_FRAME_CRC32C, buffer_size - CBOR_LOG_RECORD_OVERHEAD,
+                                                          &record, &record_size);
+
+            if (status == CBOR_FRAME_MORE)
+            {
+                /* records fit the buffer, so they are complete after the next read unless the file ends here */
+                done = (size_t)count < buffer_size ? CBOR_TRUE : CBOR_FALSE;
+                break;
+            }
+
+            if (status == CBOR_FRAME_ERROR || record_size == 0 || cbor_get_valid_size(record, record_size) != record_size)
+            {
+                done = CBOR_TRUE;
+                break;
+            }
+
+            offset += record_size + CBOR_LOG_RECORD_OVERHEAD;
+        }
+    }
+
+    if (cbor_internal_truncate(fd, offset) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    *size = offset;
+    return CBOR_TRUE;
+}
@@ -0,0 +1,153 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <string.h>
+#include "cbor.h"
+#include "internal.h"
+#include "internal_thread.h"
+
+typedef struct
+{
+    cbor_write_element_t write_element;
+    void *ctx;
+    size_t first;               /* range of element indexes */
+    size_t last;
+    size_t next;                /* first element not written */
+    uint8_t *start;             /* output buffer or a slice of scratch */
+    uint8_t *pos;
+    uint8_t *end;
+} cbor_internal_array_part_t;
+
+static void cbor_internal_write_part(cbor_internal_array_part_t *part)
+{
+    for (part->next = part->first; part->next < part->last; ++part->next)
+    {
+        uint8_t *element = part->pos;
+
+        /* a partially written element is dropped, it's written again by the calling thread */
+        if (part->write_element(&part->pos, (size_t)(part->end - part->pos), part->next, part->ctx) == CBOR_FALSE)
+        {
+            part->pos = element;
+            return;
+        }
+    }
+}
+
+CBOR_THREAD_PROC(cbor_internal_write_part_proc, arg)
+{
+    cbor_internal_write_part((cbor_internal_array_part_t *)arg);
+    CBOR_THREAD_RETURN;
+}
+
+cbor_bool_t cbor_write_array_parallel(uint8_t **data, size_t size, size_t count, cbor_write_element_t write_element, void *ctx,
+                                      uint8_t *scratch, size_t scratch_size, unsigned int threads_count)
+{
+    cbor_internal_array_part_t parts[CBOR_MAX_THREADS];
+    cbor_internal_thread_t threads[CBOR_MAX_THREADS];
+    cbor_bool_t started[CBOR_MAX_THREADS];
+    uint8_t *pos = *data;
+    uint8_t *end = *data + size;
+    size_t slice_size = 0;
+    size_t index;
+    unsigned int i;
+
+    if ((cbor_base_uint_t)count != count || cbor_write_array(&pos, size, (cbor_base_uint_t)count) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    if (threads_count > CBOR_MAX_THREADS)
+        threads_count = CBOR_MAX_THREADS;
+    if (count < threads_count)
+        threads_count = (unsigned int)count;
+    if (threads_count > 1)
+        slice_size = scratch_size / (threads_count - 1);
+
+    if (threads_count <= 1 || scratch == NULL || slice_size == 0)
+    {
+        for (index = 0; index < count; ++index)
+        {
+            if (write_element(&pos, (size_t)(end - pos), index, ctx) == CBOR_FALSE)
+                return CBOR_FALSE;
+        }
+
+        *data = pos;
+        return CBOR_TRUE;
+    }
+
+    /* the first range is written in place, the others into equal slices of scratch since their offsets aren't known yet */
+    for (i = 0; i < threads_count; ++i)
+    {
+        parts[i].write_element = write_element;
+        parts[i].ctx = ctx;
+        parts[i].first = count / threads_count * i + (i < count % threads_count ? i : count % threads_count);
+        parts[i].last = count / threads_count * (i + 1) + (i + 1 < count % threads_count ? i + 1 : count % threads_count);
+        parts[i].next = parts[i].first;
+        parts[i].start = i == 0 ? pos : scratch + slice_size * (i - 1);
+        parts[i].pos = parts[i].start;
+        parts[i].end = i == 0 ? end : parts[i].start + slice_size;
+    }
+
+    /* the first part is written by the calling thread */
+    for (i = 1; i < threads_count; ++i)
+        started[i] = cbor_internal_start_thread(&threads[i], cbor_internal_write_part_proc, &parts[i]);
+
+    cbor_internal_write_part(&parts[0]);
+
+    for (i = 1; i < threads_count; ++i)
+    {
+        if (started[i])
+            cbor_internal_join_thread(threads[i]);
+        else
+            cbor_internal_write_part(&parts[i]);
+    }
+
+    if (parts[0].next < parts[0].last)
+        return CBOR_FALSE; /* no space for the first part, so for the array either */
+
+    /* parts are copied after the first one */
+    pos = parts[0].pos;
+    for (i = 1; i < threads_count; ++i)
+    {
+        size_t part_length = (size_t)(parts[i].pos - parts[i].start);
+
+        if (part_length > (size_t)(end - pos))
+            return CBOR_FALSE;
+
+        memcpy(pos, parts[i].start, part_length);
+        pos += part_length;
+
+        if (parts[i].next < parts[i].last)
+            break;
+    }
+
+    /* the rest of a part that overflowed its slice and the parts after it are written by the calling thread */
+    if (i < threads_count)
+    {
+        for (index = parts[i].next; index < count; ++index)
+        {
+            if (write_element(&pos, (size_t)(end - pos), index, ctx) == CBOR_FALSE)
+                return CBOR_FALSE;
+        }
+    }
+
+    *data = pos;
+    return CBOR_TRUE;
+}
@@ -0,0 +1,37 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <string.h>
+#include "cbor.h"
+#include "internal.h"
+
+/* calls optional callback, missing callbacks are treated as successful */
+#define CBOR_INTERNAL_CALLBACK(callbacks, name, args) ((callbacks)->name ? (callbacks)->name args : CBOR_TRUE)
+
+cbor_bool_t cbor_parse(const uint8_t *data, size_t data_size, const cbor_callbacks_t *callbacks, void *ctx)
+{
+#define CBOR_PARSE_CALLBACK0(name) CBOR_INTERNAL_CALLBACK(callbacks, name, (ctx))
+#define CBOR_PARSE_CALLBACK1(name, value) CBOR_INTERNAL_CALLBACK(callbacks, name, (ctx, value))
+#define CBOR_PARSE_CALLBACK2(name, value, size) CBOR_INTERNAL_CALLBACK(callbacks, name, (ctx, value, size))
+#define CBOR_PARSE_ERROR(message) if (callbacks->on_error) callbacks->on_error(ctx, message)
+#include "cbor_parse_inline.h"
+}
@@ -0,0 +1,208 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <string.h>
+#include "cbor.h"
+#include "internal.h"
+
+typedef struct
+{
+    const char **paths;
+    size_t paths_count;
+    const char *prefix; /* dot-separated path of the current map */
+    size_t prefix_length;
+} cbor_internal_projection_t;
+
+/* returns path relative to the current map or NULL if the path is out of it */
+CBOR_INLINE const char *cbor_internal_get_relative_path(const cbor_internal_projection_t *projection, const char *path)
+{
+    if (projection->prefix_length == 0)
+        return path;
+
+    if (strncmp(path, projection->prefix, projection->prefix_length) != 0 || path[projection->prefix_length] != '.')
+        return NULL;
+
+    return path + projection->prefix_length + 1;
+}
+
+static cbor_bool_t cbor_internal_project_map(cbor_token_data_t *token, const cbor_internal_projection_t *projection,
+                                             uint8_t **data, uint8_t *end, size_t depth, size_t *projected_count)
+{
+    uint8_t *pos = *data;
+    uint8_t *header = pos;
+    size_t header_width;
+    size_t max_count = 0;
+    size_t count = 0;
+    cbor_base_uint_t items_count;
+    cbor_base_uint_t i;
+    size_t j;
+
+    if (cbor_internal_check_type(token, CBOR_TOKEN_TYPE_MAP) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    /* every path adds one key at most, size is written after projection */
+    for (j = 0; j < projection->paths_count; ++j)
+    {
+        if (cbor_internal_get_relative_path(projection, projection->paths[j]))
+            ++max_count;
+    }
+
+    header_width = cbor_internal_get_value_width(max_count);
+    if ((size_t)(end - pos) < 1 + header_width)
+        return CBOR_FALSE;
+    pos += 1 + header_width;
+
+    items_count = CBOR_GET_MAP(token);
+    for (i = 0; i < items_count; ++i)
+    {
+        const char *key;
+        size_t key_length;
+        const uint8_t *key_start;
+        const char *nested_path = NULL;
+        cbor_bool_t exact_match = CBOR_FALSE;
+
+        if (cbor_internal_read_nested(token) == CBOR_FALSE)
+            return CBOR_FALSE;
+
+        if (token->type != CBOR_TOKEN_TYPE_STRING)
+        {
+            /* keys of other types are never matched */
+            if (cbor_internal_skip_nested(token) == CBOR_FALSE ||
+                cbor_internal_read_nested(token) == CBOR_FALSE ||
+                cbor_internal_skip_nested(token) == CBOR_FALSE)
+                return CBOR_FALSE;
+            continue;
+        }
+
+        key = CBOR_GET_STRING(token);
+        key_length = (size_t)CBOR_GET_STRING_LENGTH(token);
+        key_start = token->start;
+
+        for (j = 0; j < projection->paths_count && exact_match == CBOR_FALSE; ++j)
+        {
+            const char *path = cbor_internal_get_relative_path(projection, projection->paths[j]);
+
+            if (path == NULL)
+                continue;
+
+            /* keys with embedded zeros never match the start of a longer path */
+            if (cbor_internal_match_name(path, key, key_length))
+                exact_match = CBOR_TRUE;
+            else if (memchr(key, 0, key_length) == NULL && strncmp(path, key, key_length) == 0 && path[key_length] == '.')
+                nested_path = projection->paths[j];
+        }
+
+        if (cbor_internal_read_nested(token) == CBOR_FALSE)
+            return CBOR_FALSE;
+
+        /* the header has room for one key per path, more matches come from duplicate keys */
+        if ((exact_match || nested_path) && count == max_count)
+        {
+            token->type = CBOR_TOKEN_TYPE_ERROR;
+            token->error_message = "duplicate keys";
+            return CBOR_FALSE;
+        }
+
+        if (exact_match)
+        {
+            const uint8_t *value_start = token->start;
+
+            if (cbor_internal_skip_nested(token) == CBOR_FALSE)
+                return CBOR_FALSE;
+
+            /* key and value are copied as is */
+            if ((size_t)(end - pos) < (size_t)(token->pos - key_start))
+                return CBOR_FALSE;
+
+            memcpy(pos, key_start, value_start - key_start);
+            pos += value_start - key_start;
+            memcpy(pos, value_start, token->pos - value_start);
+            pos += token->pos - value_start;
+            ++count;
+        }
+        else if (nested_path && token->type == CBOR_TOKEN_TYPE_MAP)
+        {
+            cbor_internal_projection_t nested_projection = *projection;
+            size_t nested_count;
+            uint8_t *key_pos = pos;
+
+            if (depth == CBOR_MAX_NESTING_DEPTH)
+            {
+                token->type = CBOR_TOKEN_TYPE_ERROR;
+                token->error_message = "maximum nesting depth exceeded";
+                return CBOR_FALSE;
+            }
+
+            if ((size_t)(end - pos) < (size_t)(token->start - key_start))
+                return CBOR_FALSE;
+
+            memcpy(pos, key_start, token->start - key_start);
+            pos += token->start - key_start;
+
+            nested_projection.prefix = nested_path;
+            nested_projection.prefix_length = (projection->prefix_length ? projection->prefix_length + 1 : 0) + key_length;
+
+            if (cbor_internal_project_map(token, &nested_projection, &pos, end, depth + 1, &nested_count) == CBOR_FALSE)
+                return CBOR_FALSE;
+
+            if (nested_count > 0)
+                ++count;
+            else
+                pos = key_pos; /* maps without requested keys are omitted */
+        }
+        else if (cbor_internal_skip_nested(token) == CBOR_FALSE)
+            return CBOR_FALSE;
+    }
+
+    if (header_width == 0)
+        *header = CBOR_CREATE_INITIAL_BYTE(5, count);
+    else
+        cbor_internal_store_fixed_int_value(header, 5, header_width, count);
+
+    *data = pos;
+    *projected_count = count;
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_project(const uint8_t *data, size_t data_size, const char **paths, size_t paths_count, uint8_t **out, size_t out_size)
+{
+    cbor_internal_projection_t projection;
+    cbor_token_data_t token;
+    uint8_t *pos = *out;
+    size_t projected_count;
+
+    cbor_internal_init_token(&token, data, data + data_size);
+
+    if (cbor_internal_read_next(&token) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    projection.paths = paths;
+    projection.paths_count = paths_count;
+    projection.prefix = NULL;
+    projection.prefix_length = 0;
+
+    if (cbor_internal_project_map(&token, &projection, &pos, *out + out_size, 0, &projected_count) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    *out = pos; /* data is changed on success only */
+    return CBOR_TRUE;
+}
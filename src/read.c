@@ -24,263 +24,11 @@ THE SOFTWARE.
 #include "cbor.h"
 #include "internal.h"
 
-#define CBOR_GET_MAJOR_TYPE(initial_byte) ((initial_byte) >> 5)
-#define CBOR_GET_MINOR_TYPE(initial_byte) ((initial_byte) & 31)
-
-static cbor_token_type_t cbor_internal_types_map[] =
-{
-    CBOR_TOKEN_TYPE_PINT,   /* 0 */
-    CBOR_TOKEN_TYPE_NINT,   /* 1 */
-    CBOR_TOKEN_TYPE_BYTES,  /* 2 */
-    CBOR_TOKEN_TYPE_STRING, /* 3 */
-    CBOR_TOKEN_TYPE_ARRAY,  /* 4 */
-    CBOR_TOKEN_TYPE_MAP,    /* 5 */
-    CBOR_TOKEN_TYPE_TAG,    /* 6 */
-    CBOR_TOKEN_TYPE_SPECIAL /* 7 */
-};
-
-CBOR_INLINE int cbor_internal_get_width(unsigned int minor_type)
-{
-    if (minor_type < 24)
-        return 0;
-
-    switch (minor_type)
-    {
-    case 24: return 1;
-    case 25: return 2;
-    case 26: return 4;
-    case 27: return 8;
-    }
-
-    return -1;
-}
-
-CBOR_INLINE cbor_bool_t cbor_internal_read_int_value(unsigned int minor_type, cbor_token_data_t *token)
-{
-    int type_width = cbor_internal_get_width(minor_type);
-
-    if (type_width < 0)
-    {
-        token->type = CBOR_TOKEN_TYPE_ERROR;
-        token->error_message = "invalid type width";
-        return CBOR_FALSE;
-    }
-
-    if ((size_t)(token->end - token->pos) < (size_t)type_width)
-    {
-        token->type = CBOR_TOKEN_TYPE_ERROR;
-        token->error_message = "insufficient data";
-        return CBOR_FALSE;
-    }
-
-    switch (type_width)
-    {
-    case 0:
-        token->int_value = minor_type;
-        return CBOR_TRUE;
-    case 1:
-        token->int_value = *token->pos;
-        token->pos += 1; /* bytes processed */
-        return CBOR_TRUE;
-    case 2:
-        {
-            uint16_t short_value;
-            cbor_internal_swap_2bytes((uint8_t *)&short_value, token->pos);
-            token->int_value = short_value;
-            token->pos += 2; /* bytes processed */
-            return CBOR_TRUE;
-        }
-    case 4:
-        {
-            uint32_t int_value;
-            cbor_internal_swap_4bytes((uint8_t *)&int_value, token->pos);
-            token->int_value = int_value;
-            token->pos += 4; /* bytes processed */
-            return CBOR_TRUE;
-        }
-    case 8:
-#ifdef CBOR_INT64_SUPPORT
-        {
-            cbor_base_uint_t value;
-            cbor_internal_swap_8bytes((uint8_t *)&value, token->pos);
-            token->int_value = value;
-            token->pos += 8; /* bytes processed */
-            return CBOR_TRUE;
-        }
-#else
-        token->type = CBOR_TOKEN_TYPE_ERROR;
-        token->error_message = "64 bits integers are not supported";
-        return CBOR_FALSE;
-#endif
-    }
-
-    token->type = CBOR_TOKEN_TYPE_ERROR;
-    token->error_message = "unknown error";
-    return CBOR_FALSE;
-}
-
-CBOR_INLINE cbor_bool_t cbor_internal_extract_special_value(unsigned int minor_type, cbor_token_data_t *token)
-{
-    switch (minor_type)
-    {
-    case 20: /* false */
-        token->type = CBOR_TOKEN_TYPE_BOOLEAN;
-        token->int_value = CBOR_FALSE;
-        return CBOR_TRUE;
-    case 21: /* true */
-        token->type = CBOR_TOKEN_TYPE_BOOLEAN;
-        token->int_value = CBOR_TRUE;
-        return CBOR_TRUE;
-    case 22: /* null */
-        token->type = CBOR_TOKEN_TYPE_NULL;
-        return CBOR_TRUE;
-    case 23: /* undefined */
-        token->type = CBOR_TOKEN_TYPE_UNDEFINED;
-        return CBOR_TRUE;
-    case 26: /* single-precision float */
-        if ((size_t)(token->end - token->pos) < 4)
-        {
-            token->type = CBOR_TOKEN_TYPE_ERROR;
-            token->error_message = "insufficient data";
-            return CBOR_FALSE;
-        }
-        {
-            float float_value;
-            cbor_internal_swap_4bytes((uint8_t *)&float_value, token->pos);
-
-            token->type = CBOR_TOKEN_TYPE_FLOAT;
-            token->float_value = float_value;
-            token->pos += 4; /* bytes processed */
-            return CBOR_TRUE;
-        }
-    case 27: /* double-precision float */
-        if ((size_t)(token->end - token->pos) < 8)
-        {
-            token->type = CBOR_TOKEN_TYPE_ERROR;
-            token->error_message = "insufficient data";
-            return CBOR_FALSE;
-        }
-        {
-            double double_value;
-            cbor_internal_swap_8bytes((uint8_t *)&double_value, token->pos);
-
-            token->type = CBOR_TOKEN_TYPE_FLOAT;
-            token->float_value = double_value;
-            token->pos += 8; /* bytes processed */
-            return CBOR_TRUE;
-        }
-    default:
-        {
-            if (cbor_internal_read_int_value(minor_type, token) == CBOR_FALSE)
-                return CBOR_FALSE;
-
-            token->type = CBOR_TOKEN_TYPE_SPECIAL;
-            return CBOR_TRUE;
-        }
-    }
-}
-
-CBOR_INLINE cbor_bool_t cbor_internal_check_type(cbor_token_data_t *token, cbor_token_type_t expected_type)
-{
-    if (token->type != expected_type)
-    {
-        token->type = CBOR_TOKEN_TYPE_ERROR;
-        token->error_message = "invalid data type";
-        return CBOR_FALSE;
-    }
-
-    return CBOR_TRUE;
-}
-
-CBOR_INLINE cbor_bool_t cbor_internal_read_next(cbor_token_data_t *token)
-{
-    unsigned int major_type;
-    unsigned int minor_type;
-    const uint8_t *current_pos = token->pos;
-
-    if (token->type == CBOR_TOKEN_TYPE_ERROR)
-        return CBOR_FALSE; /* state is not changed */
-
-    if (current_pos >= token->end)
-    {
-        token->type = CBOR_TOKEN_TYPE_END;
-        return CBOR_FALSE; /* nothing to read */
-    }
-
-    major_type = CBOR_GET_MAJOR_TYPE(*current_pos);
-    minor_type = CBOR_GET_MINOR_TYPE(*current_pos);
-    token->pos += 1; /* initial byte is processed */
-
-    switch (major_type)
-    {
-    case 0: /* positive integer */
-        if (cbor_internal_read_int_value(minor_type, token))
-        {
-            token->type = CBOR_TOKEN_TYPE_PINT;
-            return CBOR_TRUE;
-        }
-        break;
-    case 1: /* negative integer */
-        if (cbor_internal_read_int_value(minor_type, token))
-        {
-            token->type = CBOR_TOKEN_TYPE_NINT;
-            return CBOR_TRUE;
-        }
-        break;
-    case 2: /* bytes */
-    case 3: /* string */
-        if (cbor_internal_read_int_value(minor_type, token))
-        {
-            if ((size_t)(token->end - token->pos) < token->int_value)
-            {
-                token->type = CBOR_TOKEN_TYPE_ERROR;
-                token->error_message = "insufficient data";
-            }
-            else
-            {
-                token->type = cbor_internal_types_map[major_type];
-                token->bytes_value = token->pos; /* set data pointer */
-                token->pos += token->int_value; /* skip bytes */
-                return CBOR_TRUE;
-            }
-        }
-        break;
-    case 4: /* array */
-    case 5: /* map */
-    case 6: /* tag */
-        if (cbor_internal_read_int_value(minor_type, token))
-        {
-            token->type = cbor_internal_types_map[major_type];
-            return CBOR_TRUE;
-        }
-        break;
-    case 7: /* special */
-        if (cbor_internal_extract_special_value(minor_type, token))
-            return CBOR_TRUE;
-        break;
-    default:
-        token->type = CBOR_TOKEN_TYPE_ERROR;
-        token->error_message = "unknown error";
-        break;
-    }
-
-    token->pos = current_pos; /* restore original position */
-    return CBOR_FALSE;
-}
-
-CBOR_INLINE void cbor_internal_try_to_read_next(cbor_token_data_t *token)
-{
-    if (token->next_on_read)
-        cbor_internal_read_next(token);
-}
-
 cbor_bool_t cbor_init_read(cbor_token_t *token, const uint8_t *data, size_t data_size, cbor_bool_t next_on_read)
 {
     cbor_token_data_t *token_data = (cbor_token_data_t *)token;
 
-    token_data->type = CBOR_TOKEN_TYPE_END;
-    token_data->pos = data;
-    token_data->end = data + data_size;
+    cbor_internal_init_token(token_data, data, data + data_size);
     token_data->next_on_read = next_on_read;
 
     return cbor_internal_read_next(token_data);
@@ -403,7 +151,9 @@ cbor_bool_t cbor_read_string(cbor_token_t *token, char *buf, size_t buf_size)
     if (buf_size <= string_length) /* including null-terminating char */
         return CBOR_FALSE;
 
-    memcpy(buf, token_data->bytes_value, string_length);
+    if (cbor_internal_copy_payload(token_data, (uint8_t *)buf, string_length) == CBOR_FALSE)
+        return CBOR_FALSE;
+
     buf[string_length] = 0;
 
     cbor_internal_try_to_read_next(token_data);
@@ -422,7 +172,8 @@ cbor_bool_t cbor_read_raw_string(cbor_token_t *token, char *buf, size_t buf_size
     if (buf_size < string_length) /* without null-terminating char */
         return CBOR_FALSE;
 
-    memcpy(buf, token_data->bytes_value, string_length);
+    if (cbor_internal_copy_payload(token_data, (uint8_t *)buf, string_length) == CBOR_FALSE)
+        return CBOR_FALSE;
 
     cbor_internal_try_to_read_next(token_data);
     return CBOR_TRUE;
@@ -440,7 +191,8 @@ cbor_bool_t cbor_read_bytes(cbor_token_t *token, uint8_t *buf, size_t buf_size)
     if (buf_size < bytes_size)
         return CBOR_FALSE;
 
-    memcpy(buf, token_data->bytes_value, bytes_size);
+    if (cbor_internal_copy_payload(token_data, buf, bytes_size) == CBOR_FALSE)
+        return CBOR_FALSE;
 
     cbor_internal_try_to_read_next(token_data);
     return CBOR_TRUE;
@@ -497,3 +249,81 @@ cbor_bool_t cbor_read_special(cbor_token_t *token, uint8_t *value)
     cbor_internal_try_to_read_next(token_data);
     return CBOR_TRUE;
 }
+
+cbor_bool_t cbor_get_item_span(cbor_token_t *token, const uint8_t **item, size_t *item_size)
+{
+    cbor_token_data_t *token_data = (cbor_token_data_t *)token;
+    cbor_token_data_t nested_data = *token_data;
+
+    if (token_data->type == CBOR_TOKEN_TYPE_END || token_data->type == CBOR_TOKEN_TYPE_ERROR)
+        return CBOR_FALSE;
+
+    if (token_data->source != NULL)
+    {
+        token_data->type = CBOR_TOKEN_TYPE_ERROR;
+        token_data->error_message = "spans aren't supported by sources"; /* window is moved by refills */
+        return CBOR_FALSE;
+    }
+
+    if (cbor_internal_skip_nested(&nested_data) == CBOR_FALSE)
+    {
+        token_data->type = CBOR_TOKEN_TYPE_ERROR;
+        token_data->error_message = nested_data.error_message;
+        return CBOR_FALSE;
+    }
+
+    *item = token_data->start;
+    *item_size = (size_t)(nested_data.pos - token_data->start);
+
+    /* don't read next */
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_skip(cbor_token_t *token)
+{
+    cbor_token_data_t *token_data = (cbor_token_data_t *)token;
+
+    if (token_data->type == CBOR_TOKEN_TYPE_END)
+        return CBOR_FALSE;
+
+    if (cbor_internal_skip_nested(token_data) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    cbor_internal_try_to_read_next(token_data);
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_is_truncated(const uint8_t *data, size_t size)
+{
+    cbor_token_data_t token;
+    const uint8_t *pos;
+    unsigned int major_type;
+    int width;
+
+    if (size == 0)
+        return CBOR_FALSE;
+
+    cbor_internal_init_token(&token, data, data + size);
+    if (cbor_internal_read_next(&token) && cbor_internal_skip_nested(&token))
+        return CBOR_FALSE; /* complete */
+
+    /* failed reads leave the token on the item they stopped at, it's cut if its header or payload crosses the end */
+    pos = token.pos;
+    if (pos == token.end)
+        return CBOR_TRUE;
+
+    major_type = (unsigned int)(*pos >> 5);
+    width = cbor_internal_get_width(*pos & 31);
+    if (width < 0)
+        return CBOR_FALSE; /* malformed */
+    if ((size_t)(token.end - pos - 1) < (size_t)width)
+        return CBOR_TRUE;
+    if (major_type != 2 && major_type != 3)
+        return CBOR_FALSE;
+
+    cbor_internal_init_token(&token, pos + 1, token.end);
+    if (cbor_internal_read_int_value(*pos & 31, &token) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    return token.int_value > (cbor_base_uint_t)(token.end - token.pos) ? CBOR_TRUE : CBOR_FALSE;
+}
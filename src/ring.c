@@ -0,0 +1,302 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#if defined(__linux__)
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* syscall */
+#endif
+#elif !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L /* clock_gettime and nanosleep */
+#endif
+
+#include <limits.h>
+#include <string.h>
+#include "cbor.h"
+#include "internal.h"
+#include "internal_atomic.h"
+
+/* records are aligned to 8 bytes: state, size of the slot after the header, message */
+#define CBOR_RING_RECORD_HEADER_SIZE 8
+#define CBOR_RING_EMPTY 0           /* the slot isn't committed yet */
+#define CBOR_RING_PADDING 0xFFFFFFFF /* the rest of data is skipped, states of messages are their sizes plus one */
+#define CBOR_RING_MAGIC 0x47524243
+
+#define CBOR_RING_HEAD(ring) ((volatile size_t *)(ring)->memory)
+#define CBOR_RING_TAIL(ring) ((volatile size_t *)((ring)->memory + CBOR_CACHE_LINE_SIZE))
+#define CBOR_RING_MESSAGES_SEQ(ring) ((volatile uint32_t *)((ring)->memory + 8))
+#define CBOR_RING_WRITERS_WAITING(ring) ((volatile uint32_t *)((ring)->memory + 12))
+#define CBOR_RING_SPACE_SEQ(ring) ((volatile uint32_t *)((ring)->memory + CBOR_CACHE_LINE_SIZE + 8))
+#define CBOR_RING_READER_WAITING(ring) ((volatile uint32_t *)((ring)->memory + CBOR_CACHE_LINE_SIZE + 12))
+#define CBOR_RING_SETTINGS(ring) ((uint32_t *)((ring)->memory + 2 * CBOR_CACHE_LINE_SIZE))
+#define CBOR_RING_STATE(record) ((volatile uint32_t *)(record))
+#define CBOR_RING_SLOT_SIZE(record) (((uint32_t *)(record))[1])
+
+static cbor_bool_t cbor_internal_attach_ring(cbor_ring_t *ring, void *memory, size_t capacity, cbor_bool_t multi_producer)
+{
+    ring->memory = (uint8_t *)memory;
+    ring->data = ring->memory + CBOR_RING_HEADER_SIZE;
+    ring->capacity = capacity;
+    ring->multi_producer = multi_producer;
+    ring->reserved = 0;
+    ring->message = NULL;
+    ring->record_size = 0;
+    ring->mapped_size = 0;
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_init_ring(cbor_ring_t *ring, void *memory, size_t size, cbor_bool_t multi_producer)
+{
+    size_t capacity = CBOR_RING_RECORD_HEADER_SIZE * 2;
+
+    if ((size_t)memory % 8 != 0 || size < CBOR_RING_HEADER_SIZE + capacity)
+        return CBOR_FALSE;
+
+    /* positions are mapped to data by masking */
+    while (capacity <= (size - CBOR_RING_HEADER_SIZE) / 2 && capacity <= 0x7FFFFFFF)
+        capacity *= 2;
+
+    memset(memory, 0, CBOR_RING_HEADER_SIZE + capacity);
+    cbor_internal_attach_ring(ring, memory, capacity, multi_producer);
+
+    CBOR_RING_SETTINGS(ring)[0] = CBOR_RING_MAGIC;
+    CBOR_RING_SETTINGS(ring)[1] = (uint32_t)capacity;
+    CBOR_RING_SETTINGS(ring)[2] = multi_producer ? 1 : 0;
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_attach_ring(cbor_ring_t *ring, void *memory, size_t size)
+{
+    const uint32_t *settings = (const uint32_t *)((const uint8_t *)memory + 2 * CBOR_CACHE_LINE_SIZE);
+
+    if ((size_t)memory % 8 != 0 || size < CBOR_RING_HEADER_SIZE || settings[0] != CBOR_RING_MAGIC ||
+        settings[1] > size - CBOR_RING_HEADER_SIZE)
+        return CBOR_FALSE;
+
+    /* same capacities as cbor_init_ring creates */
+    if (settings[1] < CBOR_RING_RECORD_HEADER_SIZE * 2 || (settings[1] & (settings[1] - 1)) != 0 || settings[2] > 1)
+        return CBOR_FALSE;
+
+    return cbor_internal_attach_ring(ring, memory, settings[1], settings[2] ? CBOR_TRUE : CBOR_FALSE);
+}
+
+/* size of the record at head, including the end of data skipped before it */
+CBOR_INLINE size_t cbor_internal_get_needed_size(const cbor_ring_t *ring, size_t head, size_t slot_size)
+{
+    size_t offset = head & (ring->capacity - 1);
+    size_t needed = CBOR_RING_RECORD_HEADER_SIZE + slot_size;
+
+    /* a message doesn't wrap, the end of data is skipped instead */
+    if (needed > ring->capacity - offset)
+        needed += ring->capacity - offset;
+
+    return needed;
+}
+
+uint8_t *cbor_ring_reserve(cbor_ring_t *ring, size_t size)
+{
+    size_t slot_size = (size + 7) & ~(size_t)7;
+    size_t head;
+    size_t offset;
+    size_t needed;
+    uint8_t *record;
+
+    if (size > ring->capacity - CBOR_RING_RECORD_HEADER_SIZE)
+        return NULL;
+
+    for (;;)
+    {
+        head = cbor_internal_load_acquire(CBOR_RING_HEAD(ring));
+        offset = head & (ring->capacity - 1);
+        needed = cbor_internal_get_needed_size(ring, head, slot_size);
+
+        if (needed > ring->capacity - (head - cbor_internal_load_acquire(CBOR_RING_TAIL(ring))))
+            return NULL;
+
+        /* producers compete for the head, a single producer moves it on commit */
+        if (ring->multi_producer == CBOR_FALSE || cbor_internal_compare_exchange(CBOR_RING_HEAD(ring), head, head + needed))
+            break;
+    }
+
+    if (needed > CBOR_RING_RECORD_HEADER_SIZE + slot_size)
+    {
+        cbor_internal_store_release_32(CBOR_RING_STATE(ring->data + offset), CBOR_RING_PADDING);
+        offset = 0;
+    }
+
+    record = ring->data + offset;
+    CBOR_RING_SLOT_SIZE(record) = (uint32_t)slot_size;
+    if (ring->multi_producer == CBOR_FALSE)
+        ring->reserved = head + needed;
+
+    return record + CBOR_RING_RECORD_HEADER_SIZE;
+}
+
+void cbor_ring_commit(cbor_ring_t *ring, uint8_t *message, const uint8_t *end)
+{
+    uint8_t *record = message - CBOR_RING_RECORD_HEADER_SIZE;
+
+    cbor_internal_store_release_32(CBOR_RING_STATE(record), (uint32_t)(end - message) + 1);
+
+    if (ring->multi_producer == CBOR_FALSE)
+        cbor_internal_store_release(CBOR_RING_HEAD(ring), ring->reserved);
+}
+
+cbor_bool_t cbor_ring_peek(cbor_ring_t *ring, const uint8_t **message, size_t *message_size)
+{
+    size_t tail;
+    size_t offset;
+    uint32_t state;
+    uint32_t slot_size;
+
+    for (;;)
+    {
+        tail = *CBOR_RING_TAIL(ring); /* written by this consumer only */
+        offset = tail & (ring->capacity - 1);
+
+        if (offset % 8 != 0)
+            return CBOR_FALSE;
+
+        if (ring->multi_producer == CBOR_FALSE && tail == cbor_internal_load_acquire(CBOR_RING_HEAD(ring)))
+            return CBOR_FALSE;
+
+        /* with many producers, reserved records are committed out of order */
+        state = cbor_internal_load_acquire_32(CBOR_RING_STATE(ring->data + offset));
+        if (state == CBOR_RING_EMPTY)
+            return CBOR_FALSE;
+
+        if (state != CBOR_RING_PADDING)
+            break;
+
+        *CBOR_RING_STATE(ring->data + offset) = CBOR_RING_EMPTY;
+        cbor_internal_store_release(CBOR_RING_TAIL(ring), tail + ring->capacity - offset);
+    }
+
+    /* records written by another process don't cross the end of data */
+    slot_size = CBOR_RING_SLOT_SIZE(ring->data + offset);
+    if (slot_size % 8 != 0 || slot_size > ring->capacity - offset - CBOR_RING_RECORD_HEADER_SIZE || state - 1 > slot_size)
+        return CBOR_FALSE;
+
+    ring->message = ring->data + offset;
+    ring->record_size = CBOR_RING_RECORD_HEADER_SIZE + slot_size;
+    *message = ring->message + CBOR_RING_RECORD_HEADER_SIZE;
+    *message_size = state - 1;
+    return CBOR_TRUE;
+}
+
+void cbor_ring_release(cbor_ring_t *ring)
+{
+    size_t record_size = ring->record_size;
+
+    if (ring->message == NULL)
+        return;
+
+    /* free data is zeroed for producers, any position can be a state of a record later */
+    if (ring->multi_producer)
+        memset(ring->message, 0, record_size);
+    else
+        *CBOR_RING_STATE(ring->message) = CBOR_RING_EMPTY;
+
+    cbor_internal_store_release(CBOR_RING_TAIL(ring), *CBOR_RING_TAIL(ring) + record_size);
+    ring->message = NULL;
+}
+
+cbor_bool_t cbor_ring_wait_message(cbor_ring_t *ring, long timeout)
+{
+    long deadline = cbor_internal_get_milliseconds() + timeout;
+    long left = timeout;
+    const uint8_t *message;
+    size_t message_size;
+    uint32_t seq;
+    cbor_bool_t result;
+
+    cbor_internal_store_release_32(CBOR_RING_READER_WAITING(ring), 1);
+
+    for (;;)
+    {
+        /* either the producer sees the waiting reader or the reader sees the message */
+        cbor_internal_fence();
+        seq = cbor_internal_load_acquire_32(CBOR_RING_MESSAGES_SEQ(ring));
+
+        result = cbor_ring_peek(ring, &message, &message_size);
+        if (result || (timeout >= 0 && (left = deadline - cbor_internal_get_milliseconds()) <= 0))
+            break;
+
+        cbor_internal_wait_32(CBOR_RING_MESSAGES_SEQ(ring), seq, timeout >= 0 ? left : -1);
+    }
+
+    cbor_internal_store_release_32(CBOR_RING_READER_WAITING(ring), 0);
+    return result;
+}
+
+void cbor_ring_wake_reader(cbor_ring_t *ring)
+{
+    cbor_internal_fence();
+
+    if (cbor_internal_load_acquire_32(CBOR_RING_READER_WAITING(ring)))
+    {
+        cbor_internal_add_32(CBOR_RING_MESSAGES_SEQ(ring), 1);
+        cbor_internal_wake_32(CBOR_RING_MESSAGES_SEQ(ring), 1);
+    }
+}
+
+cbor_bool_t cbor_ring_wait_space(cbor_ring_t *ring, size_t size, long timeout)
+{
+    size_t slot_size = (size + 7) & ~(size_t)7;
+    long deadline = cbor_internal_get_milliseconds() + timeout;
+    long left = timeout;
+    size_t head;
+    uint32_t seq;
+    cbor_bool_t result;
+
+    if (size > ring->capacity - CBOR_RING_RECORD_HEADER_SIZE)
+        return CBOR_FALSE;
+
+    cbor_internal_add_32(CBOR_RING_WRITERS_WAITING(ring), 1);
+
+    for (;;)
+    {
+        cbor_internal_fence();
+        seq = cbor_internal_load_acquire_32(CBOR_RING_SPACE_SEQ(ring));
+
+        head = cbor_internal_load_acquire(CBOR_RING_HEAD(ring));
+        result = cbor_internal_get_needed_size(ring, head, slot_size) <=
+                 ring->capacity - (head - cbor_internal_load_acquire(CBOR_RING_TAIL(ring))) ? CBOR_TRUE : CBOR_FALSE;
+        if (result || (timeout >= 0 && (left = deadline - cbor_internal_get_milliseconds()) <= 0))
+            break;
+
+        cbor_internal_wait_32(CBOR_RING_SPACE_SEQ(ring), seq, timeout >= 0 ? left : -1);
+    }
+
+    cbor_internal_add_32(CBOR_RING_WRITERS_WAITING(ring), (uint32_t)-1);
+    return result;
+}
+
+void cbor_ring_wake_writers(cbor_ring_t *ring)
+{
+    cbor_internal_fence();
+
+    if (cbor_internal_load_acquire_32(CBOR_RING_WRITERS_WAITING(ring)))
+    {
+        cbor_internal_add_32(CBOR_RING_SPACE_SEQ(ring), 1);
+        cbor_internal_wake_32(CBOR_RING_SPACE_SEQ(ring), INT_MAX);
+    }
+}
@@ -0,0 +1,148 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <string.h>
+#include "cbor.h"
+#include "internal.h"
+
+CBOR_INLINE cbor_bool_t cbor_internal_match_predicate(const cbor_predicate_t *predicate, const cbor_token_data_t *token)
+{
+    switch (predicate->type)
+    {
+    case CBOR_PREDICATE_EXISTS:
+        return CBOR_TRUE;
+    case CBOR_PREDICATE_INT_EQUAL:
+    case CBOR_PREDICATE_INT_RANGE:
+        {
+            cbor_base_int_t value;
+            cbor_base_int_t max_value = predicate->type == CBOR_PREDICATE_INT_EQUAL ? predicate->min_value : predicate->max_value;
+
+            if (token->type != CBOR_TOKEN_TYPE_PINT && token->type != CBOR_TOKEN_TYPE_NINT)
+                return CBOR_FALSE;
+            if (CBOR_GET_PINT(token) > ((cbor_base_uint_t)-1 >> 1))
+                return CBOR_FALSE; /* out of range of any predicate */
+
+            value = token->type == CBOR_TOKEN_TYPE_PINT ? (cbor_base_int_t)CBOR_GET_PINT(token) : CBOR_GET_NINT(token);
+            return (value >= predicate->min_value && value <= max_value) ? CBOR_TRUE : CBOR_FALSE;
+        }
+    case CBOR_PREDICATE_STRING_PREFIX:
+        {
+            size_t prefix_length = strlen(predicate->prefix);
+
+            if (token->type != CBOR_TOKEN_TYPE_STRING || CBOR_GET_STRING_LENGTH(token) < prefix_length)
+                return CBOR_FALSE;
+
+            return memcmp(CBOR_GET_STRING(token), predicate->prefix, prefix_length) == 0 ? CBOR_TRUE : CBOR_FALSE;
+        }
+    }
+
+    return CBOR_FALSE;
+}
+
+/* the token is left on the last nested item of the record */
+CBOR_INLINE cbor_bool_t cbor_internal_scan_record(cbor_token_data_t *token, const cbor_predicate_t *predicates, size_t predicates_count,
+                                                  cbor_bool_t *matched)
+{
+    uint32_t all_matched = (predicates_count == 32) ? 0xFFFFFFFF : (((uint32_t)1 << predicates_count) - 1);
+    uint32_t matched_mask = 0;
+    cbor_bool_t rejected = CBOR_FALSE;
+    cbor_base_uint_t items_count;
+    cbor_base_uint_t i;
+    size_t j;
+
+    *matched = CBOR_FALSE;
+
+    if (token->type != CBOR_TOKEN_TYPE_MAP)
+        return cbor_internal_skip_nested(token); /* only maps can match */
+
+    items_count = CBOR_GET_MAP(token);
+    for (i = 0; i < items_count; ++i)
+    {
+        uint32_t key_mask = 0;
+
+        if (cbor_internal_read_nested(token) == CBOR_FALSE)
+            return CBOR_FALSE;
+
+        if (rejected == CBOR_FALSE && token->type == CBOR_TOKEN_TYPE_STRING)
+        {
+            const char *key = CBOR_GET_STRING(token);
+            size_t key_length = (size_t)CBOR_GET_STRING_LENGTH(token);
+
+            for (j = 0; j < predicates_count; ++j)
+            {
+                if (cbor_internal_match_name(predicates[j].key, key, key_length))
+                    key_mask |= (uint32_t)1 << j;
+            }
+        }
+        else if (cbor_internal_skip_nested(token) == CBOR_FALSE)
+            return CBOR_FALSE;
+
+        if (cbor_internal_read_nested(token) == CBOR_FALSE)
+            return CBOR_FALSE;
+
+        for (j = 0; key_mask != 0; ++j, key_mask >>= 1)
+        {
+            if ((key_mask & 1) == 0)
+                continue;
+
+            if (cbor_internal_match_predicate(&predicates[j], token))
+                matched_mask |= (uint32_t)1 << j;
+            else
+                rejected = CBOR_TRUE; /* the rest of the record is skipped without comparisons */
+        }
+
+        if (cbor_internal_skip_nested(token) == CBOR_FALSE)
+            return CBOR_FALSE;
+    }
+
+    *matched = (rejected == CBOR_FALSE && matched_mask == all_matched) ? CBOR_TRUE : CBOR_FALSE;
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_scan(const uint8_t *data, size_t data_size, size_t *pos, const cbor_predicate_t *predicates, size_t predicates_count,
+                      size_t *offsets, size_t *offsets_count)
+{
+    size_t max_offsets_count = *offsets_count;
+    cbor_token_data_t token;
+
+    *offsets_count = 0;
+
+    if (predicates_count > CBOR_MAX_PREDICATES)
+        return CBOR_FALSE;
+
+    cbor_internal_init_token(&token, data + *pos, data + data_size);
+
+    while (*offsets_count < max_offsets_count && cbor_internal_read_next(&token))
+    {
+        cbor_bool_t matched;
+
+        if (cbor_internal_scan_record(&token, predicates, predicates_count, &matched) == CBOR_FALSE)
+            return CBOR_FALSE; /* position is left on the malformed record */
+
+        if (matched)
+            offsets[(*offsets_count)++] = *pos;
+
+        *pos = (size_t)(token.pos - data);
+    }
+
+    return token.type != CBOR_TOKEN_TYPE_ERROR ? CBOR_TRUE : CBOR_FALSE;
+}
@@ -0,0 +1,146 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#if defined(__linux__)
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* syscall */
+#endif
+#elif !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L /* shm_open and ftruncate */
+#endif
+
+#include <stdio.h>
+#include "cbor.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+/* anonymous shared memory, only descriptors refer to it */
+static int cbor_internal_create_shared_memory(size_t size)
+{
+    int fd;
+
+#if defined(__linux__) && defined(__NR_memfd_create)
+    fd = (int)syscall(__NR_memfd_create, "cborphine-ring", 1 /* MFD_CLOEXEC */);
+#else
+    static unsigned int counter = 0;
+    char name[64];
+
+    sprintf(name, "/cborphine-%ld-%u", (long)getpid(), counter++);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0)
+        shm_unlink(name);
+#endif
+
+    if (fd >= 0 && ftruncate(fd, (off_t)size) != 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+
+    return fd;
+}
+
+static void *cbor_internal_map_shared_memory(int fd, size_t size)
+{
+    void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    return memory != MAP_FAILED ? memory : NULL;
+}
+
+cbor_bool_t cbor_create_shared_ring(cbor_ring_t *ring, size_t size, cbor_bool_t multi_producer, int *fd)
+{
+    void *memory;
+
+    *fd = cbor_internal_create_shared_memory(size);
+    if (*fd < 0)
+        return CBOR_FALSE;
+
+    memory = cbor_internal_map_shared_memory(*fd, size);
+    if (memory == NULL || cbor_init_ring(ring, memory, size, multi_producer) == CBOR_FALSE)
+    {
+        if (memory != NULL)
+            munmap(memory, size);
+        close(*fd);
+        *fd = -1;
+        return CBOR_FALSE;
+    }
+
+    ring->mapped_size = size;
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_open_shared_ring(cbor_ring_t *ring, int fd)
+{
+    struct stat info;
+    void *memory;
+
+    if (fstat(fd, &info) != 0 || info.st_size <= 0)
+        return CBOR_FALSE;
+
+    memory = cbor_internal_map_shared_memory(fd, (size_t)info.st_size);
+    if (memory == NULL)
+        return CBOR_FALSE;
+
+    if (cbor_attach_ring(ring, memory, (size_t)info.st_size) == CBOR_FALSE)
+    {
+        munmap(memory, (size_t)info.st_size);
+        return CBOR_FALSE;
+    }
+
+    ring->mapped_size = (size_t)info.st_size;
+    return CBOR_TRUE;
+}
+
+void cbor_close_shared_ring(cbor_ring_t *ring)
+{
+    if (ring->mapped_size != 0)
+        munmap(ring->memory, ring->mapped_size);
+
+    ring->memory = NULL;
+    ring->data = NULL;
+    ring->mapped_size = 0;
+}
+#else
+cbor_bool_t cbor_create_shared_ring(cbor_ring_t *ring, size_t size, cbor_bool_t multi_producer, int *fd)
+{
+    (void)ring; (void)size; (void)multi_producer;
+    *fd = -1;
+    return CBOR_FALSE; /* descriptors of shared memory aren't available */
+}
+
+cbor_bool_t cbor_open_shared_ring(cbor_ring_t *ring, int fd)
+{
+    (void)ring; (void)fd;
+    return CBOR_FALSE;
+}
+
+void cbor_close_shared_ring(cbor_ring_t *ring)
+{
+    (void)ring;
+}
+#endif
@@ -0,0 +1,163 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L /* write and pread */
+#endif
+
+#include <string.h>
+#include "cbor.h"
+#include "internal.h"
+#include "internal_io.h"
+
+void cbor_init_sink(cbor_sink_t *sink, int fd, uint8_t *buffer, size_t buffer_size)
+{
+    sink->fd = fd;
+    sink->buffer = buffer;
+    sink->pos = buffer;
+    sink->end = buffer + buffer_size;
+    sink->pending = buffer;
+}
+
+cbor_io_status_t cbor_sink_flush(cbor_sink_t *sink)
+{
+    size_t left;
+
+    while (sink->pending < sink->pos)
+    {
+        long count = cbor_internal_write(sink->fd, sink->pending, (size_t)(sink->pos - sink->pending));
+        if (count < 0)
+            return CBOR_IO_ERROR;
+        if (count == 0)
+            break;
+
+        sink->pending += count;
+    }
+
+    /* data left after a partial write is moved to the start to free space for next items */
+    left = (size_t)(sink->pos - sink->pending);
+    if (sink->pending != sink->buffer)
+    {
+        memmove(sink->buffer, sink->pending, left);
+        sink->pending = sink->buffer;
+        sink->pos = sink->buffer + left;
+    }
+
+    return left == 0 ? CBOR_IO_OK : CBOR_IO_AGAIN;
+}
+
+cbor_io_status_t cbor_sink_put(cbor_sink_t *sink, const void *data, size_t size, size_t *done)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+
+    while (*done < size)
+    {
+        size_t count = size - *done;
+
+        /* large payloads aren't copied when nothing is buffered */
+        if (sink->pos == sink->buffer && count >= (size_t)(sink->end - sink->buffer))
+        {
+            long written = cbor_internal_write(sink->fd, bytes + *done, count);
+            if (written < 0)
+                return CBOR_IO_ERROR;
+            if (written == 0)
+                return CBOR_IO_AGAIN;
+
+            *done += (size_t)written;
+            continue;
+        }
+
+        if (sink->pos == sink->end)
+        {
+            if (cbor_sink_flush(sink) == CBOR_IO_ERROR)
+                return CBOR_IO_ERROR;
+            if (sink->pos == sink->end)
+                return CBOR_IO_AGAIN;
+            continue;
+        }
+
+        if (count > (size_t)(sink->end - sink->pos))
+            count = (size_t)(sink->end - sink->pos);
+
+        memcpy(sink->pos, bytes + *done, count);
+        sink->pos += count;
+        *done += count;
+    }
+
+    return CBOR_IO_OK;
+}
+
+/* file data is copied through the buffer if the kernel can't send it */
+static cbor_io_status_t cbor_internal_copy_file(cbor_sink_t *sink, int file_fd, cbor_base_uint_t offset, size_t size, size_t *done)
+{
+    while (*done < size)
+    {
+        size_t count = size - *done;
+        long received;
+
+        if (sink->pos == sink->end)
+        {
+            if (cbor_sink_flush(sink) == CBOR_IO_ERROR)
+                return CBOR_IO_ERROR;
+            if (sink->pos == sink->end)
+                return CBOR_IO_AGAIN;
+        }
+
+        if (count > (size_t)(sink->end - sink->pos))
+            count = (size_t)(sink->end - sink->pos);
+
+        received = cbor_internal_read_at(file_fd, sink->pos, count, offset + *done);
+        if (received <= 0)
+            return CBOR_IO_ERROR;
+
+        sink->pos += received;
+        *done += (size_t)received;
+    }
+
+    return CBOR_IO_OK;
+}
+
+cbor_io_status_t cbor_sink_put_file(cbor_sink_t *sink, int file_fd, cbor_base_uint_t offset, size_t size, size_t *done)
+{
+    while (*done < size)
+    {
+        cbor_io_status_t status;
+        long count;
+
+        /* buffered data goes first */
+        status = cbor_sink_flush(sink);
+        if (status != CBOR_IO_OK)
+            return status;
+
+        count = cbor_internal_send_file(sink->fd, file_fd, offset + *done, size - *done);
+        if (count == CBOR_INTERNAL_UNSUPPORTED)
+            return cbor_internal_copy_file(sink, file_fd, offset, size, done);
+        if (count < 0)
+            return CBOR_IO_ERROR;
+        if (count == 0)
+            return CBOR_IO_AGAIN;
+
+        *done += (size_t)count;
+    }
+
+    return CBOR_IO_OK;
+}
@@ -0,0 +1,323 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L /* read */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include "cbor.h"
+#include "internal.h"
+#include "internal_io.h"
+
+#define CBOR_MAX_HEADER_SIZE 9
+
+/* continues with the next non-empty fragment in place */
+static cbor_bool_t cbor_internal_next_fragment(cbor_token_data_t *token)
+{
+    cbor_source_t *source = token->source;
+
+    while (source->iovec_index < source->iovecs_count)
+    {
+        const cbor_iovec_t *iovec = &source->iovecs[source->iovec_index++];
+        size_t offset = source->iovec_offset;
+
+        source->iovec_offset = 0;
+
+        if (iovec->size > offset)
+        {
+            token->pos = (const uint8_t *)iovec->base + offset;
+            token->end = (const uint8_t *)iovec->base + iovec->size;
+            return CBOR_TRUE;
+        }
+    }
+
+    return CBOR_FALSE;
+}
+
+/* copies unread data and the start of following fragments to the window until size bytes are available */
+static cbor_bool_t cbor_internal_stitch_fragments(cbor_token_data_t *token, size_t size)
+{
+    cbor_source_t *source = token->source;
+    size_t available = (size_t)(token->end - token->pos);
+
+    if (available == 0 && cbor_internal_next_fragment(token))
+    {
+        available = (size_t)(token->end - token->pos);
+        if (available >= size)
+            return CBOR_TRUE;
+    }
+
+    if (size > source->window_size)
+        return CBOR_FALSE;
+
+    memmove(source->window, token->pos, available);
+    token->pos = source->window;
+
+    while (available < size && source->iovec_index < source->iovecs_count)
+    {
+        const cbor_iovec_t *iovec = &source->iovecs[source->iovec_index];
+        size_t count = iovec->size - source->iovec_offset;
+
+        if (count > size - available)
+            count = size - available;
+
+        memcpy(source->window + available, (const uint8_t *)iovec->base + source->iovec_offset, count);
+        available += count;
+        source->iovec_offset += count;
+
+        if (source->iovec_offset == iovec->size)
+        {
+            ++source->iovec_index;
+            source->iovec_offset = 0;
+        }
+    }
+
+    token->end = source->window + available;
+    return available >= size ? CBOR_TRUE : CBOR_FALSE;
+}
+
+/* moves unread data to the start of the window and refills it until size bytes are available */
+static cbor_bool_t cbor_internal_fill_source(cbor_token_data_t *token, size_t size)
+{
+    cbor_source_t *source = token->source;
+    size_t available = (size_t)(token->end - token->pos);
+
+    if (available >= size)
+        return CBOR_TRUE;
+
+    if (source->refill == NULL)
+        return cbor_internal_stitch_fragments(token, size);
+
+    if (source->eof || size > source->window_size)
+        return CBOR_FALSE;
+
+    memmove(source->window, token->pos, available);
+    token->pos = source->window;
+    source->failure = 0;
+
+    while (available < size && source->eof == CBOR_FALSE)
+    {
+        size_t count = source->refill(source->ctx, source->window + available, source->window_size - available);
+
+        if (count == CBOR_REFILL_AGAIN || count == CBOR_REFILL_ERROR)
+        {
+            source->failure = count;
+            break;
+        }
+
+        if (count == 0)
+            source->eof = CBOR_TRUE;
+
+        available += count;
+    }
+
+    token->end = source->window + available;
+    return available >= size ? CBOR_TRUE : CBOR_FALSE;
+}
+
+/* reports a failed refill, missing data at the end of input is reported only if required */
+static cbor_bool_t cbor_internal_fail_source(cbor_token_data_t *token, cbor_bool_t required)
+{
+    switch (token->source->failure)
+    {
+    case CBOR_REFILL_AGAIN:
+        token->error_message = "input would block";
+        break;
+    case CBOR_REFILL_ERROR:
+        token->error_message = "input error";
+        break;
+    default:
+        if (required == CBOR_FALSE)
+            return CBOR_FALSE;
+        token->error_message = "insufficient data";
+        break;
+    }
+
+    token->type = CBOR_TOKEN_TYPE_ERROR;
+    return CBOR_FALSE;
+}
+
+/* consumes up to size bytes of the streamed payload, FALSE on the end of input */
+static cbor_bool_t cbor_internal_next_chunk(cbor_token_data_t *token, size_t size, const uint8_t **chunk, size_t *chunk_size)
+{
+    cbor_source_t *source = token->source;
+
+    if (token->pos == token->end && cbor_internal_fill_source(token, 1) == CBOR_FALSE)
+        return cbor_internal_fail_source(token, CBOR_TRUE);
+
+    *chunk = token->pos;
+    *chunk_size = (size_t)(token->end - token->pos);
+    if (*chunk_size > size)
+        *chunk_size = size;
+    if (*chunk_size > source->left)
+        *chunk_size = (size_t)source->left;
+
+    token->pos += *chunk_size;
+    source->left -= *chunk_size;
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_internal_prepare_source(cbor_token_data_t *token)
+{
+    const uint8_t *chunk;
+    size_t chunk_size;
+
+    int width;
+
+    /* the rest of a streamed payload is skipped */
+    while (token->source->left > 0)
+    {
+        if (cbor_internal_next_chunk(token, (size_t)-1, &chunk, &chunk_size) == CBOR_FALSE)
+            return CBOR_FALSE;
+    }
+
+    /* headers are never split, missing bytes at the end of input are reported by decoding */
+    if (cbor_internal_fill_source(token, 1) && (width = cbor_internal_get_width(CBOR_GET_MINOR_TYPE(*token->pos))) > 0)
+        cbor_internal_fill_source(token, 1 + (size_t)width);
+
+    if (token->source->failure != 0)
+        return cbor_internal_fail_source(token, CBOR_FALSE);
+
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_internal_fill_payload(cbor_token_data_t *token)
+{
+    /* strings are read in place if possible */
+    if (token->int_value > (size_t)(token->end - token->pos) && token->int_value > token->source->window_size)
+    {
+        token->source->left = token->int_value;
+        token->bytes_value = NULL;
+        return CBOR_TRUE;
+    }
+
+    if (cbor_internal_fill_source(token, (size_t)token->int_value) == CBOR_FALSE)
+        return cbor_internal_fail_source(token, CBOR_FALSE);
+
+    token->bytes_value = token->pos;
+    token->pos += token->int_value;
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_internal_copy_streamed_payload(cbor_token_data_t *token, uint8_t *dest, size_t size)
+{
+    const uint8_t *chunk;
+    size_t chunk_size;
+
+    while (size > 0)
+    {
+        if (cbor_internal_next_chunk(token, size, &chunk, &chunk_size) == CBOR_FALSE)
+            return CBOR_FALSE;
+
+        memcpy(dest, chunk, chunk_size);
+        dest += chunk_size;
+        size -= chunk_size;
+    }
+
+    return CBOR_TRUE;
+}
+
+static cbor_bool_t cbor_internal_init_source(cbor_token_data_t *token, cbor_source_t *source,
+                                             uint8_t *window, size_t window_size, cbor_bool_t next_on_read)
+{
+    source->window = window;
+    source->window_size = window_size;
+    source->left = 0;
+    source->failure = 0;
+    source->eof = CBOR_FALSE;
+
+    cbor_internal_init_token(token, window, window);
+    token->next_on_read = next_on_read;
+
+    if (window_size < CBOR_MAX_HEADER_SIZE)
+    {
+        token->type = CBOR_TOKEN_TYPE_ERROR;
+        token->error_message = "insufficient window size";
+        return CBOR_FALSE;
+    }
+
+    token->source = source;
+    return cbor_internal_read_next(token);
+}
+
+cbor_bool_t cbor_init_read_source(cbor_token_t *token, cbor_source_t *source, cbor_refill_t refill, void *ctx,
+                                  uint8_t *window, size_t window_size, cbor_bool_t next_on_read)
+{
+    source->refill = refill;
+    source->ctx = ctx;
+    source->iovecs = NULL;
+    source->iovecs_count = 0;
+    source->iovec_index = 0;
+    source->iovec_offset = 0;
+
+    return cbor_internal_init_source((cbor_token_data_t *)token, source, window, window_size, next_on_read);
+}
+
+cbor_bool_t cbor_init_read_iovecs(cbor_token_t *token, cbor_source_t *source, const cbor_iovec_t *iovecs, size_t iovecs_count,
+                                  uint8_t *window, size_t window_size, cbor_bool_t next_on_read)
+{
+    source->refill = NULL;
+    source->ctx = NULL;
+    source->iovecs = iovecs;
+    source->iovecs_count = iovecs_count;
+    source->iovec_index = 0;
+    source->iovec_offset = 0;
+
+    return cbor_internal_init_source((cbor_token_data_t *)token, source, window, window_size, next_on_read);
+}
+
+cbor_bool_t cbor_read_source_chunk(cbor_token_t *token, const uint8_t **chunk, size_t *chunk_size)
+{
+    cbor_token_data_t *token_data = (cbor_token_data_t *)token;
+
+    if (token_data->source == NULL || token_data->source->left == 0 ||
+        (token_data->type != CBOR_TOKEN_TYPE_STRING && token_data->type != CBOR_TOKEN_TYPE_BYTES))
+        return CBOR_FALSE;
+
+    /* don't read next, the caller reads the next item explicitly */
+    return cbor_internal_next_chunk(token_data, (size_t)-1, chunk, chunk_size);
+}
+
+size_t cbor_refill_file(void *ctx, uint8_t *data, size_t size)
+{
+    size_t count = fread(data, 1, size, (FILE *)ctx);
+
+    if (count == 0 && ferror((FILE *)ctx))
+    {
+        clearerr((FILE *)ctx); /* the read may be retried */
+        return CBOR_REFILL_ERROR;
+    }
+
+    return count;
+}
+
+size_t cbor_refill_fd(void *ctx, uint8_t *data, size_t size)
+{
+    long count = cbor_internal_read(*(int *)ctx, data, size);
+
+    if (count == CBOR_INTERNAL_AGAIN)
+        return CBOR_REFILL_AGAIN;
+
+    return count >= 0 ? (size_t)count : CBOR_REFILL_ERROR;
+}
@@ -0,0 +1,164 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <string.h>
+#include "cbor.h"
+#include "internal.h"
+
+#define CBOR_STRING_STATE_HEADER       0
+#define CBOR_STRING_STATE_CHUNK_HEADER 1
+#define CBOR_STRING_STATE_PAYLOAD      2
+#define CBOR_STRING_STATE_DONE         3
+
+#define CBOR_INDEFINITE_LENGTH 31
+#define CBOR_BREAK 0xFF
+
+CBOR_INLINE cbor_string_status_t cbor_internal_string_error(cbor_string_reader_t *reader, const char *error_message)
+{
+    reader->state = CBOR_STRING_STATE_DONE;
+    reader->error_message = error_message;
+    return CBOR_STRING_ERROR;
+}
+
+/* collects the initial byte and the length, FALSE if more data is needed */
+static cbor_bool_t cbor_internal_collect_header(cbor_string_reader_t *reader, const uint8_t **data, size_t *size)
+{
+    size_t header_needed;
+
+    if (reader->header_size == 0)
+    {
+        if (*size == 0)
+            return CBOR_FALSE;
+
+        reader->header[reader->header_size++] = *(*data)++;
+        --*size;
+    }
+
+    header_needed = 1;
+    if (CBOR_GET_MINOR_TYPE(reader->header[0]) != CBOR_INDEFINITE_LENGTH &&
+        cbor_internal_get_width(CBOR_GET_MINOR_TYPE(reader->header[0])) > 0)
+        header_needed += (size_t)cbor_internal_get_width(CBOR_GET_MINOR_TYPE(reader->header[0]));
+
+    while (reader->header_size < header_needed)
+    {
+        if (*size == 0)
+            return CBOR_FALSE;
+
+        reader->header[reader->header_size++] = *(*data)++;
+        --*size;
+    }
+
+    return CBOR_TRUE;
+}
+
+/* CBOR_STRING_MORE means the payload or the next chunk follows */
+static cbor_string_status_t cbor_internal_parse_header(cbor_string_reader_t *reader)
+{
+    unsigned int major_type = CBOR_GET_MAJOR_TYPE(reader->header[0]);
+    unsigned int minor_type = CBOR_GET_MINOR_TYPE(reader->header[0]);
+    cbor_token_data_t token;
+
+    reader->header_size = 0;
+
+    if (reader->state == CBOR_STRING_STATE_CHUNK_HEADER)
+    {
+        if (reader->header[0] == CBOR_BREAK)
+        {
+            reader->state = CBOR_STRING_STATE_DONE;
+            return CBOR_STRING_END;
+        }
+
+        /* chunks are definite length strings of the same type */
+        if (major_type != reader->type || minor_type == CBOR_INDEFINITE_LENGTH)
+            return cbor_internal_string_error(reader, "invalid chunk type");
+    }
+    else
+    {
+        if (major_type != 2 && major_type != 3)
+            return cbor_internal_string_error(reader, "invalid data type");
+
+        reader->type = major_type;
+        if (minor_type == CBOR_INDEFINITE_LENGTH)
+        {
+            reader->indefinite = CBOR_TRUE;
+            reader->state = CBOR_STRING_STATE_CHUNK_HEADER;
+            return CBOR_STRING_MORE;
+        }
+    }
+
+    token.pos = reader->header + 1;
+    token.end = reader->header + 9;
+    if (cbor_internal_read_int_value(minor_type, &token) == CBOR_FALSE)
+        return cbor_internal_string_error(reader, token.error_message);
+
+    reader->left = token.int_value;
+    reader->state = CBOR_STRING_STATE_PAYLOAD;
+    return CBOR_STRING_MORE;
+}
+
+void cbor_init_string_reader(cbor_string_reader_t *reader)
+{
+    memset(reader, 0, sizeof(*reader));
+    reader->state = CBOR_STRING_STATE_HEADER;
+}
+
+cbor_string_status_t cbor_read_string_chunk(cbor_string_reader_t *reader, const uint8_t **data, size_t *size,
+                                            const uint8_t **chunk, size_t *chunk_size)
+{
+    cbor_string_status_t status;
+
+    for (;;)
+    {
+        switch (reader->state)
+        {
+        case CBOR_STRING_STATE_HEADER:
+        case CBOR_STRING_STATE_CHUNK_HEADER:
+            if (cbor_internal_collect_header(reader, data, size) == CBOR_FALSE)
+                return CBOR_STRING_MORE;
+
+            status = cbor_internal_parse_header(reader);
+            if (status != CBOR_STRING_MORE)
+                return status;
+            break;
+        case CBOR_STRING_STATE_PAYLOAD:
+            if (reader->left == 0)
+            {
+                reader->state = reader->indefinite ? CBOR_STRING_STATE_CHUNK_HEADER : CBOR_STRING_STATE_DONE;
+                break;
+            }
+
+            if (*size == 0)
+                return CBOR_STRING_MORE;
+
+            /* payload is passed through without copying */
+            *chunk = *data;
+            *chunk_size = reader->left < *size ? (size_t)reader->left : *size;
+
+            *data += *chunk_size;
+            *size -= *chunk_size;
+            reader->left -= *chunk_size;
+            return CBOR_STRING_CHUNK;
+        default:
+            return reader->error_message != NULL ? CBOR_STRING_ERROR : CBOR_STRING_END;
+        }
+    }
+}
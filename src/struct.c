@@ -0,0 +1,261 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <string.h>
+#include "cbor.h"
+#include "internal.h"
+
+CBOR_INLINE size_t cbor_internal_hash_key(const char *key, size_t key_length)
+{
+    size_t hash = key_length;
+    size_t i;
+
+    for (i = 0; i < key_length; ++i)
+        hash = hash * 31 + (uint8_t)key[i];
+
+    return hash % CBOR_STRUCT_DISPATCH_SIZE;
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_match_key(const cbor_field_t *field, const char *key, size_t key_length)
+{
+    return cbor_internal_match_name(field->key, key, key_length);
+}
+
+CBOR_INLINE const cbor_field_t *cbor_internal_find_field(const cbor_struct_t *desc, size_t expected_index, const char *key, size_t key_length)
+{
+    size_t slot;
+
+    /* fields are usually written in order of descriptors */
+    if (expected_index < desc->fields_count && cbor_internal_match_key(&desc->fields[expected_index], key, key_length))
+        return &desc->fields[expected_index];
+
+    for (slot = cbor_internal_hash_key(key, key_length); desc->dispatch[slot] != 0; slot = (slot + 1) % CBOR_STRUCT_DISPATCH_SIZE)
+    {
+        const cbor_field_t *field = &desc->fields[desc->dispatch[slot] - 1];
+        if (cbor_internal_match_key(field, key, key_length))
+            return field;
+    }
+
+    return NULL;
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_decode_field(cbor_token_data_t *token, const cbor_field_t *field, uint8_t *value)
+{
+    uint8_t *dest = value + field->offset;
+
+    switch (field->type)
+    {
+    case CBOR_FIELD_TYPE_STRING:
+        {
+            size_t string_length;
+
+            if (cbor_internal_check_type(token, CBOR_TOKEN_TYPE_STRING) == CBOR_FALSE)
+                return CBOR_FALSE;
+
+            string_length = (size_t)CBOR_GET_STRING_LENGTH(token);
+            if (field->size <= string_length) /* including null-terminating char */
+                return cbor_internal_set_error(token, "insufficient buffer size");
+
+            if (cbor_internal_copy_payload(token, dest, string_length) == CBOR_FALSE)
+                return CBOR_FALSE;
+
+            dest[string_length] = 0;
+            return CBOR_TRUE;
+        }
+    case CBOR_FIELD_TYPE_BYTES:
+        {
+            size_t bytes_size;
+
+            if (cbor_internal_check_type(token, CBOR_TOKEN_TYPE_BYTES) == CBOR_FALSE)
+                return CBOR_FALSE;
+
+            bytes_size = (size_t)CBOR_GET_BYTES_SIZE(token);
+            if (field->size < bytes_size)
+                return cbor_internal_set_error(token, "insufficient buffer size");
+
+            if (cbor_internal_copy_payload(token, dest, bytes_size) == CBOR_FALSE)
+                return CBOR_FALSE;
+
+            memset(dest + bytes_size, 0, field->size - bytes_size);
+            return CBOR_TRUE;
+        }
+    default:
+        return cbor_internal_decode_scalar(token, field->type, field->size, dest);
+    }
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_encode_field(uint8_t **data, size_t size, const cbor_field_t *field, const uint8_t *value)
+{
+    const uint8_t *src = value + field->offset;
+
+    switch (field->type)
+    {
+    case CBOR_FIELD_TYPE_STRING:
+        return cbor_write_string(data, size, (const char *)src);
+    case CBOR_FIELD_TYPE_BYTES:
+        return cbor_write_bytes(data, size, src, field->size);
+    default:
+        return cbor_internal_encode_scalar(data, size, field->type, field->size, src);
+    }
+}
+
+cbor_bool_t cbor_init_struct(cbor_struct_t *desc, const cbor_field_t *fields, size_t fields_count, cbor_struct_layout_t layout)
+{
+    size_t i;
+
+    if (fields_count > CBOR_STRUCT_MAX_FIELDS)
+        return CBOR_FALSE;
+
+    /* values are never read or written past their size */
+    for (i = 0; i < fields_count; ++i)
+    {
+        if (cbor_internal_check_value_size(fields[i].type, fields[i].size) == CBOR_FALSE)
+            return CBOR_FALSE;
+    }
+
+    desc->fields = fields;
+    desc->fields_count = fields_count;
+    desc->layout = layout;
+    memset(desc->dispatch, 0, sizeof(desc->dispatch));
+
+    if (layout != CBOR_STRUCT_LAYOUT_MAP)
+        return CBOR_TRUE;
+
+    for (i = 0; i < fields_count; ++i)
+    {
+        size_t key_length = strlen(fields[i].key);
+        size_t slot = cbor_internal_hash_key(fields[i].key, key_length);
+
+        while (desc->dispatch[slot] != 0)
+        {
+            if (cbor_internal_match_key(&fields[desc->dispatch[slot] - 1], fields[i].key, key_length))
+                return CBOR_FALSE; /* duplicated key */
+
+            slot = (slot + 1) % CBOR_STRUCT_DISPATCH_SIZE;
+        }
+
+        desc->dispatch[slot] = (uint8_t)(i + 1);
+    }
+
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_encode_struct(uint8_t **data, size_t size, const cbor_struct_t *desc, const void *value)
+{
+    uint8_t *pos = *data;
+    uint8_t *end = *data + size;
+    size_t i;
+
+    if (desc->layout == CBOR_STRUCT_LAYOUT_MAP)
+    {
+        if (cbor_write_map(&pos, end - pos, desc->fields_count) == CBOR_FALSE)
+            return CBOR_FALSE;
+    }
+    else
+    {
+        if (cbor_write_array(&pos, end - pos, desc->fields_count) == CBOR_FALSE)
+            return CBOR_FALSE;
+    }
+
+    for (i = 0; i < desc->fields_count; ++i)
+    {
+        const cbor_field_t *field = &desc->fields[i];
+
+        if (desc->layout == CBOR_STRUCT_LAYOUT_MAP &&
+            cbor_write_string(&pos, end - pos, field->key) == CBOR_FALSE)
+            return CBOR_FALSE;
+
+        if (cbor_internal_encode_field(&pos, end - pos, field, (const uint8_t *)value) == CBOR_FALSE)
+            return CBOR_FALSE;
+    }
+
+    *data = pos; /* data is changed on success only */
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_decode_struct(cbor_token_t *token, const cbor_struct_t *desc, void *value)
+{
+    cbor_token_data_t *token_data = (cbor_token_data_t *)token;
+    cbor_base_uint_t items_count;
+    cbor_base_uint_t i;
+
+    if (desc->layout == CBOR_STRUCT_LAYOUT_MAP)
+    {
+        if (cbor_internal_check_type(token_data, CBOR_TOKEN_TYPE_MAP) == CBOR_FALSE)
+            return CBOR_FALSE;
+
+        items_count = CBOR_GET_MAP(token_data);
+        for (i = 0; i < items_count; ++i)
+        {
+            const cbor_field_t *field = NULL;
+
+            if (cbor_internal_read_nested(token_data) == CBOR_FALSE)
+                return CBOR_FALSE;
+
+            if (token_data->type == CBOR_TOKEN_TYPE_STRING)
+            {
+                if (CBOR_GET_STRING(token_data) == NULL)
+                    return cbor_internal_set_error(token_data, "key larger than window"); /* streamed */
+
+                field = cbor_internal_find_field(desc, (size_t)i, CBOR_GET_STRING(token_data),
+                                                 (size_t)CBOR_GET_STRING_LENGTH(token_data));
+            }
+            else if (cbor_internal_skip_nested(token_data) == CBOR_FALSE)
+                return CBOR_FALSE; /* keys of other types are never matched */
+
+            if (cbor_internal_read_nested(token_data) == CBOR_FALSE)
+                return CBOR_FALSE;
+
+            if (field)
+            {
+                if (cbor_internal_decode_field(token_data, field, (uint8_t *)value) == CBOR_FALSE)
+                    return CBOR_FALSE;
+            }
+            else if (cbor_internal_skip_nested(token_data) == CBOR_FALSE)
+                return CBOR_FALSE; /* unknown field */
+        }
+    }
+    else
+    {
+        if (cbor_internal_check_type(token_data, CBOR_TOKEN_TYPE_ARRAY) == CBOR_FALSE)
+            return CBOR_FALSE;
+
+        /* missing trailing fields are left unchanged, extra items are skipped */
+        items_count = CBOR_GET_ARRAY(token_data);
+        for (i = 0; i < items_count; ++i)
+        {
+            if (cbor_internal_read_nested(token_data) == CBOR_FALSE)
+                return CBOR_FALSE;
+
+            if (i < desc->fields_count)
+            {
+                if (cbor_internal_decode_field(token_data, &desc->fields[i], (uint8_t *)value) == CBOR_FALSE)
+                    return CBOR_FALSE;
+            }
+            else if (cbor_internal_skip_nested(token_data) == CBOR_FALSE)
+                return CBOR_FALSE;
+        }
+    }
+
+    cbor_internal_try_to_read_next(token_data);
+    return CBOR_TRUE;
+}
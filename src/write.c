@@ -24,13 +24,6 @@ THE SOFTWARE.
 #include "cbor.h"
 #include "internal.h"
 
-#define CBOR_MAX_INJECTED_LIMIT 24
-#define CBOR_MAX_1BYTE_LIMIT    256
-#define CBOR_MAX_2BYTE_LIMIT    65536
-#define CBOR_MAX_4BYTE_LIMIT    4294967296
-
-#define CBOR_CREATE_INITIAL_BYTE(major_type, minor_type) ((uint8_t) (((major_type) << 5) | (minor_type)))
-
 CBOR_INLINE cbor_bool_t cbor_internal_write_int_value(uint8_t **data, size_t size, unsigned int type, size_t check_bytes, cbor_base_uint_t value)
 {
     uint8_t *pos = *data;
@@ -100,6 +93,16 @@ CBOR_INLINE cbor_bool_t cbor_internal_write_int_value(uint8_t **data, size_t siz
 #endif
 }
 
+CBOR_INLINE cbor_bool_t cbor_internal_write_fixed_int_value(uint8_t **data, size_t size, unsigned int type, size_t width, cbor_base_uint_t value)
+{
+    if (cbor_internal_fits_width(value, width) == CBOR_FALSE || size < 1 + width)
+        return CBOR_FALSE;
+
+    cbor_internal_store_fixed_int_value(*data, type, width, value);
+    *data += 1 + width;
+    return CBOR_TRUE;
+}
+
 CBOR_INLINE cbor_bool_t cbor_internal_write_float_value(uint8_t **data, size_t size, size_t type_length, const uint8_t *value_bytes)
 {
     uint8_t *pos = *data;
@@ -198,6 +201,70 @@ cbor_bool_t cbor_write_bytes(uint8_t **data, size_t size, const uint8_t *bytes,
     return cbor_internal_write_bytes(data, size, 2, bytes_size, bytes);
 }
 
+cbor_bool_t cbor_write_string_header(uint8_t **data, size_t size, size_t str_length)
+{
+    return cbor_internal_write_int_value(data, size, 3, 0, str_length);
+}
+
+cbor_bool_t cbor_write_bytes_header(uint8_t **data, size_t size, size_t bytes_size)
+{
+    return cbor_internal_write_int_value(data, size, 2, 0, bytes_size);
+}
+
+CBOR_INLINE cbor_bool_t cbor_internal_reserve(uint8_t **data, size_t size, unsigned int type, size_t max_size, cbor_reservation_t *reservation)
+{
+    /* the header is wide enough for max_size, so the payload doesn't move unless compacted */
+    size_t width = cbor_internal_get_value_width(max_size);
+
+    if (size < 1 + width || size - 1 - width < max_size)
+        return CBOR_FALSE;
+
+    reservation->header = *data;
+    reservation->payload = *data + 1 + width;
+    reservation->max_size = max_size;
+    reservation->type = type;
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_write_string_reserve(uint8_t **data, size_t size, size_t max_length, cbor_reservation_t *reservation)
+{
+    return cbor_internal_reserve(data, size, 3, max_length, reservation);
+}
+
+cbor_bool_t cbor_write_bytes_reserve(uint8_t **data, size_t size, size_t max_size, cbor_reservation_t *reservation)
+{
+    return cbor_internal_reserve(data, size, 2, max_size, reservation);
+}
+
+cbor_bool_t cbor_write_commit(uint8_t **data, const cbor_reservation_t *reservation, size_t payload_size, cbor_bool_t compact)
+{
+    size_t width = (size_t)(reservation->payload - reservation->header) - 1;
+    uint8_t *pos = reservation->header;
+
+    if (payload_size > reservation->max_size)
+        return CBOR_FALSE;
+
+    if (compact)
+    {
+        /* the shortest header never exceeds the reserved one */
+        cbor_internal_write_int_value(&pos, 1 + width, reservation->type, 0, payload_size);
+        if (pos != reservation->payload)
+            memmove(pos, reservation->payload, payload_size);
+    }
+    else
+    {
+        if (width == 0)
+            *pos = CBOR_CREATE_INITIAL_BYTE(reservation->type, payload_size);
+        else
+            cbor_internal_store_fixed_int_value(pos, reservation->type, width, payload_size);
+
+        pos = reservation->payload;
+    }
+
+    *data = pos + payload_size;
+    return CBOR_TRUE;
+}
+
 cbor_bool_t cbor_write_array(uint8_t **data, size_t size, cbor_base_uint_t array_size)
 {
     return cbor_internal_write_int_value(data, size, 4, 0, array_size);
@@ -217,3 +284,87 @@ cbor_bool_t cbor_write_special(uint8_t **data, size_t size, uint8_t special)
 {
     return cbor_internal_write_int_value(data, size, 7, 0, special);
 }
+
+cbor_bool_t cbor_write_raw(uint8_t **data, size_t size, const uint8_t *raw, size_t raw_size)
+{
+    if (size < raw_size)
+        return CBOR_FALSE;
+
+    memcpy(*data, raw, raw_size);
+    *data += raw_size;
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_write_uint_fixed(uint8_t **data, size_t size, cbor_base_uint_t value, size_t width)
+{
+    return cbor_internal_write_fixed_int_value(data, size, 0, width, value);
+}
+
+cbor_bool_t cbor_write_int_fixed(uint8_t **data, size_t size, cbor_base_int_t value, size_t width)
+{
+    if (value < 0)
+        return cbor_internal_write_fixed_int_value(data, size, 1, width, (cbor_base_uint_t)(-(value + 1)));
+    else
+        return cbor_internal_write_fixed_int_value(data, size, 0, width, (cbor_base_uint_t)(value));
+}
+
+cbor_bool_t cbor_write_array_fixed(uint8_t **data, size_t size, cbor_base_uint_t array_size, size_t width)
+{
+    return cbor_internal_write_fixed_int_value(data, size, 4, width, array_size);
+}
+
+cbor_bool_t cbor_write_map_fixed(uint8_t **data, size_t size, cbor_base_uint_t map_size, size_t width)
+{
+    return cbor_internal_write_fixed_int_value(data, size, 5, width, map_size);
+}
+
+cbor_bool_t cbor_patch_uint(uint8_t *slot, cbor_base_uint_t value)
+{
+    unsigned int type = CBOR_GET_MAJOR_TYPE(*slot);
+    int width = cbor_internal_get_width(CBOR_GET_MINOR_TYPE(*slot));
+
+    /* negative integers and floats are never patched as unsigned values,
+       string lengths are not either since the payload follows the header */
+    if (type == 1 || type == 2 || type == 3 || type == 7)
+        return CBOR_FALSE;
+
+    if (width <= 0 || cbor_internal_fits_width(value, (size_t)width) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    cbor_internal_store_fixed_int_value(slot, type, (size_t)width, value);
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_patch_int(uint8_t *slot, cbor_base_int_t value)
+{
+    int width = cbor_internal_get_width(CBOR_GET_MINOR_TYPE(*slot));
+    unsigned int type = value < 0 ? 1 : 0;
+    cbor_base_uint_t uint_value = value < 0 ? (cbor_base_uint_t)(-(value + 1)) : (cbor_base_uint_t)value;
+
+    if (CBOR_GET_MAJOR_TYPE(*slot) > 1)
+        return CBOR_FALSE;
+
+    if (width <= 0 || cbor_internal_fits_width(uint_value, (size_t)width) == CBOR_FALSE)
+        return CBOR_FALSE;
+
+    cbor_internal_store_fixed_int_value(slot, type, (size_t)width, uint_value);
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_patch_float(uint8_t *slot, float value)
+{
+    if (*slot != CBOR_CREATE_INITIAL_BYTE(7, 26))
+        return CBOR_FALSE;
+
+    cbor_internal_swap_4bytes(slot + 1, (const uint8_t *)&value);
+    return CBOR_TRUE;
+}
+
+cbor_bool_t cbor_patch_double(uint8_t *slot, double value)
+{
+    if (*slot != CBOR_CREATE_INITIAL_BYTE(7, 27))
+        return CBOR_FALSE;
+
+    cbor_internal_swap_8bytes(slot + 1, (const uint8_t *)&value);
+    return CBOR_TRUE;
+}
@@ -0,0 +1,100 @@
+#include "cborphine-aggregate-test.h"
+
+void CborphineAggregateTest::SetUp()
+{
+    CborphineTest::SetUp();
+
+    // {"id": i, "latency_us": i % 100 or -1.5 or "n/a", "nested": {"latency_us": 1000000}}
+    _sequence.resize(1000 * 64);
+    uint8_t* data = &_sequence[0];
+    size_t size = _sequence.size();
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        ASSERT_EQ(CBOR_TRUE, cbor_write_map(&data, size, 3));
+        ASSERT_EQ(CBOR_TRUE, cbor_write_string(&data, size, "nested"));
+        ASSERT_EQ(CBOR_TRUE, cbor_write_map(&data, size, 1));
+        ASSERT_EQ(CBOR_TRUE, cbor_write_string(&data, size, "latency_us"));
+        ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&data, size, 1000000));
+        ASSERT_EQ(CBOR_TRUE, cbor_write_string(&data, size, "id"));
+        ASSERT_EQ(CBOR_TRUE, cbor_write_int(&data, size, i));
+        ASSERT_EQ(CBOR_TRUE, cbor_write_string(&data, size, "latency_us"));
+
+        if (i == 500)
+            ASSERT_EQ(CBOR_TRUE, cbor_write_double(&data, size, -1.5));
+        else if (i == 501)
+            ASSERT_EQ(CBOR_TRUE, cbor_write_string(&data, size, "n/a"));
+        else
+            ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&data, size, i % 100));
+    }
+
+    ASSERT_EQ(CBOR_TRUE, cbor_write_array(&data, size, 0)); // not a map
+    _sequence.resize(data - &_sequence[0]);
+}
+
+TEST_F(CborphineAggregateTest, AggregateField)
+{
+    cbor_stats_t stats;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_aggregate_field(&_sequence[0], _sequence.size(), "latency_us", &stats));
+    ASSERT_EQ(999u, stats.count);
+    ASSERT_DOUBLE_EQ(49500.0 - 0.0 - 1.0 - 1.5, stats.sum);
+    ASSERT_DOUBLE_EQ(-1.5, stats.min);
+    ASSERT_DOUBLE_EQ(99.0, stats.max);
+}
+
+TEST_F(CborphineAggregateTest, MissingField)
+{
+    cbor_stats_t stats;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_aggregate_field(&_sequence[0], _sequence.size(), "latency", &stats));
+    ASSERT_EQ(0u, stats.count);
+}
+
+TEST_F(CborphineAggregateTest, ParallelMatchesSequential)
+{
+    cbor_stats_t expected;
+    cbor_stats_t stats;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_aggregate_field(&_sequence[0], _sequence.size(), "id", &expected));
+
+    for (unsigned int threads = 1; threads <= 8; ++threads)
+    {
+        ASSERT_EQ(CBOR_TRUE, cbor_aggregate_field_parallel(&_sequence[0], _sequence.size(), "id", &stats, threads));
+        ASSERT_EQ(expected.count, stats.count);
+        ASSERT_DOUBLE_EQ(expected.sum, stats.sum);
+        ASSERT_DOUBLE_EQ(0.0, stats.min);
+        ASSERT_DOUBLE_EQ(999.0, stats.max);
+    }
+}
+
+TEST_F(CborphineAggregateTest, MalformedSequence)
+{
+    cbor_stats_t stats;
+
+    ASSERT_EQ(CBOR_FALSE, cbor_aggregate_field(&_sequence[0], _sequence.size() - 3, "id", &stats));
+    ASSERT_EQ(CBOR_FALSE, cbor_aggregate_field_parallel(&_sequence[0], _sequence.size() - 3, "id", &stats, 4));
+}
+
+TEST_F(CborphineAggregateTest, MalformedItemBeforeSplit)
+{
+    cbor_stats_t stats;
+
+    _sequence[1] = 0xff; // indefinite lengths are not supported
+    for (unsigned int threads = 2; threads <= 4; ++threads)
+        ASSERT_EQ(CBOR_FALSE, cbor_aggregate_field_parallel(&_sequence[0], _sequence.size(), "id", &stats, threads));
+}
+
+TEST_F(CborphineAggregateTest, FailureKeepsStats)
+{
+    cbor_stats_t stats;
+
+    memset(&stats, 0xAA, sizeof(stats));
+    for (unsigned int threads = 1; threads <= 4; ++threads)
+    {
+        ASSERT_EQ(CBOR_FALSE, cbor_aggregate_field_parallel(&_sequence[0], _sequence.size() - 3, "id", &stats, threads));
+
+        for (size_t i = 0; i < sizeof(stats); ++i)
+            ASSERT_EQ(0xAA, ((const uint8_t*)&stats)[i]);
+    }
+}
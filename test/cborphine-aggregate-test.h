@@ -0,0 +1,17 @@
+#ifndef CBORPHINE_AGGREGATE_TEST_H
+#define CBORPHINE_AGGREGATE_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineAggregateTest : public CborphineTest
+{
+public: // ::testing::Test
+
+    virtual void SetUp();
+
+protected:
+
+    std::vector<uint8_t> _sequence;
+};
+
+#endif // CBORPHINE_AGGREGATE_TEST_H
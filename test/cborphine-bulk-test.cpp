@@ -0,0 +1,103 @@
+#include "cborphine-bulk-test.h"
+
+void CborphineBulkTest::SetUp()
+{
+    CborphineTest::SetUp();
+
+    _file = tmpfile();
+    ASSERT_TRUE(_file != NULL);
+    _fd = fileno(_file);
+}
+
+void CborphineBulkTest::TearDown()
+{
+    fclose(_file);
+
+    CborphineTest::TearDown();
+}
+
+std::vector<uint8_t> CborphineBulkTest::encodeSequence(size_t count)
+{
+    std::vector<uint8_t> data(count * 5);
+    uint8_t *pos = &data[0];
+
+    for (size_t i = 0; i < count; ++i)
+        cbor_write_uint(&pos, &data[0] + data.size() - pos, (cbor_base_uint_t)(i * 100));
+
+    data.resize(pos - &data[0]);
+    return data;
+}
+
+void CborphineBulkTest::writeSequence(size_t count, cbor_base_uint_t offset)
+{
+    ASSERT_EQ(CBOR_TRUE, cbor_init_bulk_writer(&_bulk, _fd, offset, _blocks, 16, 3));
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (cbor_write_uint(&_bulk.pos, _bulk.end - _bulk.pos, (cbor_base_uint_t)(i * 100)) == CBOR_FALSE)
+        {
+            ASSERT_EQ(CBOR_TRUE, cbor_bulk_submit(&_bulk));
+            ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&_bulk.pos, _bulk.end - _bulk.pos, (cbor_base_uint_t)(i * 100)));
+        }
+    }
+
+    ASSERT_EQ(CBOR_TRUE, cbor_bulk_finish(&_bulk));
+    cbor_close_bulk(&_bulk);
+}
+
+TEST_F(CborphineBulkTest, WriteAndRead)
+{
+    std::vector<uint8_t> expected = encodeSequence(100);
+    std::vector<uint8_t> data;
+    const uint8_t *block;
+    size_t blockSize;
+
+    writeSequence(100, 0);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_bulk_reader(&_bulk, _fd, 0, _blocks, 16, 3));
+
+    for (;;)
+    {
+        ASSERT_EQ(CBOR_TRUE, cbor_bulk_read(&_bulk, &block, &blockSize));
+        if (blockSize == 0)
+            break;
+
+        ASSERT_TRUE(blockSize <= 16);
+        data.insert(data.end(), block, block + blockSize);
+        cbor_bulk_release(&_bulk);
+    }
+
+    cbor_close_bulk(&_bulk);
+    ASSERT_EQ(expected, data);
+}
+
+TEST_F(CborphineBulkTest, DecodeFromOffset)
+{
+    uint8_t window[16];
+    cbor_source_t source;
+    cbor_token_t token;
+    cbor_base_uint_t value;
+    size_t count = 0;
+
+    writeSequence(100, 5);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_bulk_reader(&_bulk, _fd, 5, _blocks, 16, 3));
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read_source(&token, &source, cbor_refill_bulk, &_bulk, window, sizeof(window), CBOR_TRUE));
+
+    while (token.type != CBOR_TOKEN_TYPE_END)
+    {
+        ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&token, &value));
+        ASSERT_EQ(count * 100, value);
+        ++count;
+    }
+
+    cbor_close_bulk(&_bulk);
+    ASSERT_EQ(100u, count);
+}
+
+TEST_F(CborphineBulkTest, InvalidBlocks)
+{
+    ASSERT_EQ(CBOR_FALSE, cbor_init_bulk_reader(&_bulk, _fd, 0, _blocks, 16, 0));
+    ASSERT_EQ(CBOR_FALSE, cbor_init_bulk_writer(&_bulk, _fd, 0, _blocks, 0, 3));
+    ASSERT_EQ(CBOR_FALSE, cbor_init_bulk_writer(&_bulk, _fd, 0, _blocks, 16, CBOR_BULK_MAX_BLOCKS + 1));
+}
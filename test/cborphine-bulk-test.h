@@ -0,0 +1,28 @@
+#ifndef CBORPHINE_BULK_TEST_H
+#define CBORPHINE_BULK_TEST_H
+
+#include <cstdio>
+#include "cborphine-test.h"
+
+class CborphineBulkTest : public CborphineTest
+{
+public: // ::testing::Test
+
+    virtual void SetUp();
+
+    virtual void TearDown();
+
+protected:
+
+    std::vector<uint8_t> encodeSequence(size_t count);
+    void writeSequence(size_t count, cbor_base_uint_t offset);
+
+protected:
+
+    FILE*       _file;
+    int         _fd;
+    uint8_t     _blocks[3 * 16];
+    cbor_bulk_t _bulk;
+};
+
+#endif // CBORPHINE_BULK_TEST_H
@@ -0,0 +1,85 @@
+#include "cborphine-checksum-test.h"
+
+uint32_t CborphineChecksumTest::bitwiseCrc32c(uint32_t crc, const uint8_t *data, size_t size)
+{
+    crc = ~crc;
+    while (size-- > 0)
+    {
+        crc ^= *data++;
+        for (int i = 0; i < 8; ++i)
+            crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1)));
+    }
+
+    return ~crc;
+}
+
+TEST_F(CborphineChecksumTest, UnalignedLengths)
+{
+    uint8_t input[300];
+
+    for (size_t i = 0; i < sizeof(input); ++i)
+        input[i] = (uint8_t)(i * 37 + 11);
+
+    for (size_t offset = 0; offset < 9; ++offset)
+        for (size_t size = 0; size + offset <= sizeof(input); size += 7)
+            ASSERT_EQ(bitwiseCrc32c(0, input + offset, size), cbor_crc32c(0, input + offset, size)) << offset << " " << size;
+}
+
+TEST_F(CborphineChecksumTest, RunningChecksum)
+{
+    uint8_t *pos = _data;
+
+    setExpected("a1 61 61 82 01 02 a2 19 2a 87");
+    cbor_init_checksum(&_checksum);
+    ASSERT_EQ(CBOR_TRUE, cbor_write_map(&_data, _size, 1));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_string(&_data, _size, "a"));
+    ASSERT_EQ(bitwiseCrc32c(0, &_buffer[0], 3), cbor_checksum_update(&_checksum, pos, _data - pos));
+    pos = _data;
+    ASSERT_EQ(CBOR_TRUE, cbor_write_array(&_data, _size, 2));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&_data, _size, 1));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&_data, _size, 2));
+    cbor_checksum_update(&_checksum, pos, _data - pos);
+    ASSERT_EQ(CBOR_TRUE, cbor_write_checksum(&_data, _size, &_checksum));
+    ASSERT_EQ(&_buffer[10], _data);
+    ASSERT_EQ(bitwiseCrc32c(0, &_buffer[0], 6), cbor_crc32c(0, &_buffer[0], 6));
+    ASSERT_EQ(CBOR_TRUE, cbor_verify_checksum(&_buffer[0], 10));
+}
+
+TEST_F(CborphineChecksumTest, NextRecord)
+{
+    uint8_t *pos = _data;
+
+    setExpected("01 a0 16 d0 52 02 b3 46 23 a6");
+    cbor_init_checksum(&_checksum);
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&_data, _size, 1));
+    cbor_checksum_update(&_checksum, pos, _data - pos);
+    ASSERT_EQ(CBOR_TRUE, cbor_write_checksum(&_data, _size, &_checksum));
+    pos = _data;
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&_data, _size, 2));
+    cbor_checksum_update(&_checksum, pos, _data - pos);
+    ASSERT_EQ(CBOR_TRUE, cbor_write_checksum(&_data, _size, &_checksum));
+    ASSERT_EQ(CBOR_TRUE, cbor_verify_checksum(&_buffer[0], 5));
+    ASSERT_EQ(CBOR_TRUE, cbor_verify_checksum(&_buffer[5], 5));
+}
+
+TEST_F(CborphineChecksumTest, Corrupted)
+{
+    setExpected("01 a0 16 d0 52");
+    cbor_init_checksum(&_checksum);
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&_data, _size, 1));
+    cbor_checksum_update(&_checksum, &_buffer[0], 1);
+    ASSERT_EQ(CBOR_TRUE, cbor_write_checksum(&_data, _size, &_checksum));
+    _buffer[0] ^= 0x10;
+    ASSERT_EQ(CBOR_FALSE, cbor_verify_checksum(&_buffer[0], 5));
+    _buffer[0] ^= 0x10;
+    ASSERT_EQ(CBOR_FALSE, cbor_verify_checksum(&_buffer[0], 3));
+}
+
+TEST_F(CborphineChecksumTest, NoSpace)
+{
+    uint8_t *pos = _data;
+
+    cbor_init_checksum(&_checksum);
+    ASSERT_EQ(CBOR_FALSE, cbor_write_checksum(&_data, 3, &_checksum));
+    ASSERT_EQ(pos, _data);
+}
@@ -0,0 +1,17 @@
+#ifndef CBORPHINE_CHECKSUM_TEST_H
+#define CBORPHINE_CHECKSUM_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineChecksumTest : public CborphineTest
+{
+protected:
+
+    static uint32_t bitwiseCrc32c(uint32_t crc, const uint8_t *data, size_t size);
+
+protected:
+
+    cbor_checksum_t _checksum;
+};
+
+#endif // CBORPHINE_CHECKSUM_TEST_H
@@ -0,0 +1,171 @@
+#include <cstdio>
+#include <cstring>
+#include "cborphine-columns-test.h"
+
+static const char *rowsHex = "83 a3 62 69 64 01 65 73 63 6f 72 65 fb 3f f8 00 00 00 00 00 00 64 6e 61 6d 65 62 61 62"
+                             "a2 64 6e 61 6d 65 61 63 62 69 64 02"
+                             "a4 62 69 64 03 65 73 63 6f 72 65 f6 64 6e 61 6d 65 60 61 78 81 01";
+
+void CborphineColumnsTest::SetUp()
+{
+    CborphineTest::SetUp();
+
+    memset(_columns, 0, sizeof(_columns));
+
+    _columns[0].key = "id";
+    _columns[0].type = CBOR_FIELD_TYPE_UINT;
+    _columns[0].size = sizeof(uint32_t);
+    _columns[0].values = _ids;
+
+    _columns[1].key = "score";
+    _columns[1].type = CBOR_FIELD_TYPE_FLOAT;
+    _columns[1].size = sizeof(double);
+    _columns[1].values = _scores;
+    _columns[1].validity = _scoreValidity;
+
+    _columns[2].key = "name";
+    _columns[2].type = CBOR_FIELD_TYPE_STRING;
+    _columns[2].values = _nameOffsets;
+    _columns[2].data = _nameData;
+    _columns[2].data_capacity = sizeof(_nameData);
+    _columns[2].validity = _nameValidity;
+}
+
+TEST_F(CborphineColumnsTest, ToColumns)
+{
+    std::vector<uint8_t> data = fromHex(std::string(rowsHex) + "07");
+    cbor_token_t token;
+    cbor_base_uint_t next;
+    size_t rowsCount = 0;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, data.data(), data.size(), CBOR_TRUE));
+    ASSERT_EQ(CBOR_TRUE, cbor_to_columns(&token, _columns, 3, 4, &rowsCount));
+    ASSERT_EQ(3u, rowsCount);
+
+    ASSERT_EQ(1u, _ids[0]);
+    ASSERT_EQ(2u, _ids[1]);
+    ASSERT_EQ(3u, _ids[2]);
+
+    // missing and null values are zeroed
+    ASSERT_EQ(1.5, _scores[0]);
+    ASSERT_EQ(0.0, _scores[1]);
+    ASSERT_EQ(0.0, _scores[2]);
+    ASSERT_EQ(0x01, _scoreValidity[0] & 0x07);
+
+    ASSERT_EQ(0u, _nameOffsets[0]);
+    ASSERT_EQ(2u, _nameOffsets[1]);
+    ASSERT_EQ(3u, _nameOffsets[2]);
+    ASSERT_EQ(3u, _nameOffsets[3]);
+    ASSERT_EQ(0, memcmp("abc", _nameData, 3));
+    ASSERT_EQ(0x07, _nameValidity[0] & 0x07);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&token, &next));
+    ASSERT_EQ(7u, next);
+}
+
+TEST_F(CborphineColumnsTest, FromColumns)
+{
+    std::vector<uint8_t> data = fromHex(rowsHex);
+    cbor_token_t token;
+    size_t rowsCount = 0;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, data.data(), data.size(), CBOR_FALSE));
+    ASSERT_EQ(CBOR_TRUE, cbor_to_columns(&token, _columns, 3, 4, &rowsCount));
+
+    // missing values are omitted, unknown keys are lost
+    setExpected("83 a3 62 69 64 01 65 73 63 6f 72 65 fb 3f f8 00 00 00 00 00 00 64 6e 61 6d 65 62 61 62"
+                "a2 62 69 64 02 64 6e 61 6d 65 61 63"
+                "a2 62 69 64 03 64 6e 61 6d 65 60");
+    ASSERT_EQ(CBOR_TRUE, cbor_from_columns(&_data, _size, _columns, 3, rowsCount));
+}
+
+TEST_F(CborphineColumnsTest, FromColumnsWithInsufficientBufferSize)
+{
+    _ids[0] = 1;
+    _scoreValidity[0] = 0;
+    _nameValidity[0] = 0;
+
+    ASSERT_EQ(CBOR_FALSE, cbor_from_columns(&_data, 4, _columns, 3, 1));
+    ASSERT_EQ(&_buffer[0], _data);
+    _expected = _buffer; // partially written data is not used
+}
+
+TEST_F(CborphineColumnsTest, InvalidColumnSize)
+{
+    std::vector<uint8_t> data = fromHex(rowsHex);
+    cbor_token_t token;
+    size_t rowsCount = 0;
+
+    _ids[0] = 7;
+    _columns[0].size = 3;
+    ASSERT_EQ(CBOR_FALSE, cbor_from_columns(&_data, _size, _columns, 3, 1));
+    ASSERT_EQ(&_buffer[0], _data);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, data.data(), data.size(), CBOR_FALSE));
+    ASSERT_EQ(CBOR_FALSE, cbor_to_columns(&token, _columns, 3, 4, &rowsCount));
+    ASSERT_STREQ("invalid column", token.error_message);
+    ASSERT_EQ(7u, _ids[0]); // no row is touched
+
+    _columns[0].size = sizeof(uint32_t);
+    _columns[1].size = 2; // neither float nor double
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, data.data(), data.size(), CBOR_FALSE));
+    ASSERT_EQ(CBOR_FALSE, cbor_to_columns(&token, _columns, 3, 4, &rowsCount));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_ERROR, token.type);
+}
+
+TEST_F(CborphineColumnsTest, ToColumnsWithInsufficientRows)
+{
+    std::vector<uint8_t> data = fromHex(rowsHex);
+    cbor_token_t token;
+    size_t rowsCount = 0;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, data.data(), data.size(), CBOR_FALSE));
+    ASSERT_EQ(CBOR_FALSE, cbor_to_columns(&token, _columns, 3, 2, &rowsCount));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_ERROR, token.type);
+    ASSERT_EQ(0u, rowsCount);
+}
+
+TEST_F(CborphineColumnsTest, ToColumnsWithInsufficientDataSize)
+{
+    std::vector<uint8_t> data = fromHex(rowsHex);
+    cbor_token_t token;
+    size_t rowsCount = 0;
+
+    _columns[2].data_capacity = 2;
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, data.data(), data.size(), CBOR_FALSE));
+    ASSERT_EQ(CBOR_FALSE, cbor_to_columns(&token, _columns, 3, 4, &rowsCount));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_ERROR, token.type);
+}
+
+TEST_F(CborphineColumnsTest, ToColumnsWithInvalidRow)
+{
+    std::vector<uint8_t> data = fromHex("82 a1 62 69 64 01 02");
+    cbor_token_t token;
+    size_t rowsCount = 0;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, data.data(), data.size(), CBOR_FALSE));
+    ASSERT_EQ(CBOR_FALSE, cbor_to_columns(&token, _columns, 3, 4, &rowsCount));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_ERROR, token.type);
+}
+
+TEST_F(CborphineColumnsTest, ToColumnsWithStreamedKey)
+{
+    // keys larger than the window of a refillable source aren't matched in chunks
+    std::vector<uint8_t> data = fromHex("81" "a1 78 14 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 01");
+    FILE *file = tmpfile();
+    uint8_t window[16];
+    cbor_source_t source;
+    cbor_token_t token;
+    size_t rowsCount = 0;
+
+    ASSERT_TRUE(file != NULL);
+    fwrite(data.data(), 1, data.size(), file);
+    fseek(file, 0, SEEK_SET);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read_source(&token, &source, cbor_refill_file, file, window, sizeof(window), CBOR_TRUE));
+    ASSERT_EQ(CBOR_FALSE, cbor_to_columns(&token, _columns, 3, 4, &rowsCount));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_ERROR, token.type);
+    ASSERT_STREQ("key larger than window", token.error_message);
+
+    fclose(file);
+}
@@ -0,0 +1,23 @@
+#ifndef CBORPHINE_COLUMNS_TEST_H
+#define CBORPHINE_COLUMNS_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineColumnsTest : public CborphineTest
+{
+public: // ::testing::Test
+
+    virtual void SetUp();
+
+protected:
+
+    uint32_t      _ids[4];
+    double        _scores[4];
+    uint32_t      _nameOffsets[5];
+    uint8_t       _nameData[16];
+    uint8_t       _scoreValidity[1];
+    uint8_t       _nameValidity[1];
+    cbor_column_t _columns[3];
+};
+
+#endif // CBORPHINE_COLUMNS_TEST_H
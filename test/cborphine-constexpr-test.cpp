@@ -0,0 +1,62 @@
+#include "cbor.hpp"
+#include "cborphine-constexpr-test.h"
+
+TEST_F(CborphineConstexprTest, UIntWidths)
+{
+    static_assert(cborphine::uint_value<23>().size() == 1, "injected value");
+    static_assert(cborphine::uint_value<24>().size() == 2, "1 byte value");
+    static_assert(cborphine::uint_value<65535>().size() == 3, "2 bytes value");
+    static_assert(cborphine::uint_value<65536>().size() == 5, "4 bytes value");
+    static_assert(cborphine::uint_value<4294967296ull>().size() == 9, "8 bytes value");
+
+    setExpected("17 18 18 19 ff ff 1a 00 01 00 00 1b 00 00 00 01 00 00 00 00");
+    ASSERT_TRUE(cborphine::write(&_data, _size, cborphine::concat(cborphine::uint_value<23>(),
+                                                                  cborphine::uint_value<24>(),
+                                                                  cborphine::uint_value<65535>(),
+                                                                  cborphine::uint_value<65536>(),
+                                                                  cborphine::uint_value<4294967296ull>())));
+}
+
+TEST_F(CborphineConstexprTest, MatchesRuntimeEncoding)
+{
+    constexpr auto items = cborphine::concat(cborphine::map_header<3>(),
+                                             cborphine::text("id"), cborphine::int_value<-500>(),
+                                             cborphine::text("ok"), cborphine::boolean<true>(),
+                                             cborphine::text("tags"), cborphine::array_header<2>(),
+                                             cborphine::tag<1>(), cborphine::null(), cborphine::undefined());
+    static const uint8_t bytes[] = { 1, 2 };
+    constexpr auto blob = cborphine::bytes(bytes);
+
+    uint8_t* data = &_expected[0];
+    size_t size = _expected.size();
+    ASSERT_EQ(CBOR_TRUE, cbor_write_map(&data, size, 3));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_string(&data, size, "id"));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_int(&data, size, -500));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_string(&data, size, "ok"));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_boolean(&data, size, CBOR_TRUE));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_string(&data, size, "tags"));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_array(&data, size, 2));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_tag(&data, size, 1));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_null(&data, size));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_undefined(&data, size));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_bytes(&data, size, bytes, sizeof(bytes)));
+
+    ASSERT_TRUE(cborphine::write(&_data, _size, items));
+    ASSERT_TRUE(cborphine::write(&_data, _size, blob));
+}
+
+TEST_F(CborphineConstexprTest, WriteWithInsufficientBufferSize)
+{
+    ASSERT_FALSE(cborphine::write(&_data, 2, cborphine::text("abc")));
+    ASSERT_EQ(&_buffer[0], _data);
+}
+
+#if defined(__cpp_lib_bit_cast)
+TEST_F(CborphineConstexprTest, Floats)
+{
+    constexpr auto items = cborphine::concat(cborphine::float_value(100000.0f), cborphine::double_value(1.1));
+
+    setExpected("fa 47 c3 50 00 fb 3f f1 99 99 99 99 99 9a");
+    ASSERT_TRUE(cborphine::write(&_data, _size, items));
+}
+#endif
@@ -0,0 +1,11 @@
+#ifndef CBORPHINE_CONSTEXPR_TEST_H
+#define CBORPHINE_CONSTEXPR_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineConstexprTest : public CborphineTest
+{
+
+};
+
+#endif // CBORPHINE_CONSTEXPR_TEST_H
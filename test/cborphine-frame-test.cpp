@@ -0,0 +1,117 @@
+#include <cstring>
+#include "cborphine-frame-test.h"
+
+void CborphineFrameTest::writeFrame(unsigned int flags, const char *str, cbor_bool_t compact)
+{
+    uint8_t *pos;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_frame_begin(&_data, _size - (_data - &_buffer[0]), flags, &_frame));
+    pos = _frame.message;
+    ASSERT_EQ(CBOR_TRUE, cbor_write_string(&pos, _frame.end - pos, str));
+    ASSERT_EQ(CBOR_TRUE, cbor_frame_end(&_data, &_frame, pos, compact));
+}
+
+TEST_F(CborphineFrameTest, Crc32c)
+{
+    ASSERT_EQ(0xE3069283u, cbor_crc32c(0, "123456789", 9));
+    ASSERT_EQ(0xE3069283u, cbor_crc32c(cbor_crc32c(0, "1234", 4), "56789", 5));
+    ASSERT_EQ(0u, cbor_crc32c(0, "", 0));
+}
+
+TEST_F(CborphineFrameTest, LengthPrefix)
+{
+    setExpected("00 00 00 04 63 61 62 63 00 00 00 02 61 61");
+    writeFrame(0, "abc", CBOR_FALSE);
+    ASSERT_EQ(&_buffer[8], _data);
+    writeFrame(0, "a", CBOR_FALSE);
+}
+
+TEST_F(CborphineFrameTest, PaddedVarint)
+{
+    setExpected("84 80 80 80 00 63 61 62 63");
+    writeFrame(CBOR_FRAME_VARINT, "abc", CBOR_FALSE);
+    ASSERT_EQ(&_buffer[9], _data);
+}
+
+TEST_F(CborphineFrameTest, CompactVarintWithChecksum)
+{
+    setExpected("04 63 61 62 63 00 e9 15 5f");
+    writeFrame(CBOR_FRAME_VARINT | CBOR_FRAME_CRC32C, "abc", CBOR_TRUE);
+    ASSERT_EQ(&_buffer[9], _data);
+}
+
+TEST_F(CborphineFrameTest, InsufficientSpace)
+{
+    setExpected("");
+    ASSERT_EQ(CBOR_FALSE, cbor_frame_begin(&_data, 7, CBOR_FRAME_CRC32C, &_frame));
+    ASSERT_EQ(CBOR_TRUE, cbor_frame_begin(&_data, 8, CBOR_FRAME_CRC32C, &_frame));
+    ASSERT_EQ(CBOR_FALSE, cbor_frame_end(&_data, &_frame, _frame.end + 1, CBOR_FALSE));
+    ASSERT_EQ(&_buffer[0], _data);
+}
+
+TEST_F(CborphineFrameTest, Split)
+{
+    std::vector<uint8_t> input = fromHex("00 00 00 04 63 61 62 63 00 00 00 01 01 00 00");
+    const uint8_t *data = input.data();
+    size_t size = input.size();
+    const uint8_t *message;
+    size_t messageSize;
+
+    ASSERT_EQ(CBOR_FRAME_MESSAGE, cbor_split_frame(&data, &size, 0, 100, &message, &messageSize));
+    ASSERT_EQ(input.data() + 4, message);
+    ASSERT_EQ(4u, messageSize);
+
+    ASSERT_EQ(CBOR_FRAME_MESSAGE, cbor_split_frame(&data, &size, 0, 100, &message, &messageSize));
+    ASSERT_EQ(1u, messageSize);
+    ASSERT_EQ(0x01, message[0]);
+
+    // the prefix of the next frame is incomplete
+    ASSERT_EQ(CBOR_FRAME_MORE, cbor_split_frame(&data, &size, 0, 100, &message, &messageSize));
+    ASSERT_EQ(0u, messageSize);
+    ASSERT_EQ(2u, size);
+}
+
+TEST_F(CborphineFrameTest, SplitVarint)
+{
+    std::vector<uint8_t> input = fromHex("84 80 80 80 00 63 61 62 63 04 63 61 62");
+    const uint8_t *data = input.data();
+    size_t size = input.size();
+    const uint8_t *message;
+    size_t messageSize;
+
+    ASSERT_EQ(CBOR_FRAME_MESSAGE, cbor_split_frame(&data, &size, CBOR_FRAME_VARINT, 100, &message, &messageSize));
+    ASSERT_EQ(input.data() + 5, message);
+    ASSERT_EQ(4u, messageSize);
+
+    ASSERT_EQ(CBOR_FRAME_MORE, cbor_split_frame(&data, &size, CBOR_FRAME_VARINT, 100, &message, &messageSize));
+    ASSERT_EQ(5u, messageSize); // size of the whole frame
+    ASSERT_EQ(4u, size);
+}
+
+TEST_F(CborphineFrameTest, SplitErrors)
+{
+    std::vector<uint8_t> checksum = fromHex("04 63 61 62 63 00 e9 15 5e");
+    std::vector<uint8_t> varint = fromHex("80 80 80 80 10 00");
+    std::vector<uint8_t> large = fromHex("00 00 01 00");
+    const uint8_t *data;
+    size_t size;
+    const uint8_t *message;
+    size_t messageSize;
+
+    data = checksum.data();
+    size = checksum.size();
+    ASSERT_EQ(CBOR_FRAME_ERROR, cbor_split_frame(&data, &size, CBOR_FRAME_VARINT | CBOR_FRAME_CRC32C, 100, &message, &messageSize));
+    ASSERT_EQ(checksum.data(), data);
+
+    checksum.back() = 0x5f;
+    ASSERT_EQ(CBOR_FRAME_MESSAGE, cbor_split_frame(&data, &size, CBOR_FRAME_VARINT | CBOR_FRAME_CRC32C, 100, &message, &messageSize));
+    ASSERT_EQ(0u, size);
+
+    data = varint.data();
+    size = varint.size();
+    ASSERT_EQ(CBOR_FRAME_ERROR, cbor_split_frame(&data, &size, CBOR_FRAME_VARINT, 0xFFFFFFFF, &message, &messageSize));
+
+    data = large.data();
+    size = large.size();
+    ASSERT_EQ(CBOR_FRAME_ERROR, cbor_split_frame(&data, &size, 0, 255, &message, &messageSize));
+}
@@ -0,0 +1,17 @@
+#ifndef CBORPHINE_FRAME_TEST_H
+#define CBORPHINE_FRAME_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineFrameTest : public CborphineTest
+{
+protected:
+
+    void writeFrame(unsigned int flags, const char *str, cbor_bool_t compact);
+
+protected:
+
+    cbor_frame_t _frame;
+};
+
+#endif // CBORPHINE_FRAME_TEST_H
@@ -0,0 +1,79 @@
+#include "cborphine-gather-test.h"
+
+void CborphineGatherTest::SetUp()
+{
+    CborphineTest::SetUp();
+
+    _payload = fromHex("00 01 02 03 04 05 06 07");
+    ASSERT_EQ(CBOR_TRUE, cbor_init_gather_writer(&_writer, _data, _size, _iovecs, 4, 8));
+}
+
+std::vector<uint8_t> CborphineGatherTest::join(size_t iovecsCount) const
+{
+    std::vector<uint8_t> data;
+    size_t i;
+
+    for (i = 0; i < iovecsCount; ++i)
+    {
+        const uint8_t *base = (const uint8_t *)_iovecs[i].base;
+        data.insert(data.end(), base, base + _iovecs[i].size);
+    }
+
+    return data;
+}
+
+TEST_F(CborphineGatherTest, WriteHeaders)
+{
+    setExpected("78 20 5a 00 01 00 00");
+    ASSERT_EQ(CBOR_TRUE, cbor_write_string_header(&_data, _size, 32));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_bytes_header(&_data, _size, 65536));
+    ASSERT_EQ(CBOR_FALSE, cbor_write_bytes_header(&_data, 2, 65536));
+}
+
+TEST_F(CborphineGatherTest, LargePayloadIsReferenced)
+{
+    setExpected("83 01 48 62 61 62");
+    ASSERT_EQ(CBOR_TRUE, cbor_write_array(&_writer.pos, _writer.end - _writer.pos, 3));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&_writer.pos, _writer.end - _writer.pos, 1));
+    ASSERT_EQ(CBOR_TRUE, cbor_gather_write_bytes(&_writer, _payload.data(), _payload.size()));
+    ASSERT_EQ(CBOR_TRUE, cbor_gather_write_string(&_writer, "ab"));
+    ASSERT_EQ(3u, cbor_gather_finish(&_writer));
+
+    ASSERT_EQ(&_buffer[0], _iovecs[0].base);
+    ASSERT_EQ(3u, _iovecs[0].size);
+    ASSERT_EQ(_payload.data(), _iovecs[1].base); // not copied
+    ASSERT_EQ(8u, _iovecs[1].size);
+    ASSERT_EQ(&_buffer[3], _iovecs[2].base);
+    ASSERT_EQ(3u, _iovecs[2].size);
+
+    ASSERT_EQ(fromHex("83 01 48 00 01 02 03 04 05 06 07 62 61 62"), join(3));
+}
+
+TEST_F(CborphineGatherTest, SmallPayloadIsCopied)
+{
+    setExpected("47 00 01 02 03 04 05 06 67 61 62 63 64 65 66 67");
+    ASSERT_EQ(CBOR_TRUE, cbor_gather_write_bytes(&_writer, _payload.data(), 7));
+    ASSERT_EQ(CBOR_TRUE, cbor_gather_write_string_with_len(&_writer, "abcdefgh", 7));
+    ASSERT_EQ(1u, cbor_gather_finish(&_writer));
+    ASSERT_EQ(16u, _iovecs[0].size);
+}
+
+TEST_F(CborphineGatherTest, AdjacentPayloads)
+{
+    setExpected("48 68");
+    ASSERT_EQ(CBOR_TRUE, cbor_init_gather_writer(&_writer, _data, _size, _iovecs, 5, 8));
+    ASSERT_EQ(CBOR_TRUE, cbor_gather_write_bytes(&_writer, _payload.data(), _payload.size()));
+    ASSERT_EQ(CBOR_TRUE, cbor_gather_write_string_with_len(&_writer, "abcdefgh", 8));
+    ASSERT_EQ(4u, cbor_gather_finish(&_writer));
+    ASSERT_EQ(fromHex("48 00 01 02 03 04 05 06 07 68 61 62 63 64 65 66 67 68"), join(4));
+}
+
+TEST_F(CborphineGatherTest, WriteWithInsufficientIovecs)
+{
+    setExpected("48 01");
+    ASSERT_EQ(CBOR_TRUE, cbor_gather_write_bytes(&_writer, _payload.data(), _payload.size()));
+    ASSERT_EQ(CBOR_FALSE, cbor_gather_write_bytes(&_writer, _payload.data(), _payload.size()));
+    ASSERT_EQ(2u, _writer.iovecs_count);
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&_writer.pos, _writer.end - _writer.pos, 1));
+    ASSERT_EQ(3u, cbor_gather_finish(&_writer));
+}
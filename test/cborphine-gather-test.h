@@ -0,0 +1,23 @@
+#ifndef CBORPHINE_GATHER_TEST_H
+#define CBORPHINE_GATHER_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineGatherTest : public CborphineTest
+{
+public: // ::testing::Test
+
+    virtual void SetUp();
+
+protected:
+
+    std::vector<uint8_t> join(size_t iovecsCount) const;
+
+protected:
+
+    cbor_iovec_t         _iovecs[5];
+    cbor_gather_writer_t _writer;
+    std::vector<uint8_t> _payload;
+};
+
+#endif // CBORPHINE_GATHER_TEST_H
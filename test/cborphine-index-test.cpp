@@ -0,0 +1,128 @@
+#include <cstring>
+#include "cborphine-index-test.h"
+
+void CborphineIndexTest::buildIndex(const std::vector<uint8_t>& sequence, const char *const *keys, size_t keysCount, size_t blockRecords)
+{
+    cbor_index_builder_t builder;
+    std::vector<uint8_t> block(CBOR_INDEX_BLOCK_SIZE(keysCount, blockRecords));
+    cbor_token_t token;
+    size_t blockSize;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_index_builder(&builder, keys, keysCount, blockRecords, block.data()));
+
+    _data += CBOR_INDEX_HEADER_SIZE;
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, sequence.data(), sequence.size(), CBOR_TRUE));
+    while (token.type != CBOR_TOKEN_TYPE_END)
+    {
+        const uint8_t *record;
+        size_t recordSize;
+
+        ASSERT_EQ(CBOR_TRUE, cbor_get_item_span(&token, &record, &recordSize));
+        ASSERT_EQ(CBOR_TRUE, cbor_index_add_record(&builder, record - sequence.data(), record, recordSize, &blockSize));
+        memcpy(_data, block.data(), blockSize);
+        _data += blockSize;
+        ASSERT_EQ(CBOR_TRUE, cbor_skip(&token));
+    }
+
+    blockSize = cbor_index_finish(&builder);
+    memcpy(_data, block.data(), blockSize);
+    _data += blockSize;
+
+    cbor_index_write_header(&builder, &_buffer[0]);
+}
+
+void CborphineIndexTest::initIndex()
+{
+    ASSERT_EQ(CBOR_TRUE, cbor_init_index(&_index, &_buffer[0], _data - &_buffer[0]));
+    _expected = _buffer;
+}
+
+TEST_F(CborphineIndexTest, Layout)
+{
+    const char *keys[] = { "ts" };
+
+    setExpected("43 42 49 58 00 00 00 01 00 00 00 01 00 00 00 02 00 00 00 00 00 00 00 02"
+                "3f f0 00 00 00 00 00 00 40 00 00 00 00 00 00 00"
+                "00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 05");
+    buildIndex(fromHex("a1 62 74 73 01 a1 62 74 73 02"), keys, 1, 2);
+}
+
+TEST_F(CborphineIndexTest, LongerKeyIsNotMatched)
+{
+    const char *keys[] = { "ts" };
+
+    // {"ts_long": 5}, {"ts": 2}
+    setExpected("43 42 49 58 00 00 00 01 00 00 00 01 00 00 00 02 00 00 00 00 00 00 00 02"
+                "40 00 00 00 00 00 00 00 40 00 00 00 00 00 00 00"
+                "00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 0a");
+    buildIndex(fromHex("a1 67 74 73 5f 6c 6f 6e 67 05 a1 62 74 73 02"), keys, 1, 2);
+}
+
+TEST_F(CborphineIndexTest, Offsets)
+{
+    cbor_base_uint_t offset;
+
+    buildIndex(fromHex("01 82 01 02 63 61 62 63 a1 61 61 01 f6"), NULL, 0, 2);
+    initIndex();
+
+    ASSERT_EQ(5u, _index.records_count);
+    ASSERT_EQ(3u, _index.blocks_count);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_index_get_offset(&_index, 0, &offset));
+    ASSERT_EQ(0u, offset);
+    ASSERT_EQ(CBOR_TRUE, cbor_index_get_offset(&_index, 1, &offset));
+    ASSERT_EQ(1u, offset);
+    ASSERT_EQ(CBOR_TRUE, cbor_index_get_offset(&_index, 2, &offset));
+    ASSERT_EQ(4u, offset);
+    ASSERT_EQ(CBOR_TRUE, cbor_index_get_offset(&_index, 4, &offset));
+    ASSERT_EQ(12u, offset);
+    ASSERT_EQ(CBOR_FALSE, cbor_index_get_offset(&_index, 5, &offset));
+}
+
+TEST_F(CborphineIndexTest, Zones)
+{
+    const char *keys[] = { "ts", "id" };
+    double min;
+    double max;
+
+    // {"ts": 10, "id": 1}, {"id": 2, "ts": 20}, {"ts": 30, "x": [1]}, {"ts": "a"}, {"ts": -5.5}
+    buildIndex(fromHex("a2 62 74 73 0a 62 69 64 01 a2 62 69 64 02 62 74 73 14"
+                       "a2 62 74 73 18 1e 61 78 81 01 a1 62 74 73 61 61 a1 62 74 73 fb c0 16 00 00 00 00 00 00"), keys, 2, 2);
+    initIndex();
+
+    ASSERT_EQ(3u, _index.blocks_count);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_index_get_zone(&_index, 0, 0, &min, &max));
+    ASSERT_EQ(10.0, min);
+    ASSERT_EQ(20.0, max);
+    ASSERT_EQ(CBOR_TRUE, cbor_index_get_zone(&_index, 0, 1, &min, &max));
+    ASSERT_EQ(1.0, min);
+    ASSERT_EQ(2.0, max);
+    ASSERT_EQ(CBOR_TRUE, cbor_index_get_zone(&_index, 1, 0, &min, &max));
+    ASSERT_EQ(30.0, min);
+    ASSERT_EQ(30.0, max);
+    ASSERT_EQ(CBOR_FALSE, cbor_index_get_zone(&_index, 1, 1, &min, &max)); // no values
+    ASSERT_EQ(CBOR_TRUE, cbor_index_get_zone(&_index, 2, 0, &min, &max));
+    ASSERT_EQ(-5.5, min);
+
+    ASSERT_EQ(1u, cbor_index_find_block(&_index, 0, 0, 25, 35));
+    ASSERT_EQ(3u, cbor_index_find_block(&_index, 2, 0, 25, 35));
+    ASSERT_EQ(0u, cbor_index_find_block(&_index, 0, 1, 2, 2));
+    ASSERT_EQ(3u, cbor_index_find_block(&_index, 1, 1, 0, 100));
+}
+
+TEST_F(CborphineIndexTest, InitWithInvalidData)
+{
+    const char *keys[] = { "ts" };
+
+    buildIndex(fromHex("a1 62 74 73 01 a1 62 74 73 02 a1 62 74 73 03"), keys, 1, 2);
+    _expected = _buffer;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_index(&_index, &_buffer[0], _data - &_buffer[0]));
+    ASSERT_EQ(CBOR_FALSE, cbor_init_index(&_index, &_buffer[0], _data - &_buffer[0] - 8)); // truncated
+    ASSERT_EQ(CBOR_FALSE, cbor_init_index(&_index, &_buffer[0], CBOR_INDEX_HEADER_SIZE - 1));
+
+    _buffer[0] = 0;
+    ASSERT_EQ(CBOR_FALSE, cbor_init_index(&_index, &_buffer[0], _data - &_buffer[0])); // magic
+    _buffer[0] = 'C';
+}
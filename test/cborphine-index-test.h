@@ -0,0 +1,18 @@
+#ifndef CBORPHINE_INDEX_TEST_H
+#define CBORPHINE_INDEX_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineIndexTest : public CborphineTest
+{
+protected:
+
+    void buildIndex(const std::vector<uint8_t>& sequence, const char *const *keys, size_t keysCount, size_t blockRecords);
+    void initIndex();
+
+protected:
+
+    cbor_index_t _index;
+};
+
+#endif // CBORPHINE_INDEX_TEST_H
@@ -0,0 +1,141 @@
+#include "cborphine-iovecs-test.h"
+
+void CborphineIovecsTest::SetUp()
+{
+    CborphineTest::SetUp();
+
+    _iovecs.clear();
+}
+
+cbor_bool_t CborphineIovecsTest::initRead(const std::string& hex, const std::vector<size_t>& splits, cbor_bool_t nextOnRead)
+{
+    size_t offset = 0;
+
+    _input = fromHex(hex);
+    _iovecs.clear();
+
+    for (size_t i = 0; i <= splits.size(); ++i)
+    {
+        size_t next = i < splits.size() ? splits[i] : _input.size();
+        cbor_iovec_t iovec = { _input.data() + offset, next - offset };
+
+        _iovecs.push_back(iovec);
+        offset = next;
+    }
+
+    return cbor_init_read_iovecs(&_token, &_source, _iovecs.data(), _iovecs.size(), _window, sizeof(_window), nextOnRead);
+}
+
+TEST_F(CborphineIovecsTest, ReadAtAnySplit)
+{
+    const std::string hex = "83 19 03 e8 63 61 62 63 fb 3f f8 00 00 00 00 00 00 39 01 f3";
+
+    for (size_t split = 0; split <= fromHex(hex).size(); ++split)
+    {
+        cbor_base_uint_t value;
+        cbor_base_int_t intValue;
+        char str[4];
+        double doubleValue;
+
+        ASSERT_EQ(CBOR_TRUE, initRead(hex, std::vector<size_t>(1, split), CBOR_TRUE)) << split;
+        ASSERT_EQ(CBOR_TRUE, cbor_read_array(&_token, &value)) << split;
+        ASSERT_EQ(3u, value);
+        ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&_token, &value)) << split;
+        ASSERT_EQ(1000u, value);
+        ASSERT_EQ(CBOR_TRUE, cbor_read_string(&_token, str, sizeof(str))) << split;
+        ASSERT_STREQ("abc", str);
+        ASSERT_EQ(CBOR_TRUE, cbor_read_double(&_token, &doubleValue)) << split;
+        ASSERT_EQ(1.5, doubleValue);
+        ASSERT_EQ(CBOR_TRUE, cbor_read_int(&_token, &intValue)) << split;
+        ASSERT_EQ(-500, intValue);
+        ASSERT_EQ(CBOR_TOKEN_TYPE_END, _token.type);
+    }
+}
+
+TEST_F(CborphineIovecsTest, ReadInPlace)
+{
+    std::vector<size_t> splits;
+
+    splits.push_back(1);
+    splits.push_back(1); // empty fragment
+    splits.push_back(8);
+
+    ASSERT_EQ(CBOR_TRUE, initRead("82 64 74 65 73 74 62 61 62", splits, CBOR_FALSE));
+    ASSERT_EQ(CBOR_TRUE, cbor_read_next(&_token));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_STRING, _token.type);
+    ASSERT_EQ((const char *)_input.data() + 2, CBOR_GET_STRING(&_token));
+
+    ASSERT_EQ(CBOR_TRUE, cbor_read_next(&_token));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_STRING, _token.type);
+    ASSERT_EQ(2u, CBOR_GET_STRING_LENGTH(&_token));
+    ASSERT_EQ((const char *)_window, CBOR_GET_STRING(&_token)); // stitched across fragments
+    ASSERT_EQ(0, memcmp("ab", CBOR_GET_STRING(&_token), 2));
+
+    ASSERT_EQ(CBOR_FALSE, cbor_read_next(&_token));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_END, _token.type);
+}
+
+TEST_F(CborphineIovecsTest, StreamLargeString)
+{
+    std::vector<uint8_t> payload;
+    std::vector<size_t> splits;
+    const uint8_t *chunk;
+    size_t chunkSize;
+    cbor_base_uint_t value;
+
+    splits.push_back(20);
+    ASSERT_EQ(CBOR_TRUE, initRead("58 28 00 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f 10 11 12 13"
+                                  "14 15 16 17 18 19 1a 1b 1c 1d 1e 1f 20 21 22 23 24 25 26 27 07", splits, CBOR_FALSE));
+
+    ASSERT_EQ(CBOR_TOKEN_TYPE_BYTES, _token.type);
+    ASSERT_TRUE(CBOR_GET_BYTES(&_token) == NULL);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_read_source_chunk(&_token, &chunk, &chunkSize));
+    ASSERT_EQ(_input.data() + 2, chunk);
+    ASSERT_EQ(18u, chunkSize);
+    payload.insert(payload.end(), chunk, chunk + chunkSize);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_read_source_chunk(&_token, &chunk, &chunkSize));
+    ASSERT_EQ(_input.data() + 20, chunk);
+    ASSERT_EQ(22u, chunkSize);
+    payload.insert(payload.end(), chunk, chunk + chunkSize);
+
+    ASSERT_EQ(CBOR_FALSE, cbor_read_source_chunk(&_token, &chunk, &chunkSize));
+    ASSERT_EQ(40u, payload.size());
+    ASSERT_EQ(0x27, payload[39]);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_read_next(&_token));
+    ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&_token, &value));
+    ASSERT_EQ(7u, value);
+}
+
+TEST_F(CborphineIovecsTest, CopyLargeString)
+{
+    std::vector<size_t> splits;
+    uint8_t bytes[40];
+    cbor_base_uint_t value;
+
+    splits.push_back(10);
+    splits.push_back(30);
+    ASSERT_EQ(CBOR_TRUE, initRead("82 58 28 00 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f 10 11 12 13"
+                                  "14 15 16 17 18 19 1a 1b 1c 1d 1e 1f 20 21 22 23 24 25 26 27 07", splits, CBOR_TRUE));
+
+    ASSERT_EQ(CBOR_TRUE, cbor_read_array(&_token, &value));
+    ASSERT_EQ(CBOR_TRUE, cbor_read_bytes(&_token, bytes, sizeof(bytes)));
+    ASSERT_EQ(0x00, bytes[0]);
+    ASSERT_EQ(0x27, bytes[39]);
+    ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&_token, &value));
+    ASSERT_EQ(7u, value);
+}
+
+TEST_F(CborphineIovecsTest, TruncatedHeader)
+{
+    ASSERT_EQ(CBOR_FALSE, initRead("19 03", std::vector<size_t>(1, 1), CBOR_TRUE));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_ERROR, _token.type);
+}
+
+TEST_F(CborphineIovecsTest, TruncatedString)
+{
+    ASSERT_EQ(CBOR_FALSE, initRead("63 61 62", std::vector<size_t>(1, 2), CBOR_TRUE));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_ERROR, _token.type);
+}
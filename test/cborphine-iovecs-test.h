@@ -0,0 +1,26 @@
+#ifndef CBORPHINE_IOVECS_TEST_H
+#define CBORPHINE_IOVECS_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineIovecsTest : public CborphineTest
+{
+public: // ::testing::Test
+
+    virtual void SetUp();
+
+protected:
+
+    // splits input at the given offsets
+    cbor_bool_t initRead(const std::string& hex, const std::vector<size_t>& splits, cbor_bool_t nextOnRead);
+
+protected:
+
+    std::vector<uint8_t>      _input;
+    std::vector<cbor_iovec_t> _iovecs;
+    uint8_t                   _window[16];
+    cbor_source_t             _source;
+    cbor_token_t              _token;
+};
+
+#endif // CBORPHINE_IOVECS_TEST_H
@@ -0,0 +1,200 @@
+#include "cborphine-log-test.h"
+
+void CborphineLogTest::SetUp()
+{
+    CborphineTest::SetUp();
+
+    _file = tmpfile();
+    ASSERT_TRUE(_file != NULL);
+    _fd = fileno(_file);
+}
+
+void CborphineLogTest::TearDown()
+{
+    fclose(_file);
+
+    CborphineTest::TearDown();
+}
+
+std::vector<uint8_t> CborphineLogTest::readFile()
+{
+    std::vector<uint8_t> data(4096);
+
+    fseek(_file, 0, SEEK_SET);
+    data.resize(fread(&data[0], 1, data.size(), _file));
+    return data;
+}
+
+void CborphineLogTest::writeFile(const std::vector<uint8_t>& data)
+{
+    fseek(_file, 0, SEEK_SET);
+    fwrite(&data[0], 1, data.size(), _file);
+    fflush(_file);
+}
+
+std::vector<uint8_t> CborphineLogTest::frame(const std::string& record)
+{
+    std::vector<uint8_t> data = fromHex(record);
+    uint32_t size = (uint32_t)data.size();
+    uint32_t crc = cbor_crc32c(0, data.data(), data.size());
+    uint8_t prefix[4] = { (uint8_t)(size >> 24), (uint8_t)(size >> 16), (uint8_t)(size >> 8), (uint8_t)size };
+    uint8_t checksum[4] = { (uint8_t)(crc >> 24), (uint8_t)(crc >> 16), (uint8_t)(crc >> 8), (uint8_t)crc };
+
+    data.insert(data.begin(), prefix, prefix + 4);
+    data.insert(data.end(), checksum, checksum + 4);
+    return data;
+}
+
+static std::vector<uint8_t> concat(std::vector<uint8_t> data, const std::vector<uint8_t>& other)
+{
+    data.insert(data.end(), other.begin(), other.end());
+    return data;
+}
+
+TEST_F(CborphineLogTest, ValidSize)
+{
+    std::vector<uint8_t> data = fromHex("01 82 01 02 63 61 62");
+
+    ASSERT_EQ(4u, cbor_get_valid_size(data.data(), data.size()));
+    ASSERT_EQ(4u, cbor_get_valid_size(data.data(), 6));
+    ASSERT_EQ(1u, cbor_get_valid_size(data.data(), 3));
+    ASSERT_EQ(0u, cbor_get_valid_size(data.data(), 0));
+}
+
+TEST_F(CborphineLogTest, AppendIsBuffered)
+{
+    cbor_log_t log;
+    std::vector<uint8_t> record = fromHex("63 61 62 63");
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_log(&log, _fd, _logBuffer, sizeof(_logBuffer), 8, 0, 0));
+    ASSERT_EQ(CBOR_TRUE, cbor_log_append(&log, record.data(), record.size()));
+    ASSERT_TRUE(readFile().empty());
+
+    ASSERT_EQ(CBOR_TRUE, cbor_log_flush(&log));
+    ASSERT_EQ(fromHex("00 00 00 04 63 61 62 63 00 e9 15 5f"), readFile());
+}
+
+TEST_F(CborphineLogTest, ReserveAndCommit)
+{
+    cbor_log_t log;
+    std::vector<uint8_t> expected;
+    int i;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_log(&log, _fd, _logBuffer, sizeof(_logBuffer), 8, 0, 0));
+
+    // the buffer is flushed several times, incomplete blocks are written again
+    for (i = 0; i < 20; ++i)
+    {
+        uint8_t *pos = cbor_log_reserve(&log, 8);
+
+        ASSERT_TRUE(pos != NULL);
+        ASSERT_EQ(CBOR_TRUE, cbor_write_array(&pos, 8, 2));
+        ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&pos, 8, i));
+        ASSERT_EQ(CBOR_TRUE, cbor_write_string(&pos, 4, "ab"));
+        ASSERT_EQ(CBOR_TRUE, cbor_log_commit(&log, pos));
+
+        std::string record = "82 00 62 61 62";
+        record[4] = "0123456789abcdef"[i % 16];
+        record[3] = "01"[i / 16];
+        expected = concat(expected, frame(record));
+    }
+
+    ASSERT_EQ(CBOR_TRUE, cbor_log_sync(&log));
+    ASSERT_EQ(expected, readFile());
+}
+
+TEST_F(CborphineLogTest, ReserveMoreThanBuffer)
+{
+    cbor_log_t log;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_log(&log, _fd, _logBuffer, sizeof(_logBuffer), 8, 0, 0));
+    ASSERT_TRUE(cbor_log_reserve(&log, 32 - CBOR_LOG_RECORD_OVERHEAD + 1) == NULL);
+    ASSERT_EQ(CBOR_FALSE, cbor_log_commit(&log, _logBuffer));
+}
+
+TEST_F(CborphineLogTest, GroupCommit)
+{
+    cbor_log_t log;
+    std::vector<uint8_t> record = fromHex("01");
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_log(&log, _fd, _logBuffer, sizeof(_logBuffer), 8, 3, 0));
+    ASSERT_EQ(CBOR_TRUE, cbor_log_append(&log, record.data(), record.size()));
+    ASSERT_EQ(CBOR_TRUE, cbor_log_append(&log, record.data(), record.size()));
+    ASSERT_TRUE(readFile().empty());
+
+    ASSERT_EQ(CBOR_TRUE, cbor_log_append(&log, record.data(), record.size()));
+    ASSERT_EQ(concat(concat(frame("01"), frame("01")), frame("01")), readFile());
+    ASSERT_EQ(0u, log.records);
+}
+
+TEST_F(CborphineLogTest, EmptyRecord)
+{
+    cbor_log_t log;
+    uint8_t *pos;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_log(&log, _fd, _logBuffer, sizeof(_logBuffer), 8, 0, 0));
+    pos = cbor_log_reserve(&log, 4);
+    ASSERT_TRUE(pos != NULL);
+    ASSERT_EQ(CBOR_FALSE, cbor_log_commit(&log, pos));
+}
+
+TEST_F(CborphineLogTest, RecoverAndContinue)
+{
+    cbor_log_t log;
+    cbor_base_uint_t size = 0;
+    std::vector<uint8_t> records = concat(frame("63 61 62 63"), frame("82 01 02"));
+    std::vector<uint8_t> torn = frame("a1 61 61 78");
+
+    // the last record is torn
+    torn.resize(torn.size() - 2);
+    writeFile(concat(records, torn));
+
+    ASSERT_EQ(CBOR_TRUE, cbor_log_recover(_fd, _logBuffer, 16, &size));
+    ASSERT_EQ(records.size(), size);
+    ASSERT_EQ(records, readFile());
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_log(&log, _fd, _logBuffer, sizeof(_logBuffer), 8, 0, size));
+    ASSERT_EQ(CBOR_TRUE, cbor_log_append(&log, fromHex("f5").data(), 1));
+    ASSERT_EQ(CBOR_TRUE, cbor_log_flush(&log));
+    ASSERT_EQ(concat(records, frame("f5")), readFile());
+}
+
+TEST_F(CborphineLogTest, RecoverZeroFilledTail)
+{
+    cbor_base_uint_t size = 0;
+
+    writeFile(concat(frame("01"), std::vector<uint8_t>(40, 0)));
+    ASSERT_EQ(CBOR_TRUE, cbor_log_recover(_fd, _logBuffer, sizeof(_logBuffer), &size));
+    ASSERT_EQ(frame("01"), readFile());
+}
+
+TEST_F(CborphineLogTest, RecoverCorruptedRecord)
+{
+    cbor_base_uint_t size = 0;
+    std::vector<uint8_t> corrupted = frame("63 61 62 63");
+
+    corrupted[5] ^= 1;
+    writeFile(concat(concat(frame("01"), corrupted), frame("02")));
+    ASSERT_EQ(CBOR_TRUE, cbor_log_recover(_fd, _logBuffer, sizeof(_logBuffer), &size));
+    ASSERT_EQ(frame("01"), readFile());
+}
+
+TEST_F(CborphineLogTest, RecoverMalformedRecord)
+{
+    cbor_base_uint_t size = 0;
+
+    // the checksum is right, but the array is incomplete
+    writeFile(concat(frame("01"), frame("82 01")));
+    ASSERT_EQ(CBOR_TRUE, cbor_log_recover(_fd, _logBuffer, sizeof(_logBuffer), &size));
+    ASSERT_EQ(frame("01"), readFile());
+}
+
+TEST_F(CborphineLogTest, RecoverGarbageLargerThanBuffer)
+{
+    cbor_base_uint_t size = 0;
+
+    writeFile(concat(frame("01"), std::vector<uint8_t>(100, 0xff)));
+    ASSERT_EQ(CBOR_TRUE, cbor_log_recover(_fd, _logBuffer, sizeof(_logBuffer), &size));
+    ASSERT_EQ(9u, size);
+    ASSERT_EQ(frame("01"), readFile());
+}
@@ -0,0 +1,29 @@
+#ifndef CBORPHINE_LOG_TEST_H
+#define CBORPHINE_LOG_TEST_H
+
+#include <cstdio>
+#include "cborphine-test.h"
+
+class CborphineLogTest : public CborphineTest
+{
+public: // ::testing::Test
+
+    virtual void SetUp();
+
+    virtual void TearDown();
+
+protected:
+
+    std::vector<uint8_t> readFile();
+    void writeFile(const std::vector<uint8_t>& data);
+
+    static std::vector<uint8_t> frame(const std::string& record); // as written by the log
+
+protected:
+
+    FILE*   _file;
+    int     _fd;
+    uint8_t _logBuffer[32];
+};
+
+#endif // CBORPHINE_LOG_TEST_H
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <atomic>
+#include "cborphine-parallel-test.h"
+
+static const cbor_base_uint_t values[] = { 1, 100, 1000, 100000, 10000000000ull };
+
+cbor_bool_t CborphineParallelTest::writeElement(uint8_t **data, size_t size, size_t index, void *ctx)
+{
+    // elements grow with the index: 1, 2, 3, 5 and 9 bytes
+    const cbor_base_uint_t *values = (const cbor_base_uint_t *)ctx;
+    return cbor_write_uint(data, size, values[index % 5]);
+}
+
+void CborphineParallelTest::writeSequential(size_t count)
+{
+    uint8_t *data = &_expected[0];
+
+    ASSERT_EQ(CBOR_TRUE, cbor_write_array(&data, _expected.size(), count));
+    for (size_t i = 0; i < count; ++i)
+        ASSERT_EQ(CBOR_TRUE, writeElement(&data, _expected.size() - (data - &_expected[0]), i, (void *)values));
+}
+
+void CborphineParallelTest::ignoreScratch()
+{
+    std::copy(_buffer.begin() + (_data - &_buffer[0]), _buffer.end(), _expected.begin() + (_data - &_buffer[0]));
+}
+
+TEST_F(CborphineParallelTest, Sequential)
+{
+    writeSequential(10);
+    ASSERT_EQ(CBOR_TRUE, cbor_write_array_parallel(&_data, _size, 10, writeElement, (void *)values, _scratch, sizeof(_scratch), 1));
+    ASSERT_EQ(&_buffer[1 + 2 * (1 + 2 + 3 + 5 + 9)], _data);
+}
+
+TEST_F(CborphineParallelTest, WithoutScratch)
+{
+    writeSequential(10);
+    ASSERT_EQ(CBOR_TRUE, cbor_write_array_parallel(&_data, _size, 10, writeElement, (void *)values, NULL, 0, 4));
+    ASSERT_EQ(&_buffer[1 + 2 * (1 + 2 + 3 + 5 + 9)], _data);
+}
+
+TEST_F(CborphineParallelTest, Threads)
+{
+    writeSequential(500);
+    ASSERT_EQ(CBOR_TRUE, cbor_write_array_parallel(&_data, _size, 500, writeElement, (void *)values, _scratch, sizeof(_scratch), 4));
+    ASSERT_EQ(&_buffer[3 + 100 * (1 + 2 + 3 + 5 + 9)], _data);
+}
+
+TEST_F(CborphineParallelTest, MoreThreadsThanElements)
+{
+    writeSequential(3);
+    ASSERT_EQ(CBOR_TRUE, cbor_write_array_parallel(&_data, _size, 3, writeElement, (void *)values, _scratch, sizeof(_scratch), 8));
+    ASSERT_EQ(&_buffer[1 + 1 + 2 + 3], _data);
+}
+
+TEST_F(CborphineParallelTest, OncePerElement)
+{
+    // the buffer fits the array exactly, elements are never written again
+    std::atomic<size_t> calls(0);
+    cbor_write_element_t writeCounted = [](uint8_t **data, size_t size, size_t index, void *ctx) -> cbor_bool_t
+    {
+        ++*(std::atomic<size_t> *)ctx;
+        return cbor_write_uint(data, size, index % 24);
+    };
+    uint8_t *data = &_expected[0];
+
+    ASSERT_EQ(CBOR_TRUE, cbor_write_array(&data, _expected.size(), 1000));
+    for (size_t i = 0; i < 1000; ++i)
+        ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&data, _expected.size() - (data - &_expected[0]), i % 24));
+
+    ASSERT_EQ(CBOR_TRUE, cbor_write_array_parallel(&_data, 3 + 1000, 1000, writeCounted, &calls, _scratch, 1000, 3));
+    ASSERT_EQ(&_buffer[3 + 1000], _data);
+    ASSERT_EQ(1000u, calls.load());
+}
+
+TEST_F(CborphineParallelTest, PartOverflow)
+{
+    // the whole array fits, but the second part does not fit into its slice of scratch
+    static const cbor_base_uint_t skewed[] = { 1, 1, 10000000000ull, 10000000000ull };
+
+    setExpected("84 01 01 1b 00 00 00 02 54 0b e4 00 1b 00 00 00 02 54 0b e4 00");
+    ASSERT_EQ(CBOR_TRUE, cbor_write_array_parallel(&_data, 21, 4, [](uint8_t **data, size_t size, size_t index, void *ctx) -> cbor_bool_t
+    {
+        return cbor_write_uint(data, size, ((const cbor_base_uint_t *)ctx)[index]);
+    }, (void *)skewed, _scratch, 10, 2));
+    ASSERT_EQ(&_buffer[21], _data);
+}
+
+TEST_F(CborphineParallelTest, PartOverflowInsideElement)
+{
+    // the second part runs out of scratch after the header and index of [3, 20 chars]
+    cbor_write_element_t writePair = [](uint8_t **data, size_t size, size_t index, void *ctx) -> cbor_bool_t
+    {
+        uint8_t *end = *data + size;
+        (void)ctx;
+        return cbor_write_array(data, end - *data, 2) &&
+               cbor_write_uint(data, end - *data, index) &&
+               cbor_write_string(data, end - *data, index < 2 ? "" : "abcdefghijklmnopqrst") ? CBOR_TRUE : CBOR_FALSE;
+    };
+    uint8_t *data = &_expected[0];
+
+    ASSERT_EQ(CBOR_TRUE, cbor_write_array(&data, 53, 4));
+    for (size_t i = 0; i < 4; ++i)
+        ASSERT_EQ(CBOR_TRUE, writePair(&data, 53 - (data - &_expected[0]), i, NULL));
+
+    ASSERT_EQ(CBOR_TRUE, cbor_write_array_parallel(&_data, 53, 4, writePair, NULL, _scratch, 30, 2));
+    ASSERT_EQ(&_buffer[53], _data);
+}
+
+TEST_F(CborphineParallelTest, NoSpace)
+{
+    uint8_t *pos = _data;
+
+    ASSERT_EQ(CBOR_FALSE, cbor_write_array_parallel(&_data, 30, 10, writeElement, (void *)values, _scratch, sizeof(_scratch), 4));
+    ASSERT_EQ(pos, _data);
+    ignoreScratch();
+}
@@ -0,0 +1,19 @@
+#ifndef CBORPHINE_PARALLEL_TEST_H
+#define CBORPHINE_PARALLEL_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineParallelTest : public CborphineTest
+{
+protected:
+
+    static cbor_bool_t writeElement(uint8_t **data, size_t size, size_t index, void *ctx);
+
+    void writeSequential(size_t count);
+
+    void ignoreScratch(); // bytes after the position are the remains of a failed write
+
+    uint8_t _scratch[4096];
+};
+
+#endif // CBORPHINE_PARALLEL_TEST_H
@@ -0,0 +1,224 @@
+#include <cstring>
+#include <sstream>
+#include "cbor.hpp"
+#include "cborphine-parse-test.h"
+
+namespace
+{
+
+std::ostringstream& events(void* ctx)
+{
+    return *static_cast<std::ostringstream*>(ctx);
+}
+
+cbor_bool_t onUInt(void* ctx, cbor_base_uint_t value)
+{
+    events(ctx) << "uint(" << value << ") ";
+    return CBOR_TRUE;
+}
+
+cbor_bool_t onInt(void* ctx, cbor_base_int_t value)
+{
+    events(ctx) << "int(" << value << ") ";
+    return CBOR_TRUE;
+}
+
+cbor_bool_t onFloat(void* ctx, double value)
+{
+    events(ctx) << "float(" << value << ") ";
+    return CBOR_TRUE;
+}
+
+cbor_bool_t onBoolean(void* ctx, cbor_bool_t value)
+{
+    events(ctx) << (value ? "true " : "false ");
+    return CBOR_TRUE;
+}
+
+cbor_bool_t onNull(void* ctx)
+{
+    events(ctx) << "null ";
+    return CBOR_TRUE;
+}
+
+cbor_bool_t onString(void* ctx, const char* str, size_t strLength)
+{
+    events(ctx) << "string(" << std::string(str, strLength) << ") ";
+    return strLength != 4 || std::string(str, strLength) != "stop";
+}
+
+cbor_bool_t onBytes(void* ctx, const uint8_t*, size_t bytesSize)
+{
+    events(ctx) << "bytes(" << bytesSize << ") ";
+    return CBOR_TRUE;
+}
+
+cbor_bool_t onArrayStart(void* ctx, cbor_base_uint_t arraySize)
+{
+    events(ctx) << "array(" << arraySize << ") ";
+    return CBOR_TRUE;
+}
+
+cbor_bool_t onArrayEnd(void* ctx)
+{
+    events(ctx) << "/array ";
+    return CBOR_TRUE;
+}
+
+cbor_bool_t onMapStart(void* ctx, cbor_base_uint_t mapSize)
+{
+    events(ctx) << "map(" << mapSize << ") ";
+    return CBOR_TRUE;
+}
+
+cbor_bool_t onMapEnd(void* ctx)
+{
+    events(ctx) << "/map ";
+    return CBOR_TRUE;
+}
+
+cbor_bool_t onTag(void* ctx, cbor_base_uint_t tag)
+{
+    events(ctx) << "tag(" << tag << ") ";
+    return CBOR_TRUE;
+}
+
+void onError(void* ctx, const char* errorMessage)
+{
+    events(ctx) << "error(" << errorMessage << ") ";
+}
+
+struct RecordingHandler : cborphine::handler
+{
+    std::ostringstream stream;
+
+    bool on_uint(cbor_base_uint_t value) { return onUInt(&stream, value) != CBOR_FALSE; }
+    bool on_int(cbor_base_int_t value) { return onInt(&stream, value) != CBOR_FALSE; }
+    bool on_float(double value) { return onFloat(&stream, value) != CBOR_FALSE; }
+    bool on_boolean(bool value) { return onBoolean(&stream, value) != CBOR_FALSE; }
+    bool on_null() { return onNull(&stream) != CBOR_FALSE; }
+    bool on_string(const char* str, size_t strLength) { return onString(&stream, str, strLength) != CBOR_FALSE; }
+    bool on_bytes(const uint8_t* bytes, size_t bytesSize) { return onBytes(&stream, bytes, bytesSize) != CBOR_FALSE; }
+    bool on_array_start(cbor_base_uint_t arraySize) { return onArrayStart(&stream, arraySize) != CBOR_FALSE; }
+    bool on_array_end() { return onArrayEnd(&stream) != CBOR_FALSE; }
+    bool on_map_start(cbor_base_uint_t mapSize) { return onMapStart(&stream, mapSize) != CBOR_FALSE; }
+    bool on_map_end() { return onMapEnd(&stream) != CBOR_FALSE; }
+    bool on_tag(cbor_base_uint_t tag) { return onTag(&stream, tag) != CBOR_FALSE; }
+    void on_error(const char* errorMessage) { onError(&stream, errorMessage); }
+};
+
+} // namespace
+
+std::string CborphineParseTest::parse(const std::string& value, bool expectedResult)
+{
+    cbor_callbacks_t callbacks;
+    memset(&callbacks, 0, sizeof(callbacks));
+    callbacks.on_uint = onUInt;
+    callbacks.on_int = onInt;
+    callbacks.on_float = onFloat;
+    callbacks.on_boolean = onBoolean;
+    callbacks.on_null = onNull;
+    callbacks.on_string = onString;
+    callbacks.on_bytes = onBytes;
+    callbacks.on_array_start = onArrayStart;
+    callbacks.on_array_end = onArrayEnd;
+    callbacks.on_map_start = onMapStart;
+    callbacks.on_map_end = onMapEnd;
+    callbacks.on_tag = onTag;
+    callbacks.on_error = onError;
+
+    std::vector<uint8_t> data = fromHex(value);
+    std::ostringstream stream;
+
+    EXPECT_EQ(expectedResult ? CBOR_TRUE : CBOR_FALSE, cbor_parse(data.data(), data.size(), &callbacks, &stream));
+
+    std::string result = stream.str();
+    return result.empty() ? result : result.substr(0, result.size() - 1);
+}
+
+std::string CborphineParseTest::parseWithHandler(const std::string& value, bool expectedResult)
+{
+    std::vector<uint8_t> data = fromHex(value);
+    RecordingHandler handler;
+
+    EXPECT_EQ(expectedResult, cborphine::parse(data.data(), data.size(), handler));
+
+    std::string result = handler.stream.str();
+    return result.empty() ? result : result.substr(0, result.size() - 1);
+}
+
+TEST_F(CborphineParseTest, Scalars)
+{
+    ASSERT_EQ("uint(1) int(-500) true null float(1.5) string(a) bytes(2)",
+              parse("01 39 01 f3 f5 f6 fb 3f f8 00 00 00 00 00 00 61 61 42 01 02"));
+}
+
+TEST_F(CborphineParseTest, NestedContainers)
+{
+    // {"a": [1, [], {}], "b": {"c": 2}}, 3
+    ASSERT_EQ("map(2) string(a) array(3) uint(1) array(0) /array map(0) /map /array "
+              "string(b) map(1) string(c) uint(2) /map /map uint(3)",
+              parse("a2 61 61 83 01 80 a0 61 62 a1 61 63 02 03"));
+}
+
+TEST_F(CborphineParseTest, TaggedItems)
+{
+    // [1(1363896240), 2]
+    ASSERT_EQ("array(2) tag(1) uint(1363896240) uint(2) /array",
+              parse("82 c1 1a 51 4b 67 b0 02"));
+}
+
+TEST_F(CborphineParseTest, Empty)
+{
+    ASSERT_EQ("", parse(""));
+}
+
+TEST_F(CborphineParseTest, TruncatedContainer)
+{
+    ASSERT_EQ("array(2) uint(1) error(insufficient data)", parse("82 01", false));
+}
+
+TEST_F(CborphineParseTest, TruncatedString)
+{
+    ASSERT_EQ("array(1) error(insufficient data)", parse("81 63 61 62", false));
+}
+
+TEST_F(CborphineParseTest, DanglingTag)
+{
+    ASSERT_EQ("tag(1) error(insufficient data)", parse("c1", false));
+}
+
+TEST_F(CborphineParseTest, StopFromCallback)
+{
+    ASSERT_EQ("array(3) uint(1) string(stop)", parse("83 01 64 73 74 6f 70 02", false));
+}
+
+TEST_F(CborphineParseTest, MaximumNestingDepth)
+{
+    std::string value;
+    for (int i = 0; i <= CBOR_MAX_NESTING_DEPTH; ++i)
+        value += "81";
+    value += "01";
+
+    std::string result = parse(value, false);
+    ASSERT_EQ("error(maximum nesting depth exceeded)", result.substr(result.rfind("error")));
+}
+
+TEST_F(CborphineParseTest, HandlerMatchesCallbacks)
+{
+    const char* values[] =
+    {
+        "01 39 01 f3 f5 f6 fb 3f f8 00 00 00 00 00 00 61 61 42 01 02",
+        "a2 61 61 83 01 80 a0 61 62 a1 61 63 02 03",
+        "82 c1 1a 51 4b 67 b0 02",
+        "83 01 64 73 74 6f 70 02"
+    };
+
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+    {
+        bool expectedResult = (i != 3);
+        ASSERT_EQ(parse(values[i], expectedResult), parseWithHandler(values[i], expectedResult));
+    }
+
+    ASSERT_EQ("array(2) uint(1) error(insufficient data)", parseWithHandler("82 01", false));
+}
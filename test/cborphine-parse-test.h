@@ -0,0 +1,17 @@
+#ifndef CBORPHINE_PARSE_TEST_H
+#define CBORPHINE_PARSE_TEST_H
+
+#include <string>
+#include "cborphine-test.h"
+
+class CborphineParseTest : public CborphineTest
+{
+protected:
+
+    // parses hex data and returns parsed events separated by spaces
+    std::string parse(const std::string& value, bool expectedResult = true);
+
+    std::string parseWithHandler(const std::string& value, bool expectedResult = true);
+};
+
+#endif // CBORPHINE_PARSE_TEST_H
@@ -0,0 +1,87 @@
+#include "cborphine-project-test.h"
+
+// {"ts": 1000, "user": {"id": 7, "name": "bob", "tags": [1, 2]}, "body": h'0102', 1: 2, "level": "warn"}
+static const char* eventHex =
+    "a5 62 74 73 19 03 e8 64 75 73 65 72 a3 62 69 64 07 64 6e 61 6d 65 63 62 6f 62"
+    "64 74 61 67 73 82 01 02 64 62 6f 64 79 42 01 02 01 02 65 6c 65 76 65 6c 64 77 61 72 6e";
+
+TEST_F(CborphineProjectTest, TopLevelKeys)
+{
+    std::vector<uint8_t> data = fromHex(eventHex);
+    const char* paths[] = { "level", "ts", "missing" };
+
+    setExpected("a2 62 74 73 19 03 e8 65 6c 65 76 65 6c 64 77 61 72 6e");
+    ASSERT_EQ(CBOR_TRUE, cbor_project(data.data(), data.size(), paths, 3, &_data, _size));
+}
+
+TEST_F(CborphineProjectTest, NestedKeys)
+{
+    std::vector<uint8_t> data = fromHex(eventHex);
+    const char* paths[] = { "user.tags", "user.id", "body" };
+
+    setExpected("a2 64 75 73 65 72 a2 62 69 64 07 64 74 61 67 73 82 01 02 64 62 6f 64 79 42 01 02");
+    ASSERT_EQ(CBOR_TRUE, cbor_project(data.data(), data.size(), paths, 3, &_data, _size));
+}
+
+TEST_F(CborphineProjectTest, WholeMapWinsOverNestedKeys)
+{
+    std::vector<uint8_t> data = fromHex(eventHex);
+    const char* paths[] = { "user.name", "user" };
+
+    setExpected("a1 64 75 73 65 72 a3 62 69 64 07 64 6e 61 6d 65 63 62 6f 62 64 74 61 67 73 82 01 02");
+    ASSERT_EQ(CBOR_TRUE, cbor_project(data.data(), data.size(), paths, 2, &_data, _size));
+}
+
+TEST_F(CborphineProjectTest, NestedMapsWithoutKeysAreOmitted)
+{
+    std::vector<uint8_t> data = fromHex(eventHex);
+    const char* paths[] = { "user.missing", "ts.value" };
+
+    ASSERT_EQ(CBOR_TRUE, cbor_project(data.data(), data.size(), paths, 2, &_data, _size));
+    ASSERT_EQ(1, _data - &_buffer[0]);
+    ASSERT_EQ(0xa0, _buffer[0]);
+    _expected = _buffer; // omitted data after the projection is not used
+}
+
+TEST_F(CborphineProjectTest, KeyWithEmbeddedZero)
+{
+    // {"ab\0cd": 1, "ab": 2}
+    std::vector<uint8_t> data = fromHex("a2 65 61 62 00 63 64 01 62 61 62 02");
+    const char* paths[] = { "ab", "ab.cd" };
+
+    setExpected("a1 62 61 62 02");
+    ASSERT_EQ(CBOR_TRUE, cbor_project(data.data(), data.size(), paths, 2, &_data, _size));
+}
+
+TEST_F(CborphineProjectTest, InsufficientBufferSize)
+{
+    std::vector<uint8_t> data = fromHex(eventHex);
+    const char* paths[] = { "user" };
+
+    ASSERT_EQ(CBOR_FALSE, cbor_project(data.data(), data.size(), paths, 1, &_data, 10));
+    ASSERT_EQ(&_buffer[0], _data);
+    _expected = _buffer; // partially written data is not used
+}
+
+TEST_F(CborphineProjectTest, MalformedSource)
+{
+    std::vector<uint8_t> data = fromHex("a2 62 74 73 19 03 e8 64 75 73 65");
+    const char* paths[] = { "ts" };
+
+    ASSERT_EQ(CBOR_FALSE, cbor_project(data.data(), data.size(), paths, 1, &_data, _size));
+    _expected = _buffer; // partially written data is not used
+}
+
+TEST_F(CborphineProjectTest, DuplicateKeys)
+{
+    // 24 times "a": 1, the header has room for a single key
+    std::string hex = "b8 18";
+    for (int i = 0; i < 24; ++i)
+        hex += " 61 61 01";
+    std::vector<uint8_t> data = fromHex(hex);
+    const char* paths[] = { "a" };
+
+    ASSERT_EQ(CBOR_FALSE, cbor_project(data.data(), data.size(), paths, 1, &_data, _size));
+    ASSERT_EQ(&_buffer[0], _data);
+    _expected = _buffer; // partially written data is not used
+}
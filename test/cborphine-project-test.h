@@ -0,0 +1,11 @@
+#ifndef CBORPHINE_PROJECT_TEST_H
+#define CBORPHINE_PROJECT_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineProjectTest : public CborphineTest
+{
+
+};
+
+#endif // CBORPHINE_PROJECT_TEST_H
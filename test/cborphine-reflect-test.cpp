@@ -0,0 +1,190 @@
+#include <cstdio>
+#include "cbor.hpp"
+#include "cborphine-reflect-test.h"
+
+struct ReflectedPoint
+{
+    int32_t x;
+    int32_t y;
+};
+
+struct ReflectedShape
+{
+    uint16_t                id;
+    std::string             name;
+    bool                    visible;
+    double                  scale;
+    std::vector<uint32_t>   colors;
+    ReflectedPoint          origin;
+};
+
+CBORPHINE_FIELDS(ReflectedPoint,
+                 CBORPHINE_FIELD(ReflectedPoint, x),
+                 CBORPHINE_FIELD(ReflectedPoint, y))
+
+CBORPHINE_FIELDS(ReflectedShape,
+                 CBORPHINE_FIELD(ReflectedShape, id),
+                 CBORPHINE_FIELD(ReflectedShape, name),
+                 CBORPHINE_FIELD(ReflectedShape, visible),
+                 CBORPHINE_FIELD(ReflectedShape, scale),
+                 CBORPHINE_FIELD(ReflectedShape, colors),
+                 CBORPHINE_FIELD(ReflectedShape, origin))
+
+static ReflectedShape makeShape()
+{
+    ReflectedShape shape;
+    shape.id = 500;
+    shape.name = "box";
+    shape.visible = true;
+    shape.scale = 1.5;
+    shape.colors.push_back(1);
+    shape.colors.push_back(1000);
+    shape.origin.x = 10;
+    shape.origin.y = -10;
+    return shape;
+}
+
+static const char* shapeHex =
+    "a6 62 69 64 19 01 f4 64 6e 61 6d 65 63 62 6f 78 67 76 69 73 69 62 6c 65 f5"
+    "65 73 63 61 6c 65 fb 3f f8 00 00 00 00 00 00 66 63 6f 6c 6f 72 73 82 01 19 03 e8"
+    "66 6f 72 69 67 69 6e a2 61 78 0a 61 79 29";
+
+TEST_F(CborphineReflectTest, KeysAreEncodedAtCompileTime)
+{
+    constexpr cborphine::detail::key<5> key("name");
+    static_assert(key.bytes.size() == 5, "key header is injected into initial byte");
+    static_assert(key.bytes[0] == 0x64 && key.bytes[1] == 'n', "key is encoded as text string");
+}
+
+TEST_F(CborphineReflectTest, Encode)
+{
+    setExpected(shapeHex);
+    ASSERT_TRUE(cborphine::encode(&_data, _size, makeShape()));
+}
+
+TEST_F(CborphineReflectTest, EncodeWithInsufficientBufferSize)
+{
+    ASSERT_FALSE(cborphine::encode(&_data, 30, makeShape()));
+    ASSERT_EQ(&_buffer[0], _data);
+    _expected = _buffer; // partially written data is not used
+}
+
+TEST_F(CborphineReflectTest, Decode)
+{
+    std::vector<uint8_t> data = fromHex(shapeHex);
+    ReflectedShape expected = makeShape();
+    ReflectedShape shape;
+    cbor_token_t token;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, data.data(), data.size(), CBOR_TRUE));
+    ASSERT_TRUE(cborphine::decode(&token, shape));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_END, token.type);
+
+    ASSERT_EQ(expected.id, shape.id);
+    ASSERT_EQ(expected.name, shape.name);
+    ASSERT_EQ(expected.visible, shape.visible);
+    ASSERT_EQ(expected.scale, shape.scale);
+    ASSERT_EQ(expected.colors, shape.colors);
+    ASSERT_EQ(expected.origin.x, shape.origin.x);
+    ASSERT_EQ(expected.origin.y, shape.origin.y);
+}
+
+TEST_F(CborphineReflectTest, DecodeSkipsUnknownKeys)
+{
+    // {"z": [1, {"a": 2}], 1: 2, "y": 5, "x": 6}
+    std::vector<uint8_t> data = fromHex("a4 61 7a 82 01 a1 61 61 02 01 02 61 79 05 61 78 06");
+    ReflectedPoint point = {};
+    cbor_token_t token;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, data.data(), data.size(), CBOR_FALSE));
+    ASSERT_TRUE(cborphine::decode(&token, point));
+    ASSERT_EQ(6, point.x);
+    ASSERT_EQ(5, point.y);
+}
+
+TEST_F(CborphineReflectTest, DecodeIntegerOverflow)
+{
+    std::vector<uint8_t> data = fromHex("a1 62 69 64 1a 00 01 00 00");
+    ReflectedShape shape;
+    cbor_token_t token;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, data.data(), data.size(), CBOR_TRUE));
+    ASSERT_FALSE(cborphine::decode(&token, shape));
+    ASSERT_STREQ("integer overflow", token.error_message);
+}
+
+TEST_F(CborphineReflectTest, DecodeHugeArrayCount)
+{
+    // {"colors": array of 2^64 - 1 items}
+    std::vector<uint8_t> data = fromHex("a1 66 63 6f 6c 6f 72 73 9b ff ff ff ff ff ff ff ff 01");
+    ReflectedShape shape;
+    cbor_token_t token;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, data.data(), data.size(), CBOR_TRUE));
+    ASSERT_FALSE(cborphine::decode(&token, shape));
+    ASSERT_STREQ("insufficient data", token.error_message);
+    ASSERT_EQ(2u, shape.colors.size()); // the item that was not read is the last one
+}
+
+TEST_F(CborphineReflectTest, RoundTripVectorOfBool)
+{
+    std::vector<bool> expected = { true, false, true };
+    std::vector<bool> flags;
+    cbor_token_t token;
+
+    setExpected("83 f5 f4 f5");
+    ASSERT_TRUE(cborphine::detail::write_value(&_data, _size, expected));
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, &_buffer[0], 4, CBOR_TRUE));
+    ASSERT_TRUE(cborphine::detail::read_value(&token, flags));
+    ASSERT_EQ(expected, flags);
+}
+
+TEST_F(CborphineReflectTest, DecodeStreamedString)
+{
+    // {"name": 40 chars, "id": 7} read through a window smaller than the name
+    std::string name = "abcdefghijklmnopqrstuvwxyz0123456789ABCD";
+    std::vector<uint8_t> data = fromHex("a2 64 6e 61 6d 65 78 28");
+    std::vector<uint8_t> id = fromHex("62 69 64 07");
+    FILE *file = tmpfile();
+    uint8_t window[16];
+    cbor_source_t source;
+    ReflectedShape shape;
+    cbor_token_t token;
+
+    data.insert(data.end(), name.begin(), name.end());
+    data.insert(data.end(), id.begin(), id.end());
+
+    ASSERT_TRUE(file != NULL);
+    fwrite(data.data(), 1, data.size(), file);
+    fseek(file, 0, SEEK_SET);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read_source(&token, &source, cbor_refill_file, file, window, sizeof(window), CBOR_TRUE));
+    ASSERT_TRUE(cborphine::decode(&token, shape));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_END, token.type);
+    ASSERT_EQ(name, shape.name);
+    ASSERT_EQ(7u, shape.id);
+
+    fclose(file);
+}
+
+TEST_F(CborphineReflectTest, DecodeStreamedKey)
+{
+    // keys larger than the window of a refillable source aren't matched in chunks
+    std::vector<uint8_t> data = fromHex("a1 78 14 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 01");
+    FILE *file = tmpfile();
+    uint8_t window[16];
+    cbor_source_t source;
+    ReflectedShape shape;
+    cbor_token_t token;
+
+    ASSERT_TRUE(file != NULL);
+    fwrite(data.data(), 1, data.size(), file);
+    fseek(file, 0, SEEK_SET);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read_source(&token, &source, cbor_refill_file, file, window, sizeof(window), CBOR_TRUE));
+    ASSERT_FALSE(cborphine::decode(&token, shape));
+    ASSERT_STREQ("key larger than window", token.error_message);
+
+    fclose(file);
+}
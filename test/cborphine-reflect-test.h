@@ -0,0 +1,11 @@
+#ifndef CBORPHINE_REFLECT_TEST_H
+#define CBORPHINE_REFLECT_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineReflectTest : public CborphineTest
+{
+
+};
+
+#endif // CBORPHINE_REFLECT_TEST_H
@@ -0,0 +1,54 @@
+#include <cstring>
+#include "cborphine-reserve-test.h"
+
+TEST_F(CborphineReserveTest, CommitKeepsHeaderWidth)
+{
+    setExpected("59 00 03 61 62 63 01");
+    ASSERT_EQ(CBOR_TRUE, cbor_write_bytes_reserve(&_data, _size, 300, &_reservation));
+    ASSERT_EQ(&_buffer[0], _data);
+    ASSERT_EQ(&_buffer[3], _reservation.payload);
+
+    memcpy(_reservation.payload, "abc", 3);
+    ASSERT_EQ(CBOR_TRUE, cbor_write_commit(&_data, &_reservation, 3, CBOR_FALSE));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&_data, _size - 6, 1));
+}
+
+TEST_F(CborphineReserveTest, CommitCompacted)
+{
+    setExpected("63 61 62 63 01");
+    ASSERT_EQ(CBOR_TRUE, cbor_write_string_reserve(&_data, _size, 300, &_reservation));
+
+    memcpy(_reservation.payload, "abc", 3);
+    ASSERT_EQ(CBOR_TRUE, cbor_write_commit(&_data, &_reservation, 3, CBOR_TRUE));
+    ASSERT_EQ(&_buffer[4], _data);
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&_data, _size - 4, 1));
+
+    _buffer[5] = _buffer[6] = 0; // moved payload leaves stale bytes
+}
+
+TEST_F(CborphineReserveTest, ShortReservation)
+{
+    setExpected("42 01 02");
+    ASSERT_EQ(CBOR_TRUE, cbor_write_bytes_reserve(&_data, _size, 10, &_reservation));
+    ASSERT_EQ(&_buffer[1], _reservation.payload);
+
+    _reservation.payload[0] = 1;
+    _reservation.payload[1] = 2;
+    ASSERT_EQ(CBOR_TRUE, cbor_write_commit(&_data, &_reservation, 2, CBOR_FALSE));
+    ASSERT_EQ(&_buffer[3], _data);
+}
+
+TEST_F(CborphineReserveTest, CommitMoreThanReserved)
+{
+    ASSERT_EQ(CBOR_TRUE, cbor_write_bytes_reserve(&_data, _size, 10, &_reservation));
+    ASSERT_EQ(CBOR_FALSE, cbor_write_commit(&_data, &_reservation, 11, CBOR_FALSE));
+    ASSERT_EQ(&_buffer[0], _data);
+}
+
+TEST_F(CborphineReserveTest, ReserveWithInsufficientBufferSize)
+{
+    ASSERT_EQ(CBOR_FALSE, cbor_write_bytes_reserve(&_data, 300, 300, &_reservation));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_bytes_reserve(&_data, 303, 300, &_reservation));
+    ASSERT_EQ(CBOR_FALSE, cbor_write_string_reserve(&_data, 0, 0, &_reservation));
+    ASSERT_EQ(&_buffer[0], _data);
+}
@@ -0,0 +1,13 @@
+#ifndef CBORPHINE_RESERVE_TEST_H
+#define CBORPHINE_RESERVE_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineReserveTest : public CborphineTest
+{
+protected:
+
+    cbor_reservation_t _reservation;
+};
+
+#endif // CBORPHINE_RESERVE_TEST_H
@@ -0,0 +1,193 @@
+#include <thread>
+#include "cborphine-ring-test.h"
+
+void CborphineRingTest::SetUp()
+{
+    CborphineTest::SetUp();
+
+    memset(_memory, 0xAA, sizeof(_memory));
+}
+
+void CborphineRingTest::produce(cbor_base_uint_t producer, cbor_base_uint_t value)
+{
+    uint8_t *message;
+    uint8_t *pos;
+
+    while ((message = cbor_ring_reserve(&_ring, 16)) == NULL)
+        std::this_thread::yield();
+
+    pos = message;
+    cbor_write_array(&pos, 16, 2);
+    cbor_write_uint(&pos, 16 - (pos - message), producer);
+    cbor_write_uint(&pos, 16 - (pos - message), value);
+    cbor_ring_commit(&_ring, message, pos);
+}
+
+void CborphineRingTest::consume(cbor_base_uint_t *producer, cbor_base_uint_t *value)
+{
+    const uint8_t *message;
+    size_t messageSize;
+    cbor_token_t token;
+    cbor_base_uint_t size;
+
+    while (cbor_ring_peek(&_ring, &message, &messageSize) == CBOR_FALSE)
+        std::this_thread::yield();
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, message, messageSize, CBOR_TRUE));
+    ASSERT_EQ(CBOR_TRUE, cbor_read_array(&token, &size));
+    ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&token, producer));
+    ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&token, value));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_END, token.type);
+
+    cbor_ring_release(&_ring);
+}
+
+TEST_F(CborphineRingTest, ReadInPlace)
+{
+    const uint8_t *message;
+    size_t messageSize;
+    uint8_t *pos;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_ring(&_ring, _memory, sizeof(_memory), CBOR_FALSE));
+    ASSERT_EQ(256u, _ring.capacity);
+    ASSERT_EQ(CBOR_FALSE, cbor_ring_peek(&_ring, &message, &messageSize));
+
+    pos = cbor_ring_reserve(&_ring, 32);
+    ASSERT_TRUE(pos != NULL);
+    message = pos;
+    ASSERT_EQ(CBOR_TRUE, cbor_write_string(&pos, 32, "abc"));
+
+    // nothing is visible before commit
+    ASSERT_EQ(CBOR_FALSE, cbor_ring_peek(&_ring, &message, &messageSize));
+    cbor_ring_commit(&_ring, (uint8_t *)message, pos);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_ring_peek(&_ring, &message, &messageSize));
+    ASSERT_EQ(fromHex("63 61 62 63"), std::vector<uint8_t>(message, message + messageSize));
+    ASSERT_EQ(0u, (size_t)message % 8);
+    cbor_ring_release(&_ring);
+
+    ASSERT_EQ(CBOR_FALSE, cbor_ring_peek(&_ring, &message, &messageSize));
+}
+
+TEST_F(CborphineRingTest, Full)
+{
+    ASSERT_EQ(CBOR_TRUE, cbor_init_ring(&_ring, _memory, sizeof(_memory), CBOR_FALSE));
+
+    ASSERT_TRUE(cbor_ring_reserve(&_ring, 249) == NULL);
+    ASSERT_TRUE(cbor_ring_reserve(&_ring, 248) != NULL);
+    cbor_ring_commit(&_ring, _ring.data + 8, _ring.data + 8);
+
+    ASSERT_TRUE(cbor_ring_reserve(&_ring, 1) == NULL);
+}
+
+TEST_F(CborphineRingTest, Wrap)
+{
+    cbor_ring_t consumer;
+    cbor_base_uint_t producer;
+    cbor_base_uint_t value;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_ring(&_ring, _memory, sizeof(_memory), CBOR_FALSE));
+    ASSERT_EQ(CBOR_TRUE, cbor_attach_ring(&consumer, _memory, sizeof(_memory)));
+    ASSERT_EQ(CBOR_FALSE, consumer.multi_producer);
+
+    // 24 bytes records don't divide the data, some of them are moved to the start
+    for (cbor_base_uint_t i = 0; i < 100; ++i)
+    {
+        produce(0, i);
+        if (i % 3 == 2)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                consume(&producer, &value);
+                ASSERT_EQ(i - 2 + j, value);
+            }
+        }
+    }
+}
+
+TEST_F(CborphineRingTest, InvalidMemory)
+{
+    ASSERT_EQ(CBOR_FALSE, cbor_init_ring(&_ring, _memory, CBOR_RING_HEADER_SIZE + 8, CBOR_FALSE));
+    ASSERT_EQ(CBOR_FALSE, cbor_init_ring(&_ring, (uint8_t *)_memory + 4, sizeof(_memory) - 8, CBOR_FALSE));
+    ASSERT_EQ(CBOR_FALSE, cbor_attach_ring(&_ring, _memory, sizeof(_memory)));
+}
+
+TEST_F(CborphineRingTest, InvalidSettings)
+{
+    uint32_t *settings = (uint32_t *)((uint8_t *)_memory + 2 * CBOR_CACHE_LINE_SIZE);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_ring(&_ring, _memory, sizeof(_memory), CBOR_FALSE));
+
+    settings[1] = 96; // not a power of two
+    ASSERT_EQ(CBOR_FALSE, cbor_attach_ring(&_ring, _memory, sizeof(_memory)));
+    settings[1] = 8; // no space for a record
+    ASSERT_EQ(CBOR_FALSE, cbor_attach_ring(&_ring, _memory, sizeof(_memory)));
+    settings[1] = 512; // larger than memory
+    ASSERT_EQ(CBOR_FALSE, cbor_attach_ring(&_ring, _memory, sizeof(_memory)));
+
+    settings[1] = 256;
+    settings[2] = 2;
+    ASSERT_EQ(CBOR_FALSE, cbor_attach_ring(&_ring, _memory, sizeof(_memory)));
+    settings[2] = 1;
+    ASSERT_EQ(CBOR_TRUE, cbor_attach_ring(&_ring, _memory, sizeof(_memory)));
+}
+
+TEST_F(CborphineRingTest, CorruptedRecord)
+{
+    const uint8_t *message;
+    size_t messageSize;
+    uint8_t *pos;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_ring(&_ring, _memory, sizeof(_memory), CBOR_FALSE));
+    pos = cbor_ring_reserve(&_ring, 8);
+    ASSERT_TRUE(pos != NULL);
+    cbor_ring_commit(&_ring, pos, pos + 8);
+
+    // a message larger than its slot
+    ((uint32_t *)_ring.data)[0] = 17;
+    ASSERT_EQ(CBOR_FALSE, cbor_ring_peek(&_ring, &message, &messageSize));
+
+    // a slot crossing the end of data
+    ((uint32_t *)_ring.data)[0] = 9;
+    ((uint32_t *)_ring.data)[1] = 256;
+    ASSERT_EQ(CBOR_FALSE, cbor_ring_peek(&_ring, &message, &messageSize));
+
+    ((uint32_t *)_ring.data)[1] = 8;
+    ASSERT_EQ(CBOR_TRUE, cbor_ring_peek(&_ring, &message, &messageSize));
+    ASSERT_EQ(8u, messageSize);
+    cbor_ring_release(&_ring);
+    ASSERT_EQ(CBOR_FALSE, cbor_ring_peek(&_ring, &message, &messageSize));
+}
+
+TEST_F(CborphineRingTest, ManyProducers)
+{
+    const cbor_base_uint_t producers = 4;
+    const cbor_base_uint_t messages = 10000;
+    std::vector<std::thread> threads;
+    std::vector<cbor_base_uint_t> next(producers, 0);
+    cbor_base_uint_t producer;
+    cbor_base_uint_t value;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_ring(&_ring, _memory, sizeof(_memory), CBOR_TRUE));
+
+    for (cbor_base_uint_t i = 0; i < producers; ++i)
+    {
+        threads.push_back(std::thread([this, i, messages]()
+        {
+            for (cbor_base_uint_t j = 0; j < messages; ++j)
+                produce(i, j);
+        }));
+    }
+
+    // messages of each producer are in order
+    for (cbor_base_uint_t i = 0; i < producers * messages; ++i)
+    {
+        consume(&producer, &value);
+        ASSERT_TRUE(producer < producers);
+        ASSERT_EQ(next[producer], value);
+        ++next[producer];
+    }
+
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+}
@@ -0,0 +1,23 @@
+#ifndef CBORPHINE_RING_TEST_H
+#define CBORPHINE_RING_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineRingTest : public CborphineTest
+{
+public: // ::testing::Test
+
+    virtual void SetUp();
+
+protected:
+
+    void produce(cbor_base_uint_t producer, cbor_base_uint_t value);
+    void consume(cbor_base_uint_t *producer, cbor_base_uint_t *value);
+
+protected:
+
+    uint64_t    _memory[(CBOR_RING_HEADER_SIZE + 256) / 8];
+    cbor_ring_t _ring;
+};
+
+#endif // CBORPHINE_RING_TEST_H
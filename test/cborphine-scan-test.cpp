@@ -0,0 +1,120 @@
+#include "cborphine-scan-test.h"
+
+void CborphineScanTest::SetUp()
+{
+    CborphineTest::SetUp();
+
+    writeRecord("info", 200);
+    writeRecord("warn", 404);
+    writeRecord("error", 500);
+    _records.push_back(_data - &_buffer[0]);
+    ASSERT_EQ(CBOR_TRUE, cbor_write_array(&_data, _size, 1)); // not a map
+    ASSERT_EQ(CBOR_TRUE, cbor_write_int(&_data, _size, 1));
+    writeRecord("warning", -1);
+
+    _size = _data - &_buffer[0];
+    _expected = _buffer;
+}
+
+void CborphineScanTest::writeRecord(const char* level, cbor_base_int_t code)
+{
+    _records.push_back(_data - &_buffer[0]);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_write_map(&_data, _size, 3));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_string(&_data, _size, "level"));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_string(&_data, _size, level));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_string(&_data, _size, "tags"));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_array(&_data, _size, 1));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_map(&_data, _size, 1));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_string(&_data, _size, "code"));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_int(&_data, _size, 0));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_string(&_data, _size, "code"));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_int(&_data, _size, code));
+}
+
+TEST_F(CborphineScanTest, IntRange)
+{
+    cbor_predicate_t predicate = { "code", CBOR_PREDICATE_INT_RANGE, 400, 599, NULL };
+    size_t offsets[8];
+    size_t offsetsCount = 8;
+    size_t pos = 0;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_scan(&_buffer[0], _size, &pos, &predicate, 1, offsets, &offsetsCount));
+    ASSERT_EQ(2u, offsetsCount);
+    ASSERT_EQ(_records[1], offsets[0]);
+    ASSERT_EQ(_records[2], offsets[1]);
+    ASSERT_EQ(_size, pos);
+}
+
+TEST_F(CborphineScanTest, AllPredicatesMustMatch)
+{
+    cbor_predicate_t predicates[] =
+    {
+        { "level", CBOR_PREDICATE_STRING_PREFIX, 0, 0, "warn" },
+        { "code", CBOR_PREDICATE_INT_EQUAL, -1, 0, NULL },
+        { "tags", CBOR_PREDICATE_EXISTS, 0, 0, NULL }
+    };
+    size_t offsets[8];
+    size_t offsetsCount = 8;
+    size_t pos = 0;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_scan(&_buffer[0], _size, &pos, predicates, 3, offsets, &offsetsCount));
+    ASSERT_EQ(1u, offsetsCount);
+    ASSERT_EQ(_records[4], offsets[0]);
+}
+
+TEST_F(CborphineScanTest, MissingKeyDoesNotMatch)
+{
+    cbor_predicate_t predicate = { "user", CBOR_PREDICATE_EXISTS, 0, 0, NULL };
+    size_t offsets[8];
+    size_t offsetsCount = 8;
+    size_t pos = 0;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_scan(&_buffer[0], _size, &pos, &predicate, 1, offsets, &offsetsCount));
+    ASSERT_EQ(0u, offsetsCount);
+}
+
+TEST_F(CborphineScanTest, ContinueWhenOffsetsAreFull)
+{
+    cbor_predicate_t predicate = { "level", CBOR_PREDICATE_EXISTS, 0, 0, NULL };
+    size_t offsets[2];
+    size_t offsetsCount = 2;
+    size_t pos = 0;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_scan(&_buffer[0], _size, &pos, &predicate, 1, offsets, &offsetsCount));
+    ASSERT_EQ(2u, offsetsCount);
+    ASSERT_EQ(_records[0], offsets[0]);
+    ASSERT_EQ(_records[1], offsets[1]);
+    ASSERT_EQ(_records[2], pos);
+
+    offsetsCount = 2;
+    ASSERT_EQ(CBOR_TRUE, cbor_scan(&_buffer[0], _size, &pos, &predicate, 1, offsets, &offsetsCount));
+    ASSERT_EQ(2u, offsetsCount);
+    ASSERT_EQ(_records[2], offsets[0]);
+    ASSERT_EQ(_records[4], offsets[1]);
+}
+
+TEST_F(CborphineScanTest, MalformedRecord)
+{
+    cbor_predicate_t predicate = { "level", CBOR_PREDICATE_EXISTS, 0, 0, NULL };
+    size_t offsets[8];
+    size_t offsetsCount = 8;
+    size_t pos = 0;
+
+    ASSERT_EQ(CBOR_FALSE, cbor_scan(&_buffer[0], _records[2] + 3, &pos, &predicate, 1, offsets, &offsetsCount));
+    ASSERT_EQ(2u, offsetsCount);
+    ASSERT_EQ(_records[2], pos);
+}
+
+TEST_F(CborphineScanTest, KeyWithEmbeddedZero)
+{
+    // {"ab\0cd": 1}
+    std::vector<uint8_t> data = fromHex("a1 65 61 62 00 63 64 01");
+    cbor_predicate_t predicate = { "ab", CBOR_PREDICATE_EXISTS, 0, 0, NULL };
+    size_t offsets[8];
+    size_t offsetsCount = 8;
+    size_t pos = 0;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_scan(data.data(), data.size(), &pos, &predicate, 1, offsets, &offsetsCount));
+    ASSERT_EQ(0u, offsetsCount);
+}
@@ -0,0 +1,21 @@
+#ifndef CBORPHINE_SCAN_TEST_H
+#define CBORPHINE_SCAN_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineScanTest : public CborphineTest
+{
+public: // ::testing::Test
+
+    virtual void SetUp();
+
+protected:
+
+    void writeRecord(const char* level, cbor_base_int_t code);
+
+protected:
+
+    std::vector<size_t> _records;
+};
+
+#endif // CBORPHINE_SCAN_TEST_H
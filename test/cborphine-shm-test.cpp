@@ -0,0 +1,117 @@
+#include "cborphine-shm-test.h"
+
+#ifndef _WIN32
+#include <cstdio>
+#include <sys/wait.h>
+#include <unistd.h>
+
+void CborphineShmTest::SetUp()
+{
+    CborphineTest::SetUp();
+
+    ASSERT_EQ(CBOR_TRUE, cbor_create_shared_ring(&_ring, CBOR_RING_HEADER_SIZE + 4096, CBOR_FALSE, &_fd));
+}
+
+void CborphineShmTest::TearDown()
+{
+    cbor_close_shared_ring(&_ring);
+    close(_fd);
+
+    CborphineTest::TearDown();
+}
+
+TEST_F(CborphineShmTest, ReadFromOtherMapping)
+{
+    cbor_ring_t consumer;
+    uint8_t *message;
+    uint8_t *pos;
+    const uint8_t *read;
+    size_t readSize;
+
+    ASSERT_EQ(4096u, _ring.capacity);
+    ASSERT_EQ(CBOR_TRUE, cbor_open_shared_ring(&consumer, _fd));
+    ASSERT_TRUE(consumer.memory != _ring.memory);
+
+    message = cbor_ring_reserve(&_ring, 16);
+    pos = message;
+    ASSERT_EQ(CBOR_TRUE, cbor_write_string(&pos, 16, "shared"));
+    cbor_ring_commit(&_ring, message, pos);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_ring_peek(&consumer, &read, &readSize));
+    ASSERT_EQ(fromHex("66 73 68 61 72 65 64"), std::vector<uint8_t>(read, read + readSize));
+    cbor_ring_release(&consumer);
+
+    ASSERT_EQ(CBOR_FALSE, cbor_ring_peek(&consumer, &read, &readSize));
+    cbor_close_shared_ring(&consumer);
+}
+
+TEST_F(CborphineShmTest, WaitTimeout)
+{
+    ASSERT_EQ(CBOR_FALSE, cbor_ring_wait_message(&_ring, 10));
+    ASSERT_EQ(CBOR_TRUE, cbor_ring_wait_space(&_ring, 100, 10));
+    ASSERT_EQ(CBOR_FALSE, cbor_ring_wait_space(&_ring, 4096, 10));
+}
+
+TEST_F(CborphineShmTest, OpenInvalid)
+{
+    FILE *file = tmpfile();
+    cbor_ring_t ring;
+
+    ASSERT_EQ(CBOR_FALSE, cbor_open_shared_ring(&ring, fileno(file)));
+    fclose(file);
+}
+
+TEST_F(CborphineShmTest, OtherProcess)
+{
+    const cbor_base_uint_t messages = 20000;
+    const uint8_t *read;
+    size_t readSize;
+    cbor_token_t token;
+    cbor_base_uint_t value;
+    int status;
+    pid_t pid;
+
+    pid = fork();
+    ASSERT_TRUE(pid >= 0);
+
+    if (pid == 0)
+    {
+        cbor_ring_t producer;
+
+        if (cbor_open_shared_ring(&producer, _fd) == CBOR_FALSE)
+            _exit(1);
+
+        for (cbor_base_uint_t i = 0; i < messages; ++i)
+        {
+            uint8_t *message;
+            uint8_t *pos;
+
+            // the ring is small, the producer waits for the consumer
+            while ((message = cbor_ring_reserve(&producer, 100)) == NULL)
+                cbor_ring_wait_space(&producer, 100, -1);
+
+            pos = message;
+            cbor_write_uint(&pos, 100, i);
+            cbor_ring_commit(&producer, message, pos);
+            cbor_ring_wake_reader(&producer);
+        }
+
+        _exit(0);
+    }
+
+    for (cbor_base_uint_t i = 0; i < messages; ++i)
+    {
+        ASSERT_EQ(CBOR_TRUE, cbor_ring_wait_message(&_ring, 5000));
+        ASSERT_EQ(CBOR_TRUE, cbor_ring_peek(&_ring, &read, &readSize));
+        ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, read, readSize, CBOR_TRUE));
+        ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&token, &value));
+        ASSERT_EQ(i, value);
+        cbor_ring_release(&_ring);
+        cbor_ring_wake_writers(&_ring);
+    }
+
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(0, WEXITSTATUS(status));
+}
+#endif
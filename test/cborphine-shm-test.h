@@ -0,0 +1,20 @@
+#ifndef CBORPHINE_SHM_TEST_H
+#define CBORPHINE_SHM_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineShmTest : public CborphineTest
+{
+public: // ::testing::Test
+
+    virtual void SetUp();
+
+    virtual void TearDown();
+
+protected:
+
+    cbor_ring_t _ring;
+    int         _fd;
+};
+
+#endif // CBORPHINE_SHM_TEST_H
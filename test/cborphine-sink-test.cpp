@@ -0,0 +1,239 @@
+#include <algorithm>
+#include "cborphine-sink-test.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+void CborphineSinkTest::SetUp()
+{
+    CborphineTest::SetUp();
+
+    _file = tmpfile();
+    ASSERT_TRUE(_file != NULL);
+    cbor_init_sink(&_sink, fileno(_file), _sinkBuffer, sizeof(_sinkBuffer));
+}
+
+void CborphineSinkTest::TearDown()
+{
+    fclose(_file);
+
+    CborphineTest::TearDown();
+}
+
+std::vector<uint8_t> CborphineSinkTest::readFile()
+{
+    std::vector<uint8_t> data(4096);
+
+    fseek(_file, 0, SEEK_SET);
+    data.resize(fread(&data[0], 1, data.size(), _file));
+    return data;
+}
+
+TEST_F(CborphineSinkTest, FlushWhenFull)
+{
+    for (cbor_base_uint_t i = 0; i < 5; ++i)
+    {
+        // the item isn't written partially, it's written again after flushing
+        while (cbor_write_uint(&_sink.pos, _sink.end - _sink.pos, 1000 + i) == CBOR_FALSE)
+            ASSERT_EQ(CBOR_IO_OK, cbor_sink_flush(&_sink));
+    }
+
+    ASSERT_EQ(3, _sink.pos - _sink.buffer);
+    ASSERT_EQ(CBOR_IO_OK, cbor_sink_flush(&_sink));
+    ASSERT_EQ(_sink.buffer, _sink.pos);
+
+    ASSERT_EQ(fromHex("19 03 e8 19 03 e9 19 03 ea 19 03 eb 19 03 ec"), readFile());
+}
+
+TEST_F(CborphineSinkTest, PutLargePayload)
+{
+    std::vector<uint8_t> payload(20);
+    size_t done = 0;
+
+    for (size_t i = 0; i < payload.size(); ++i)
+        payload[i] = (uint8_t)i;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_write_bytes_header(&_sink.pos, _sink.end - _sink.pos, payload.size()));
+    ASSERT_EQ(CBOR_IO_OK, cbor_sink_put(&_sink, payload.data(), payload.size(), &done));
+    ASSERT_EQ(payload.size(), done);
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&_sink.pos, _sink.end - _sink.pos, 7));
+    ASSERT_EQ(CBOR_IO_OK, cbor_sink_flush(&_sink));
+
+    ASSERT_EQ(fromHex("54 00 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f 10 11 12 13 07"), readFile());
+}
+
+#ifndef _WIN32
+TEST_F(CborphineSinkTest, BackPressure)
+{
+    std::vector<uint8_t> filler(4096, 0xF6);
+    std::vector<uint8_t> received;
+    std::vector<uint8_t> payload(100, 0x61);
+    uint8_t chunk[4096];
+    int fds[2];
+    size_t pipeSize = 0;
+    size_t done = 0;
+    ssize_t count;
+
+    ASSERT_EQ(0, pipe(fds));
+    ASSERT_EQ(0, fcntl(fds[0], F_SETFL, O_NONBLOCK));
+    ASSERT_EQ(0, fcntl(fds[1], F_SETFL, O_NONBLOCK));
+    cbor_init_sink(&_sink, fds[1], _sinkBuffer, sizeof(_sinkBuffer));
+
+    // the pipe is filled to make the descriptor block
+    while ((count = write(fds[1], filler.data(), filler.size())) > 0)
+        pipeSize += (size_t)count;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&_sink.pos, _sink.end - _sink.pos, 1000));
+    ASSERT_EQ(CBOR_IO_AGAIN, cbor_sink_flush(&_sink));
+    ASSERT_EQ(3, _sink.pos - _sink.buffer);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_write_string_header(&_sink.pos, _sink.end - _sink.pos, payload.size()));
+    ASSERT_EQ(CBOR_IO_AGAIN, cbor_sink_put(&_sink, payload.data(), payload.size(), &done));
+    ASSERT_EQ(3u, done); // the buffer is filled up
+    ASSERT_EQ(_sink.end, _sink.pos);
+
+    // the reader catches up and writing is resumed
+    while (received.size() < pipeSize)
+    {
+        count = read(fds[0], chunk, sizeof(chunk));
+        ASSERT_TRUE(count > 0);
+        received.insert(received.end(), chunk, chunk + count);
+    }
+
+    received.clear();
+    ASSERT_EQ(CBOR_IO_OK, cbor_sink_put(&_sink, payload.data(), payload.size(), &done));
+    ASSERT_EQ(payload.size(), done);
+    ASSERT_EQ(CBOR_IO_OK, cbor_sink_flush(&_sink));
+
+    while ((count = read(fds[0], chunk, sizeof(chunk))) > 0)
+        received.insert(received.end(), chunk, chunk + count);
+
+    ASSERT_EQ(105u, received.size());
+    ASSERT_EQ(fromHex("19 03 e8 78 64 61"), std::vector<uint8_t>(received.begin(), received.begin() + 6));
+    ASSERT_EQ(0x61, received.back());
+
+    close(fds[0]);
+    close(fds[1]);
+}
+#endif
+
+TEST_F(CborphineSinkTest, PutFile)
+{
+    FILE *input = tmpfile();
+    std::vector<uint8_t> content(300);
+    std::vector<uint8_t> expected = fromHex("01 59 01 00");
+    size_t done = 0;
+
+    ASSERT_TRUE(input != NULL);
+    for (size_t i = 0; i < content.size(); ++i)
+        content[i] = (uint8_t)i;
+    fwrite(content.data(), 1, content.size(), input);
+    fflush(input);
+
+    // the file is embedded without the first 10 bytes and the rest after 256 bytes
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&_sink.pos, _sink.end - _sink.pos, 1));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_bytes_header(&_sink.pos, _sink.end - _sink.pos, 256));
+    ASSERT_EQ(CBOR_IO_OK, cbor_sink_put_file(&_sink, fileno(input), 10, 256, &done));
+    ASSERT_EQ(256u, done);
+    ASSERT_EQ(CBOR_IO_OK, cbor_sink_flush(&_sink));
+
+    expected.insert(expected.end(), content.begin() + 10, content.begin() + 266);
+    ASSERT_EQ(expected, readFile());
+
+    fclose(input);
+}
+
+TEST_F(CborphineSinkTest, PutFileTooShort)
+{
+    FILE *input = tmpfile();
+    size_t done = 0;
+
+    ASSERT_TRUE(input != NULL);
+    fwrite("abc", 1, 3, input);
+    fflush(input);
+
+    ASSERT_EQ(CBOR_IO_ERROR, cbor_sink_put_file(&_sink, fileno(input), 0, 10, &done));
+    ASSERT_EQ(3u, done);
+
+    fclose(input);
+}
+
+#ifndef _WIN32
+TEST_F(CborphineSinkTest, PutFileBackPressure)
+{
+    FILE *input = tmpfile();
+    std::vector<uint8_t> content(200000);
+    std::vector<uint8_t> received;
+    uint8_t chunk[4096];
+    cbor_io_status_t status;
+    int fds[2];
+    size_t done = 0;
+    size_t again = 0;
+    ssize_t count;
+
+    ASSERT_TRUE(input != NULL);
+    for (size_t i = 0; i < content.size(); ++i)
+        content[i] = (uint8_t)(i * 7);
+    fwrite(content.data(), 1, content.size(), input);
+    fflush(input);
+
+    ASSERT_EQ(0, pipe(fds));
+    ASSERT_EQ(0, fcntl(fds[0], F_SETFL, O_NONBLOCK));
+    ASSERT_EQ(0, fcntl(fds[1], F_SETFL, O_NONBLOCK));
+    cbor_init_sink(&_sink, fds[1], _sinkBuffer, sizeof(_sinkBuffer));
+
+    ASSERT_EQ(CBOR_TRUE, cbor_write_bytes_header(&_sink.pos, _sink.end - _sink.pos, content.size()));
+
+    // the transfer is resumed whenever the reader catches up
+    while ((status = cbor_sink_put_file(&_sink, fileno(input), 0, content.size(), &done)) == CBOR_IO_AGAIN)
+    {
+        ++again;
+        while ((count = read(fds[0], chunk, sizeof(chunk))) > 0)
+            received.insert(received.end(), chunk, chunk + count);
+    }
+
+    ASSERT_EQ(CBOR_IO_OK, status);
+    ASSERT_EQ(CBOR_IO_OK, cbor_sink_flush(&_sink));
+    while ((count = read(fds[0], chunk, sizeof(chunk))) > 0)
+        received.insert(received.end(), chunk, chunk + count);
+
+    ASSERT_TRUE(again > 0);
+    ASSERT_EQ(content.size() + 5, received.size());
+    ASSERT_EQ(fromHex("5a 00 03 0d 40"), std::vector<uint8_t>(received.begin(), received.begin() + 5));
+    ASSERT_TRUE(std::equal(content.begin(), content.end(), received.begin() + 5));
+
+    close(fds[0]);
+    close(fds[1]);
+    fclose(input);
+}
+#endif
+
+TEST_F(CborphineSinkTest, ChecksumAcrossFlushes)
+{
+    cbor_checksum_t checksum;
+    std::vector<uint8_t> data;
+
+    // new bytes are included after each item, before the buffer is flushed and reused
+    cbor_init_checksum(&checksum);
+    for (cbor_base_uint_t i = 0; i < 5; ++i)
+    {
+        if (_sink.end - _sink.pos < 3)
+        {
+            ASSERT_EQ(CBOR_IO_OK, cbor_sink_flush(&_sink));
+        }
+
+        uint8_t *pos = _sink.pos;
+        ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&_sink.pos, _sink.end - _sink.pos, 1000 + i));
+        cbor_checksum_update(&checksum, pos, _sink.pos - pos);
+    }
+
+    while (cbor_write_checksum(&_sink.pos, _sink.end - _sink.pos, &checksum) == CBOR_FALSE)
+        ASSERT_EQ(CBOR_IO_OK, cbor_sink_flush(&_sink));
+    ASSERT_EQ(CBOR_IO_OK, cbor_sink_flush(&_sink));
+
+    data = readFile();
+    ASSERT_EQ(19u, data.size());
+    ASSERT_EQ(CBOR_TRUE, cbor_verify_checksum(data.data(), data.size()));
+}
@@ -0,0 +1,26 @@
+#ifndef CBORPHINE_SINK_TEST_H
+#define CBORPHINE_SINK_TEST_H
+
+#include <cstdio>
+#include "cborphine-test.h"
+
+class CborphineSinkTest : public CborphineTest
+{
+public: // ::testing::Test
+
+    virtual void SetUp();
+
+    virtual void TearDown();
+
+protected:
+
+    std::vector<uint8_t> readFile();
+
+protected:
+
+    FILE*       _file;
+    uint8_t     _sinkBuffer[8];
+    cbor_sink_t _sink;
+};
+
+#endif // CBORPHINE_SINK_TEST_H
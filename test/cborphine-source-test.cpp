@@ -0,0 +1,248 @@
+#include <cstdio>
+#include <cstring>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "cborphine-source-test.h"
+
+void CborphineSourceTest::SetUp()
+{
+    CborphineTest::SetUp();
+
+    _inputPos = 0;
+    _step = 3;
+    _refills = 0;
+    _failure = 0;
+}
+
+size_t CborphineSourceTest::refill(void *ctx, uint8_t *data, size_t size)
+{
+    CborphineSourceTest *test = (CborphineSourceTest *)ctx;
+    size_t count = test->_input.size() - test->_inputPos;
+
+    if (count == 0 && test->_failure != 0)
+        return test->_failure;
+
+    if (count > size)
+        count = size;
+    if (count > test->_step)
+        count = test->_step;
+
+    memcpy(data, test->_input.data() + test->_inputPos, count);
+    test->_inputPos += count;
+    ++test->_refills;
+    return count;
+}
+
+cbor_bool_t CborphineSourceTest::initRead(const std::string& hex, size_t windowSize, cbor_bool_t nextOnRead)
+{
+    _input = fromHex(hex);
+    return cbor_init_read_source(&_token, &_source, refill, this, _window, windowSize, nextOnRead);
+}
+
+TEST_F(CborphineSourceTest, ReadThroughSmallWindow)
+{
+    cbor_base_uint_t value;
+    cbor_base_int_t intValue;
+    char str[16];
+    uint8_t bytes[16];
+    double doubleValue;
+
+    ASSERT_EQ(CBOR_TRUE, initRead("82 19 03 e8 39 01 f3 6b 68 65 6c 6c 6f 20 77 6f 72 6c 64"
+                                  "a1 61 61 4a 00 01 02 03 04 05 06 07 08 09 fb 3f f8 00 00 00 00 00 00", 16, CBOR_TRUE));
+
+    ASSERT_EQ(CBOR_TRUE, cbor_read_array(&_token, &value));
+    ASSERT_EQ(2u, value);
+    ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&_token, &value));
+    ASSERT_EQ(1000u, value);
+    ASSERT_EQ(CBOR_TRUE, cbor_read_int(&_token, &intValue));
+    ASSERT_EQ(-500, intValue);
+    ASSERT_EQ(CBOR_TRUE, cbor_read_string(&_token, str, sizeof(str)));
+    ASSERT_STREQ("hello world", str);
+    ASSERT_EQ(CBOR_TRUE, cbor_read_map(&_token, &value));
+    ASSERT_EQ(CBOR_TRUE, cbor_read_string(&_token, str, sizeof(str)));
+    ASSERT_STREQ("a", str);
+    ASSERT_EQ(CBOR_TRUE, cbor_read_bytes(&_token, bytes, sizeof(bytes)));
+    ASSERT_EQ(9, bytes[9]);
+    ASSERT_EQ(CBOR_TRUE, cbor_read_double(&_token, &doubleValue));
+    ASSERT_EQ(1.5, doubleValue);
+
+    ASSERT_EQ(CBOR_TOKEN_TYPE_END, _token.type);
+    ASSERT_EQ(_input.size(), _inputPos);
+}
+
+TEST_F(CborphineSourceTest, StreamLargeString)
+{
+    std::vector<uint8_t> payload;
+    const uint8_t *chunk;
+    size_t chunkSize;
+    cbor_base_uint_t value;
+
+    _step = 100;
+    ASSERT_EQ(CBOR_TRUE, initRead("58 28 00 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f 10 11 12 13"
+                                  "14 15 16 17 18 19 1a 1b 1c 1d 1e 1f 20 21 22 23 24 25 26 27 07", 16, CBOR_FALSE));
+
+    ASSERT_EQ(CBOR_TOKEN_TYPE_BYTES, _token.type);
+    ASSERT_EQ(40u, CBOR_GET_BYTES_SIZE(&_token));
+    ASSERT_TRUE(CBOR_GET_BYTES(&_token) == NULL);
+
+    while (cbor_read_source_chunk(&_token, &chunk, &chunkSize))
+    {
+        ASSERT_TRUE(chunkSize <= 16);
+        payload.insert(payload.end(), chunk, chunk + chunkSize);
+    }
+
+    ASSERT_EQ(40u, payload.size());
+    ASSERT_EQ(0x27, payload[39]);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_read_next(&_token));
+    ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&_token, &value));
+    ASSERT_EQ(7u, value);
+}
+
+TEST_F(CborphineSourceTest, CopyLargeString)
+{
+    uint8_t bytes[40];
+    cbor_base_uint_t value;
+
+    ASSERT_EQ(CBOR_TRUE, initRead("58 28 00 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f 10 11 12 13"
+                                  "14 15 16 17 18 19 1a 1b 1c 1d 1e 1f 20 21 22 23 24 25 26 27 07", 16, CBOR_TRUE));
+
+    ASSERT_EQ(CBOR_TRUE, cbor_read_bytes(&_token, bytes, sizeof(bytes)));
+    ASSERT_EQ(0x27, bytes[39]);
+    ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&_token, &value));
+    ASSERT_EQ(7u, value);
+}
+
+TEST_F(CborphineSourceTest, SkipLargeString)
+{
+    cbor_base_uint_t value;
+
+    ASSERT_EQ(CBOR_TRUE, initRead("82 58 28 00 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f 10 11 12 13"
+                                  "14 15 16 17 18 19 1a 1b 1c 1d 1e 1f 20 21 22 23 24 25 26 27 07 08", 16, CBOR_TRUE));
+
+    ASSERT_EQ(CBOR_TRUE, cbor_skip(&_token));
+    ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&_token, &value));
+    ASSERT_EQ(8u, value);
+}
+
+TEST_F(CborphineSourceTest, TruncatedString)
+{
+    char str[16];
+
+    ASSERT_EQ(CBOR_FALSE, initRead("6b 68 65 6c 6c 6f", 16, CBOR_TRUE));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_ERROR, _token.type);
+    ASSERT_EQ(CBOR_FALSE, cbor_read_string(&_token, str, sizeof(str)));
+}
+
+TEST_F(CborphineSourceTest, TruncatedLargeString)
+{
+    uint8_t bytes[40];
+
+    ASSERT_EQ(CBOR_TRUE, initRead("58 28 00 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f 10 11 12 13", 16, CBOR_TRUE));
+    ASSERT_EQ(CBOR_FALSE, cbor_read_bytes(&_token, bytes, sizeof(bytes)));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_ERROR, _token.type);
+}
+
+TEST_F(CborphineSourceTest, SpansArentSupported)
+{
+    const uint8_t *item;
+    size_t itemSize;
+
+    ASSERT_EQ(CBOR_TRUE, initRead("01", 16, CBOR_TRUE));
+    ASSERT_EQ(CBOR_FALSE, cbor_get_item_span(&_token, &item, &itemSize));
+}
+
+TEST_F(CborphineSourceTest, InsufficientWindowSize)
+{
+    ASSERT_EQ(CBOR_FALSE, initRead("01", 8, CBOR_TRUE));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_ERROR, _token.type);
+}
+
+TEST_F(CborphineSourceTest, ReadFile)
+{
+    FILE *file = tmpfile();
+    std::vector<uint8_t> data = fromHex("83 01 02 03");
+    cbor_base_uint_t value;
+
+    ASSERT_TRUE(file != NULL);
+    fwrite(data.data(), 1, data.size(), file);
+    fseek(file, 0, SEEK_SET);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read_source(&_token, &_source, cbor_refill_file, file, _window, sizeof(_window), CBOR_TRUE));
+    ASSERT_EQ(CBOR_TRUE, cbor_read_array(&_token, &value));
+    ASSERT_EQ(3u, value);
+    ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&_token, &value));
+    ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&_token, &value));
+    ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&_token, &value));
+    ASSERT_EQ(3u, value);
+    ASSERT_EQ(CBOR_TOKEN_TYPE_END, _token.type);
+
+    fclose(file);
+}
+
+TEST_F(CborphineSourceTest, RefillWouldBlock)
+{
+    cbor_base_uint_t value;
+
+    _failure = CBOR_REFILL_AGAIN;
+    ASSERT_EQ(CBOR_TRUE, initRead("82 01", 16, CBOR_TRUE));
+    ASSERT_EQ(CBOR_TRUE, cbor_read_array(&_token, &value));
+    ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&_token, &value));
+    ASSERT_EQ(1u, value);
+
+    // missing data is not the end of input
+    ASSERT_EQ(CBOR_TOKEN_TYPE_ERROR, _token.type);
+    ASSERT_STREQ("input would block", _token.error_message);
+    ASSERT_EQ(CBOR_FALSE, _source.eof);
+}
+
+TEST_F(CborphineSourceTest, RefillErrorInString)
+{
+    char str[16];
+
+    _failure = CBOR_REFILL_ERROR;
+    ASSERT_EQ(CBOR_FALSE, initRead("6b 68 65 6c 6c 6f", 16, CBOR_TRUE));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_ERROR, _token.type);
+    ASSERT_STREQ("input error", _token.error_message);
+    ASSERT_EQ(CBOR_FALSE, cbor_read_string(&_token, str, sizeof(str)));
+    ASSERT_EQ(CBOR_FALSE, _source.eof);
+}
+
+TEST_F(CborphineSourceTest, RefillErrorInLargeString)
+{
+    uint8_t bytes[40];
+
+    _failure = CBOR_REFILL_ERROR;
+    ASSERT_EQ(CBOR_TRUE, initRead("58 28 00 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f 10 11 12 13", 16, CBOR_TRUE));
+    ASSERT_EQ(CBOR_FALSE, cbor_read_bytes(&_token, bytes, sizeof(bytes)));
+    ASSERT_STREQ("input error", _token.error_message);
+}
+
+#ifndef _WIN32
+TEST_F(CborphineSourceTest, ReadNonBlockingPipe)
+{
+    int fds[2];
+    std::vector<uint8_t> data = fromHex("83 01 02");
+    cbor_base_uint_t value;
+
+    ASSERT_EQ(0, pipe(fds));
+    ASSERT_EQ(0, fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK));
+    ASSERT_EQ((ssize_t)data.size(), write(fds[1], data.data(), data.size()));
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read_source(&_token, &_source, cbor_refill_fd, &fds[0], _window, sizeof(_window), CBOR_TRUE));
+    ASSERT_EQ(CBOR_TRUE, cbor_read_array(&_token, &value));
+    ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&_token, &value));
+    ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&_token, &value));
+    ASSERT_EQ(2u, value);
+
+    // the writer is still open, so missing data is not the end of input
+    ASSERT_EQ(CBOR_TOKEN_TYPE_ERROR, _token.type);
+    ASSERT_STREQ("input would block", _token.error_message);
+    ASSERT_EQ(CBOR_FALSE, _source.eof);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+#endif
@@ -0,0 +1,30 @@
+#ifndef CBORPHINE_SOURCE_TEST_H
+#define CBORPHINE_SOURCE_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineSourceTest : public CborphineTest
+{
+public: // ::testing::Test
+
+    virtual void SetUp();
+
+protected:
+
+    static size_t refill(void *ctx, uint8_t *data, size_t size);
+
+    cbor_bool_t initRead(const std::string& hex, size_t windowSize, cbor_bool_t nextOnRead);
+
+protected:
+
+    std::vector<uint8_t> _input;
+    size_t               _inputPos;
+    size_t               _step; // bytes per refill at most
+    size_t               _refills;
+    size_t               _failure; // returned instead of the end of input
+    uint8_t              _window[16];
+    cbor_source_t        _source;
+    cbor_token_t         _token;
+};
+
+#endif // CBORPHINE_SOURCE_TEST_H
@@ -0,0 +1,91 @@
+#include "cborphine-span-test.h"
+
+TEST_F(CborphineSpanTest, WriteRaw)
+{
+    const uint8_t raw[] = { 0x82, 0x01, 0x02 };
+
+    setExpected("82 01 02");
+    ASSERT_EQ(CBOR_FALSE, cbor_write_raw(&_data, 2, raw, sizeof(raw)));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_raw(&_data, _size, raw, sizeof(raw)));
+}
+
+TEST_F(CborphineSpanTest, ForwardNestedItem)
+{
+    // {"id": 1, "body": {"a": [1, 2, 3(h'0102')], "b": "xy"}, "x": 0}
+    std::vector<uint8_t> data = fromHex("a3 62 69 64 01 64 62 6f 64 79 a2 61 61 83 01 02 c3 42 01 02"
+                                        "61 62 62 78 79 61 78 00");
+    cbor_token_t token;
+    const uint8_t* item;
+    size_t itemSize;
+    cbor_base_uint_t value;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, data.data(), data.size(), CBOR_TRUE));
+    ASSERT_EQ(CBOR_TRUE, cbor_read_map(&token, &value));
+    ASSERT_EQ(CBOR_TRUE, cbor_skip(&token)); // "id"
+    ASSERT_EQ(CBOR_TRUE, cbor_skip(&token)); // 1
+    ASSERT_EQ(CBOR_TRUE, cbor_skip(&token)); // "body"
+
+    ASSERT_EQ(CBOR_TRUE, cbor_get_item_span(&token, &item, &itemSize));
+    ASSERT_EQ(&data[10], item);
+    ASSERT_EQ(15u, itemSize);
+
+    setExpected("a2 61 61 83 01 02 c3 42 01 02 61 62 62 78 79");
+    ASSERT_EQ(CBOR_TRUE, cbor_write_raw(&_data, _size, item, itemSize));
+
+    ASSERT_EQ(CBOR_TRUE, cbor_skip(&token)); // body
+    ASSERT_EQ(CBOR_TOKEN_TYPE_STRING, token.type);
+    ASSERT_EQ(CBOR_TRUE, cbor_skip(&token)); // "x"
+    ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&token, &value));
+    ASSERT_EQ(0u, value);
+    ASSERT_EQ(CBOR_TOKEN_TYPE_END, token.type);
+}
+
+TEST_F(CborphineSpanTest, SpanOfScalar)
+{
+    std::vector<uint8_t> data = fromHex("19 03 e8 01");
+    cbor_token_t token;
+    const uint8_t* item;
+    size_t itemSize;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, data.data(), data.size(), CBOR_FALSE));
+    ASSERT_EQ(CBOR_TRUE, cbor_get_item_span(&token, &item, &itemSize));
+    ASSERT_EQ(&data[0], item);
+    ASSERT_EQ(3u, itemSize);
+
+    // explicit jumps to next item
+    ASSERT_EQ(CBOR_TRUE, cbor_skip(&token));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_PINT, token.type);
+    ASSERT_EQ(CBOR_TRUE, cbor_read_next(&token));
+    ASSERT_EQ(1u, CBOR_GET_PINT(&token));
+}
+
+TEST_F(CborphineSpanTest, SpanOfTruncatedItem)
+{
+    std::vector<uint8_t> data = fromHex("82 01");
+    cbor_token_t token;
+    const uint8_t* item;
+    size_t itemSize;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, data.data(), data.size(), CBOR_TRUE));
+    ASSERT_EQ(CBOR_FALSE, cbor_get_item_span(&token, &item, &itemSize));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_ERROR, token.type);
+    ASSERT_STREQ("insufficient data", token.error_message);
+}
+
+TEST_F(CborphineSpanTest, TruncatedItem)
+{
+    std::vector<uint8_t> data = fromHex("a2 61 61 83 01 02 c3 42 01 02 61 62 19 03 e8");
+
+    // every prefix of a well-formed item is truncated
+    for (size_t size = 1; size < data.size(); ++size)
+        ASSERT_EQ(CBOR_TRUE, cbor_is_truncated(data.data(), size)) << size;
+
+    ASSERT_EQ(CBOR_FALSE, cbor_is_truncated(data.data(), data.size()));
+    ASSERT_EQ(CBOR_FALSE, cbor_is_truncated(data.data(), 0));
+
+    // malformed items are not completed by more data
+    data = fromHex("82 01 1c 02");
+    ASSERT_EQ(CBOR_FALSE, cbor_is_truncated(data.data(), data.size()));
+    data = fromHex("9f 01");
+    ASSERT_EQ(CBOR_FALSE, cbor_is_truncated(data.data(), data.size()));
+}
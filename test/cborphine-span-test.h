@@ -0,0 +1,11 @@
+#ifndef CBORPHINE_SPAN_TEST_H
+#define CBORPHINE_SPAN_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineSpanTest : public CborphineTest
+{
+
+};
+
+#endif // CBORPHINE_SPAN_TEST_H
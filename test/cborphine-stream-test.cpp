@@ -0,0 +1,97 @@
+#include "cborphine-stream-test.h"
+
+void CborphineStreamTest::SetUp()
+{
+    CborphineTest::SetUp();
+
+    cbor_init_string_reader(&_reader);
+    _chunks = 0;
+    _consumed = 0;
+}
+
+// passes input in pieces of step bytes until the string is complete
+cbor_string_status_t CborphineStreamTest::feed(const std::vector<uint8_t>& input, size_t step)
+{
+    size_t offset;
+
+    for (offset = 0; offset < input.size(); offset += step)
+    {
+        const uint8_t *data = input.data() + offset;
+        size_t size = offset + step < input.size() ? step : input.size() - offset;
+        const uint8_t *chunk;
+        size_t chunkSize;
+        cbor_string_status_t status;
+
+        while ((status = cbor_read_string_chunk(&_reader, &data, &size, &chunk, &chunkSize)) == CBOR_STRING_CHUNK)
+        {
+            _payload.insert(_payload.end(), chunk, chunk + chunkSize);
+            ++_chunks;
+        }
+
+        _consumed = (size_t)(data - input.data());
+        if (status != CBOR_STRING_MORE)
+            return status;
+    }
+
+    return CBOR_STRING_MORE;
+}
+
+TEST_F(CborphineStreamTest, DefiniteInOneInput)
+{
+    ASSERT_EQ(CBOR_STRING_END, feed(fromHex("63 61 62 63 01"), 5));
+    ASSERT_EQ(fromHex("61 62 63"), _payload);
+    ASSERT_EQ(1u, _chunks);
+    ASSERT_EQ(4u, _consumed); // next item isn't consumed
+    ASSERT_EQ(3u, _reader.type);
+}
+
+TEST_F(CborphineStreamTest, DefiniteByteByByte)
+{
+    ASSERT_EQ(CBOR_STRING_END, feed(fromHex("59 00 05 01 02 03 04 05"), 1));
+    ASSERT_EQ(fromHex("01 02 03 04 05"), _payload);
+    ASSERT_EQ(5u, _chunks);
+    ASSERT_EQ(2u, _reader.type);
+}
+
+TEST_F(CborphineStreamTest, Empty)
+{
+    ASSERT_EQ(CBOR_STRING_END, feed(fromHex("60"), 1));
+    ASSERT_TRUE(_payload.empty());
+}
+
+TEST_F(CborphineStreamTest, Incomplete)
+{
+    ASSERT_EQ(CBOR_STRING_MORE, feed(fromHex("45 01 02"), 2));
+    ASSERT_EQ(fromHex("01 02"), _payload);
+    ASSERT_EQ(3u, _reader.left);
+}
+
+TEST_F(CborphineStreamTest, Indefinite)
+{
+    ASSERT_EQ(CBOR_STRING_END, feed(fromHex("5f 42 01 02 40 58 01 03 ff f6"), 3));
+    ASSERT_EQ(fromHex("01 02 03"), _payload);
+    ASSERT_EQ(CBOR_TRUE, _reader.indefinite);
+    ASSERT_EQ(9u, _consumed);
+}
+
+TEST_F(CborphineStreamTest, IndefiniteWithInvalidChunk)
+{
+    ASSERT_EQ(CBOR_STRING_ERROR, feed(fromHex("5f 41 01 61 61 ff"), 6));
+    ASSERT_STREQ("invalid chunk type", _reader.error_message);
+}
+
+TEST_F(CborphineStreamTest, IndefiniteWithNestedIndefinite)
+{
+    ASSERT_EQ(CBOR_STRING_ERROR, feed(fromHex("7f 7f ff ff"), 4));
+}
+
+TEST_F(CborphineStreamTest, InvalidType)
+{
+    ASSERT_EQ(CBOR_STRING_ERROR, feed(fromHex("01"), 1));
+    ASSERT_STREQ("invalid data type", _reader.error_message);
+}
+
+TEST_F(CborphineStreamTest, InvalidWidth)
+{
+    ASSERT_EQ(CBOR_STRING_ERROR, feed(fromHex("5c 00"), 2));
+}
@@ -0,0 +1,24 @@
+#ifndef CBORPHINE_STREAM_TEST_H
+#define CBORPHINE_STREAM_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineStreamTest : public CborphineTest
+{
+public: // ::testing::Test
+
+    virtual void SetUp();
+
+protected:
+
+    cbor_string_status_t feed(const std::vector<uint8_t>& input, size_t step);
+
+protected:
+
+    cbor_string_reader_t _reader;
+    std::vector<uint8_t> _payload;
+    size_t               _chunks;
+    size_t               _consumed;
+};
+
+#endif // CBORPHINE_STREAM_TEST_H
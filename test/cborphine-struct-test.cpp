@@ -0,0 +1,195 @@
+#include <cstdio>
+#include <cstring>
+#include "cborphine-struct-test.h"
+
+static const cbor_field_t testFields[] =
+{
+    CBOR_FIELD(TestStruct, id,    CBOR_FIELD_TYPE_UINT,    "id"),
+    CBOR_FIELD(TestStruct, delta, CBOR_FIELD_TYPE_INT,     "delta"),
+    CBOR_FIELD(TestStruct, ratio, CBOR_FIELD_TYPE_FLOAT,   "ratio"),
+    CBOR_FIELD(TestStruct, flag,  CBOR_FIELD_TYPE_BOOLEAN, "flag"),
+    CBOR_FIELD(TestStruct, name,  CBOR_FIELD_TYPE_STRING,  "name"),
+    CBOR_FIELD(TestStruct, blob,  CBOR_FIELD_TYPE_BYTES,   "blob")
+};
+
+static const size_t testFieldsCount = sizeof(testFields) / sizeof(testFields[0]);
+
+void CborphineStructTest::SetUp()
+{
+    CborphineTest::SetUp();
+
+    memset(&_value, 0, sizeof(_value));
+    _value.id = 1000;
+    _value.delta = -500;
+    _value.ratio = 1.5;
+    _value.flag = CBOR_TRUE;
+    strcpy(_value.name, "abc");
+    _value.blob[0] = 1;
+    _value.blob[1] = 2;
+    _value.blob[2] = 3;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_struct(&_mapDesc, testFields, testFieldsCount, CBOR_STRUCT_LAYOUT_MAP));
+    ASSERT_EQ(CBOR_TRUE, cbor_init_struct(&_arrayDesc, testFields, testFieldsCount, CBOR_STRUCT_LAYOUT_ARRAY));
+}
+
+TEST_F(CborphineStructTest, EncodeMap)
+{
+    setExpected("a6 62 69 64 19 03 e8 65 64 65 6c 74 61 39 01 f3"
+                "65 72 61 74 69 6f fb 3f f8 00 00 00 00 00 00 64 66 6c 61 67 f5"
+                "64 6e 61 6d 65 63 61 62 63 64 62 6c 6f 62 43 01 02 03");
+    ASSERT_EQ(CBOR_TRUE, cbor_encode_struct(&_data, _size, &_mapDesc, &_value));
+}
+
+TEST_F(CborphineStructTest, EncodeArray)
+{
+    setExpected("86 19 03 e8 39 01 f3 fb 3f f8 00 00 00 00 00 00 f5 63 61 62 63 43 01 02 03");
+    ASSERT_EQ(CBOR_TRUE, cbor_encode_struct(&_data, _size, &_arrayDesc, &_value));
+}
+
+TEST_F(CborphineStructTest, EncodeWithInsufficientBufferSize)
+{
+    ASSERT_EQ(CBOR_FALSE, cbor_encode_struct(&_data, 20, &_mapDesc, &_value));
+    ASSERT_EQ(&_buffer[0], _data);
+    _expected = _buffer; // partially written data is not used
+}
+
+TEST_F(CborphineStructTest, DecodeMapInAnyOrder)
+{
+    // unknown keys with nested values and non-string keys are skipped
+    std::vector<uint8_t> data = fromHex("a8 64 62 6c 6f 62 43 01 02 03 64 6e 61 6d 65 63 61 62 63"
+                                        "63 78 78 78 a1 61 61 82 01 02 01 f6"
+                                        "64 66 6c 61 67 f5 65 72 61 74 69 6f fb 3f f8 00 00 00 00 00 00"
+                                        "65 64 65 6c 74 61 39 01 f3 62 69 64 19 03 e8 07");
+    cbor_token_t token;
+    TestStruct value;
+    cbor_base_uint_t next;
+
+    memset(&value, 0, sizeof(value));
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, data.data(), data.size(), CBOR_TRUE));
+    ASSERT_EQ(CBOR_TRUE, cbor_decode_struct(&token, &_mapDesc, &value));
+    ASSERT_EQ(0, memcmp(&_value, &value, sizeof(value)));
+
+    ASSERT_EQ(CBOR_TRUE, cbor_read_uint(&token, &next));
+    ASSERT_EQ(7u, next);
+}
+
+TEST_F(CborphineStructTest, RoundTripArray)
+{
+    cbor_token_t token;
+    TestStruct value;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_encode_struct(&_data, _size, &_arrayDesc, &_value));
+    _expected = _buffer;
+
+    memset(&value, 0, sizeof(value));
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, &_buffer[0], _data - &_buffer[0], CBOR_TRUE));
+    ASSERT_EQ(CBOR_TRUE, cbor_decode_struct(&token, &_arrayDesc, &value));
+    ASSERT_EQ(0, memcmp(&_value, &value, sizeof(value)));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_END, token.type);
+}
+
+TEST_F(CborphineStructTest, DecodeIntegerOverflow)
+{
+    std::vector<uint8_t> data = fromHex("a1 62 69 64 1a 00 01 00 00");
+    cbor_token_t token;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, data.data(), data.size(), CBOR_TRUE));
+    ASSERT_EQ(CBOR_FALSE, cbor_decode_struct(&token, &_mapDesc, &_value));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_ERROR, token.type);
+    ASSERT_STREQ("integer overflow", token.error_message);
+}
+
+TEST_F(CborphineStructTest, DecodeTruncatedMap)
+{
+    std::vector<uint8_t> data = fromHex("a2 62 69 64 01");
+    cbor_token_t token;
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, data.data(), data.size(), CBOR_TRUE));
+    ASSERT_EQ(CBOR_FALSE, cbor_decode_struct(&token, &_mapDesc, &_value));
+    ASSERT_STREQ("insufficient data", token.error_message);
+}
+
+TEST_F(CborphineStructTest, InitWithDuplicatedKeys)
+{
+    cbor_field_t fields[] =
+    {
+        CBOR_FIELD(TestStruct, id,    CBOR_FIELD_TYPE_UINT, "id"),
+        CBOR_FIELD(TestStruct, delta, CBOR_FIELD_TYPE_INT,  "id")
+    };
+    cbor_struct_t desc;
+
+    ASSERT_EQ(CBOR_FALSE, cbor_init_struct(&desc, fields, 2, CBOR_STRUCT_LAYOUT_MAP));
+}
+
+TEST_F(CborphineStructTest, InitWithInvalidSizes)
+{
+    struct Sizes
+    {
+        uint8_t bytes3[3];
+        uint16_t short2;
+    };
+    cbor_field_t fields[] =
+    {
+        CBOR_FIELD(Sizes, bytes3, CBOR_FIELD_TYPE_UINT,    "a"),
+        CBOR_FIELD(Sizes, bytes3, CBOR_FIELD_TYPE_BOOLEAN, "b"),
+        CBOR_FIELD(Sizes, short2, CBOR_FIELD_TYPE_FLOAT,   "c"),
+        CBOR_FIELD(Sizes, short2, CBOR_FIELD_TYPE_INT,     "d")
+    };
+    cbor_struct_t desc;
+
+    ASSERT_EQ(CBOR_FALSE, cbor_init_struct(&desc, &fields[0], 1, CBOR_STRUCT_LAYOUT_MAP));
+    ASSERT_EQ(CBOR_FALSE, cbor_init_struct(&desc, &fields[1], 1, CBOR_STRUCT_LAYOUT_MAP));
+    ASSERT_EQ(CBOR_FALSE, cbor_init_struct(&desc, &fields[2], 1, CBOR_STRUCT_LAYOUT_ARRAY));
+    ASSERT_EQ(CBOR_TRUE, cbor_init_struct(&desc, &fields[3], 1, CBOR_STRUCT_LAYOUT_MAP));
+}
+
+TEST_F(CborphineStructTest, SmallBooleanField)
+{
+    struct Flags
+    {
+        uint8_t flag;
+        uint8_t canary[3];
+    };
+    cbor_field_t fields[] =
+    {
+        CBOR_FIELD(Flags, flag, CBOR_FIELD_TYPE_BOOLEAN, "f")
+    };
+    std::vector<uint8_t> data = fromHex("a1 61 66 f5");
+    cbor_struct_t desc;
+    cbor_token_t token;
+    Flags value;
+
+    memset(&value, 0xAA, sizeof(value));
+    ASSERT_EQ(CBOR_TRUE, cbor_init_struct(&desc, fields, 1, CBOR_STRUCT_LAYOUT_MAP));
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read(&token, data.data(), data.size(), CBOR_TRUE));
+    ASSERT_EQ(CBOR_TRUE, cbor_decode_struct(&token, &desc, &value));
+    ASSERT_EQ(1, value.flag);
+    ASSERT_EQ(0xAA, value.canary[0]);
+    ASSERT_EQ(0xAA, value.canary[1]);
+    ASSERT_EQ(0xAA, value.canary[2]);
+
+    setExpected("a1 61 66 f5");
+    ASSERT_EQ(CBOR_TRUE, cbor_encode_struct(&_data, _size, &desc, &value));
+}
+
+TEST_F(CborphineStructTest, DecodeStreamedKey)
+{
+    // keys larger than the window of a refillable source aren't matched in chunks
+    std::vector<uint8_t> data = fromHex("a1 78 14 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 6b 01");
+    FILE *file = tmpfile();
+    uint8_t window[16];
+    cbor_source_t source;
+    cbor_token_t token;
+    TestStruct value;
+
+    ASSERT_TRUE(file != NULL);
+    fwrite(data.data(), 1, data.size(), file);
+    fseek(file, 0, SEEK_SET);
+
+    ASSERT_EQ(CBOR_TRUE, cbor_init_read_source(&token, &source, cbor_refill_file, file, window, sizeof(window), CBOR_TRUE));
+    ASSERT_EQ(CBOR_FALSE, cbor_decode_struct(&token, &_mapDesc, &value));
+    ASSERT_EQ(CBOR_TOKEN_TYPE_ERROR, token.type);
+    ASSERT_STREQ("key larger than window", token.error_message);
+
+    fclose(file);
+}
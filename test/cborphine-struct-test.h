@@ -0,0 +1,29 @@
+#ifndef CBORPHINE_STRUCT_TEST_H
+#define CBORPHINE_STRUCT_TEST_H
+
+#include "cborphine-test.h"
+
+struct TestStruct
+{
+    uint16_t    id;
+    int32_t     delta;
+    double      ratio;
+    cbor_bool_t flag;
+    char        name[8];
+    uint8_t     blob[3];
+};
+
+class CborphineStructTest : public CborphineTest
+{
+public: // ::testing::Test
+
+    virtual void SetUp();
+
+protected:
+
+    TestStruct   _value;
+    cbor_struct_t _mapDesc;
+    cbor_struct_t _arrayDesc;
+};
+
+#endif // CBORPHINE_STRUCT_TEST_H
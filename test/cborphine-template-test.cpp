@@ -0,0 +1,96 @@
+#include "cborphine-template-test.h"
+
+TEST_F(CborphineTemplateTest, WriteUIntFixed)
+{
+    setExpected("18 05 19 00 05 1a 00 00 00 05 1b 00 00 00 00 00 00 00 05");
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint_fixed(&_data, _size, 5, 1));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint_fixed(&_data, _size, 5, 2));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint_fixed(&_data, _size, 5, 4));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint_fixed(&_data, _size, 5, 8));
+}
+
+TEST_F(CborphineTemplateTest, WriteFixedHeaders)
+{
+    setExpected("39 01 f3 99 00 02 b8 01");
+    ASSERT_EQ(CBOR_TRUE, cbor_write_int_fixed(&_data, _size, -500, 2));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_array_fixed(&_data, _size, 2, 2));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_map_fixed(&_data, _size, 1, 1));
+}
+
+TEST_F(CborphineTemplateTest, WriteFixedValueDoesNotFit)
+{
+    ASSERT_EQ(CBOR_FALSE, cbor_write_uint_fixed(&_data, _size, 256, 1));
+    ASSERT_EQ(CBOR_FALSE, cbor_write_uint_fixed(&_data, _size, 1, 3));
+    ASSERT_EQ(CBOR_FALSE, cbor_write_uint_fixed(&_data, 2, 1, 2));
+    ASSERT_EQ(&_buffer[0], _data);
+}
+
+TEST_F(CborphineTemplateTest, PatchTemplate)
+{
+    // {"seq": uint, "delta": int, "temp": float} with fixed width slots
+    uint8_t* slots[3];
+
+    ASSERT_EQ(CBOR_TRUE, cbor_write_map(&_data, _size, 3));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_string(&_data, _size, "seq"));
+    slots[0] = _data;
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint_fixed(&_data, _size, 0, 4));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_string(&_data, _size, "delta"));
+    slots[1] = _data;
+    ASSERT_EQ(CBOR_TRUE, cbor_write_int_fixed(&_data, _size, 0, 2));
+    ASSERT_EQ(CBOR_TRUE, cbor_write_string(&_data, _size, "temp"));
+    slots[2] = _data;
+    ASSERT_EQ(CBOR_TRUE, cbor_write_float(&_data, _size, 0.0f));
+
+    ASSERT_EQ(CBOR_TRUE, cbor_patch_uint(slots[0], 100000));
+    ASSERT_EQ(CBOR_TRUE, cbor_patch_int(slots[1], -500));
+    ASSERT_EQ(CBOR_TRUE, cbor_patch_float(slots[2], 1.5f));
+
+    setExpected("a3 63 73 65 71 1a 00 01 86 a0 65 64 65 6c 74 61 39 01 f3"
+                "64 74 65 6d 70 fa 3f c0 00 00");
+}
+
+TEST_F(CborphineTemplateTest, PatchValueDoesNotFit)
+{
+    uint8_t* slot = _data;
+
+    setExpected("19 00 01 01");
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint_fixed(&_data, _size, 1, 2));
+    ASSERT_EQ(CBOR_FALSE, cbor_patch_uint(slot, 65536));
+    ASSERT_EQ(CBOR_FALSE, cbor_patch_double(slot, 1.0));
+
+    slot = _data;
+    ASSERT_EQ(CBOR_TRUE, cbor_write_uint(&_data, _size, 1));
+    ASSERT_EQ(CBOR_FALSE, cbor_patch_uint(slot, 2)); // injected values have no slot
+}
+
+TEST_F(CborphineTemplateTest, PatchChecksMajorType)
+{
+    uint8_t* slot = _data;
+
+    setExpected("9a 00 00 00 02 39 00 01 fb 00 00 00 00 00 00 00 00");
+    ASSERT_EQ(CBOR_TRUE, cbor_write_array_fixed(&_data, _size, 0, 4));
+    ASSERT_EQ(CBOR_FALSE, cbor_patch_int(slot, 1));
+    ASSERT_EQ(CBOR_TRUE, cbor_patch_uint(slot, 2));
+
+    slot = _data;
+    ASSERT_EQ(CBOR_TRUE, cbor_write_int_fixed(&_data, _size, -2, 2));
+    ASSERT_EQ(CBOR_FALSE, cbor_patch_uint(slot, 1));
+
+    slot = _data;
+    ASSERT_EQ(CBOR_TRUE, cbor_write_double(&_data, _size, 0.0));
+    ASSERT_EQ(CBOR_FALSE, cbor_patch_uint(slot, 1));
+    ASSERT_EQ(CBOR_FALSE, cbor_patch_int(slot, 1));
+}
+
+TEST_F(CborphineTemplateTest, PatchRejectsStringLengths)
+{
+    uint8_t bytes[] = { 0x59, 0x00, 0x01, 0x61 };
+    uint8_t text[] = { 0x79, 0x00, 0x01, 0x61 };
+
+    ASSERT_EQ(CBOR_FALSE, cbor_patch_uint(bytes, 2));
+    ASSERT_EQ(CBOR_FALSE, cbor_patch_uint(text, 2));
+    ASSERT_EQ(0x00, bytes[1]);
+    ASSERT_EQ(0x01, bytes[2]);
+    ASSERT_EQ(0x00, text[1]);
+    ASSERT_EQ(0x01, text[2]);
+}
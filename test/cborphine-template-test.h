@@ -0,0 +1,11 @@
+#ifndef CBORPHINE_TEMPLATE_TEST_H
+#define CBORPHINE_TEMPLATE_TEST_H
+
+#include "cborphine-test.h"
+
+class CborphineTemplateTest : public CborphineTest
+{
+
+};
+
+#endif // CBORPHINE_TEMPLATE_TEST_H
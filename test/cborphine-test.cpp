@@ -36,7 +36,7 @@ void CborphineTest::TearDown()
     ASSERT_EQ(_expected, _buffer);
 }
 
-void CborphineTest::setExpected(const std::string& value)
+std::vector<uint8_t> CborphineTest::fromHex(const std::string& value)
 {
     std::string srcValue = value;
     srcValue.erase(remove_if(srcValue.begin(), srcValue.end(), isspace), srcValue.end());
@@ -55,8 +55,13 @@ void CborphineTest::setExpected(const std::string& value)
         uint8_t byte = (uint8_t)std::strtol(byteStr.c_str(), NULL, 16);
         bytes.push_back(byte);
     }
-    
-    _expected.assign(bytes.begin(), bytes.end());
+
+    return bytes;
+}
+
+void CborphineTest::setExpected(const std::string& value)
+{
+    _expected = fromHex(value);
 
     if (_expected.size() < _buffer.size())
     {
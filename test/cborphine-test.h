@@ -14,6 +14,8 @@ public: // ::testing::Test
 
 protected:
 
+    static std::vector<uint8_t> fromHex(const std::string& value);
+
     void setExpected(const std::string& value);
 
 protected:
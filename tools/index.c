@@ -0,0 +1,182 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cbor.h"
+
+/* builds a sidecar index of a CBOR sequence file:
+   cborphine-index <data file> <index file> <records per block> [key...] */
+
+#define READ_BUFFER_SIZE (1024 * 1024)
+
+/* buffer is grown for records larger than it, the caller frees it also on errors */
+static int write_index(FILE *data_file, FILE *index_file, cbor_index_builder_t *builder, uint8_t *block, uint8_t **buffer,
+                       size_t buffer_capacity)
+{
+    uint8_t header[CBOR_INDEX_HEADER_SIZE];
+    size_t buffer_size = 0;
+    size_t block_size;
+    cbor_base_uint_t offset = 0;
+    int eof = 0;
+
+    /* the header is written again when all records are counted */
+    cbor_index_write_header(builder, header);
+    if (fwrite(header, 1, sizeof(header), index_file) != sizeof(header))
+        return 1;
+
+    while (eof == 0 || buffer_size > 0)
+    {
+        cbor_token_t token;
+        size_t consumed = 0;
+        size_t read_size = 0;
+
+        if (eof == 0)
+        {
+            read_size = fread(*buffer + buffer_size, 1, buffer_capacity - buffer_size, data_file);
+            if (ferror(data_file))
+                return 1;
+
+            buffer_size += read_size;
+            eof = read_size == 0;
+        }
+
+        /* complete records only, the rest is parsed again after the next read */
+        cbor_init_read(&token, *buffer, buffer_size, CBOR_TRUE);
+        while (token.type != CBOR_TOKEN_TYPE_END)
+        {
+            const uint8_t *record;
+            size_t record_size;
+
+            if (cbor_get_item_span(&token, &record, &record_size) == CBOR_FALSE)
+                break;
+
+            if (cbor_index_add_record(builder, offset, record, record_size, &block_size) == CBOR_FALSE)
+            {
+                fprintf(stderr, "invalid record at offset %lu\n", (unsigned long)offset);
+                return 1;
+            }
+
+            if (block_size != 0 && fwrite(block, 1, block_size, index_file) != block_size)
+                return 1;
+
+            offset += record_size;
+            consumed += record_size;
+            cbor_skip(&token);
+        }
+
+        /* only truncated records are completed by the next read, the buffer isn't grown for malformed ones */
+        if (token.type == CBOR_TOKEN_TYPE_ERROR && (eof != 0 || cbor_is_truncated(*buffer + consumed, buffer_size - consumed) == CBOR_FALSE))
+        {
+            fprintf(stderr, "invalid record at offset %lu: %s\n", (unsigned long)offset, token.error_message);
+            return 1;
+        }
+
+        memmove(*buffer, *buffer + consumed, buffer_size - consumed);
+        buffer_size -= consumed;
+
+        if (buffer_size == buffer_capacity)
+        {
+            /* a record is larger than the buffer */
+            uint8_t *grown = (uint8_t *)realloc(*buffer, buffer_capacity * 2);
+            if (grown == NULL)
+                return 1;
+
+            *buffer = grown;
+            buffer_capacity *= 2;
+        }
+    }
+
+    block_size = cbor_index_finish(builder);
+    if (block_size != 0 && fwrite(block, 1, block_size, index_file) != block_size)
+        return 1;
+
+    cbor_index_write_header(builder, header);
+    if (fseek(index_file, 0, SEEK_SET) != 0 || fwrite(header, 1, sizeof(header), index_file) != sizeof(header))
+        return 1;
+
+    printf("%lu records indexed\n", (unsigned long)builder->records_count);
+    return 0;
+}
+
+int build_index(FILE *data_file, FILE *index_file, size_t block_records, const char *const *keys, size_t keys_count)
+{
+    cbor_index_builder_t builder;
+    uint8_t *block;
+    uint8_t *buffer;
+    int result = 1;
+
+    block = (uint8_t *)malloc(CBOR_INDEX_BLOCK_SIZE(keys_count, block_records));
+    buffer = (uint8_t *)malloc(READ_BUFFER_SIZE);
+
+    if (block == NULL || buffer == NULL || cbor_init_index_builder(&builder, keys, keys_count, block_records, block) == CBOR_FALSE)
+        fprintf(stderr, "invalid index parameters\n");
+    else
+        result = write_index(data_file, index_file, &builder, block, &buffer, READ_BUFFER_SIZE);
+
+    free(buffer);
+    free(block);
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    FILE *data_file;
+    FILE *index_file;
+    long block_records;
+    int result;
+
+    if (argc < 4 || argc - 4 > CBOR_INDEX_MAX_KEYS)
+    {
+        fprintf(stderr, "usage: %s <data file> <index file> <records per block> [key...]\n", argv[0]);
+        return 1;
+    }
+
+    block_records = strtol(argv[3], NULL, 10);
+    if (block_records <= 0)
+    {
+        fprintf(stderr, "invalid number of records per block\n");
+        return 1;
+    }
+
+    data_file = fopen(argv[1], "rb");
+    if (data_file == NULL)
+    {
+        fprintf(stderr, "can't open %s\n", argv[1]);
+        return 1;
+    }
+
+    index_file = fopen(argv[2], "wb");
+    if (index_file == NULL)
+    {
+        fprintf(stderr, "can't create %s\n", argv[2]);
+        fclose(data_file);
+        return 1;
+    }
+
+    result = build_index(data_file, index_file, (size_t)block_records, (const char *const *)(argv + 4), (size_t)(argc - 4));
+
+    fclose(index_file);
+    fclose(data_file);
+    return result;
+}
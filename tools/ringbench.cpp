@@ -0,0 +1,177 @@
+/*
+Copyright (c) 2015 drugaddicted - c17h19no3 AT openmailbox DOT org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "cbor.h"
+
+/* compares passing of encoded messages between threads through a ring and a mutex queue of vectors:
+   cborphine-ringbench [producers] [messages per producer] */
+
+#define RING_SIZE (CBOR_RING_HEADER_SIZE + 1024 * 1024)
+#define MESSAGE_CAPACITY 64
+
+static size_t encode_message(uint8_t *message, cbor_base_uint_t producer, cbor_base_uint_t sequence)
+{
+    uint8_t *pos = message;
+
+    cbor_write_map(&pos, MESSAGE_CAPACITY - (pos - message), 3);
+    cbor_write_string(&pos, MESSAGE_CAPACITY - (pos - message), "producer");
+    cbor_write_uint(&pos, MESSAGE_CAPACITY - (pos - message), producer);
+    cbor_write_string(&pos, MESSAGE_CAPACITY - (pos - message), "sequence");
+    cbor_write_uint(&pos, MESSAGE_CAPACITY - (pos - message), sequence);
+    cbor_write_string(&pos, MESSAGE_CAPACITY - (pos - message), "payload");
+    cbor_write_string(&pos, MESSAGE_CAPACITY - (pos - message), "0123456789abcdef");
+    return (size_t)(pos - message);
+}
+
+static cbor_base_uint_t decode_message(const uint8_t *message, size_t message_size)
+{
+    cbor_token_t token;
+    cbor_base_uint_t sum = 0;
+
+    for (cbor_init_read(&token, message, message_size, CBOR_TRUE); token.type != CBOR_TOKEN_TYPE_END; cbor_read_next(&token))
+    {
+        if (token.type == CBOR_TOKEN_TYPE_PINT)
+            sum += CBOR_GET_PINT(&token);
+    }
+
+    return sum;
+}
+
+static double bench_ring(unsigned int producers, cbor_base_uint_t messages, cbor_base_uint_t *sum)
+{
+    std::vector<uint64_t> memory(RING_SIZE / 8);
+    std::vector<std::thread> threads;
+    cbor_ring_t ring;
+    const uint8_t *message;
+    size_t message_size;
+
+    cbor_init_ring(&ring, &memory[0], RING_SIZE, producers > 1 ? CBOR_TRUE : CBOR_FALSE);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < producers; ++i)
+    {
+        threads.push_back(std::thread([&ring, i, messages]()
+        {
+            for (cbor_base_uint_t j = 0; j < messages; ++j)
+            {
+                uint8_t *reserved;
+
+                while ((reserved = cbor_ring_reserve(&ring, MESSAGE_CAPACITY)) == NULL)
+                    std::this_thread::yield();
+
+                cbor_ring_commit(&ring, reserved, reserved + encode_message(reserved, i, j));
+            }
+        }));
+    }
+
+    for (cbor_base_uint_t i = 0; i < producers * messages; ++i)
+    {
+        while (cbor_ring_peek(&ring, &message, &message_size) == CBOR_FALSE)
+            std::this_thread::yield();
+
+        *sum += decode_message(message, message_size);
+        cbor_ring_release(&ring);
+    }
+
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double bench_queue(unsigned int producers, cbor_base_uint_t messages, cbor_base_uint_t *sum)
+{
+    std::deque<std::vector<uint8_t> > queue;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::vector<std::thread> threads;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < producers; ++i)
+    {
+        threads.push_back(std::thread([&queue, &mutex, &ready, i, messages]()
+        {
+            for (cbor_base_uint_t j = 0; j < messages; ++j)
+            {
+                std::vector<uint8_t> message(MESSAGE_CAPACITY);
+
+                message.resize(encode_message(&message[0], i, j));
+                std::lock_guard<std::mutex> lock(mutex);
+                queue.push_back(std::move(message));
+                ready.notify_one();
+            }
+        }));
+    }
+
+    for (cbor_base_uint_t i = 0; i < producers * messages; ++i)
+    {
+        std::vector<uint8_t> message;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [&queue]() { return !queue.empty(); });
+            message = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        *sum += decode_message(&message[0], message.size());
+    }
+
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int producers = argc > 1 ? (unsigned int)atoi(argv[1]) : 1;
+    cbor_base_uint_t messages = argc > 2 ? (cbor_base_uint_t)atol(argv[2]) : 1000000;
+    cbor_base_uint_t ring_sum = 0;
+    cbor_base_uint_t queue_sum = 0;
+    double ring_time;
+    double queue_time;
+
+    if (producers == 0 || messages == 0)
+    {
+        fprintf(stderr, "usage: cborphine-ringbench [producers] [messages per producer]\n");
+        return 1;
+    }
+
+    ring_time = bench_ring(producers, messages, &ring_sum);
+    queue_time = bench_queue(producers, messages, &queue_sum);
+
+    printf("%u producer(s), %.0f messages\n", producers, (double)producers * (double)messages);
+    printf("ring:  %.3f s, %.2f M messages/s\n", ring_time, (double)producers * (double)messages / ring_time / 1e6);
+    printf("queue: %.3f s, %.2f M messages/s\n", queue_time, (double)producers * (double)messages / queue_time / 1e6);
+
+    return ring_sum == queue_sum ? 0 : 1;
+}